@@ -6,7 +6,11 @@
 #include <loader/mesh/OBJMeshLoader.h>
 #include <loader/mesh/ChiraMeshLoader.h>
 #include <module/Module.h>
+#include <render/backend/UploadQueue.h>
+#include <resource/provider/EmbeddedResourceProvider.h>
 #include <resource/provider/FilesystemResourceProvider.h>
+#include <resource/provider/PackResourceProvider.h>
+#include <resource/ResourceTrace.h>
 #include <script/Lua.h>
 #include <ui/debug/ConsolePanel.h>
 #include <ui/debug/ResourceUsageTrackerPanel.h>
@@ -50,7 +54,14 @@ void Engine::preinit(int argc, const char* argv[]) {
     system("chcp 65001 > nul");
 #endif
     CommandLine::init(argc, argv);
+    // The newest provider wins lookups, so embedded resources override the pack, and the pack overrides loose files
     Resource::addResourceProvider(new FilesystemResourceProvider{ENGINE_FILESYSTEM_PATH});
+    if (const auto enginePack = FILESYSTEM_ROOT_FOLDER + '/' + ENGINE_FILESYSTEM_PATH + PACK_FILE_EXTENSION.data(); std::filesystem::exists(enginePack)) {
+        Resource::addResourceProvider(new PackResourceProvider{enginePack});
+    }
+    if (const auto embedded = getEmbeddedEngineResources(); !embedded.empty()) {
+        Resource::addResourceProvider(new EmbeddedResourceProvider{embedded});
+    }
     TranslationManager::addTranslationFile("file://i18n/engine");
     if (!ModuleRegistry::preinitAll()) [[unlikely]] {
         LOG_ENGINE.error("Failed to initialize modules! Make sure there are no circular dependencies.");
@@ -78,6 +89,9 @@ void Engine::init(bool visibleSplashScreen /*= true*/) {
     IMeshLoader::addMeshLoader("obj", new OBJMeshLoader{});
     IMeshLoader::addMeshLoader("cmdl", new ChiraMeshLoader{});
 
+    // Read what the last session needed while the rest of the engine starts
+    ResourceTrace::begin();
+
     // Create default resources
     Resource::createDefaultResources();
 
@@ -112,6 +126,9 @@ void Engine::run() {
         Engine::lastTime = Engine::currentTime;
         Engine::currentTime = Device::getTicks();
 
+        Resource::update();
+        UploadQueue::update();
+
         Device::refreshWindows();
 
         ModuleRegistry::updateAll();
@@ -124,6 +141,7 @@ void Engine::run() {
 
     ModuleRegistry::deinitAll();
 
+    ResourceTrace::end();
     Resource::discardAll();
 
     exit(EXIT_SUCCESS);
@@ -4,6 +4,23 @@ if(APPLE)
     list(APPEND CHIRA_ENGINE_LINK_LIBRARIES ${CORE_LIB})
 endif()
 
+# Resource loading uses worker threads
+find_package(Threads REQUIRED)
+list(APPEND CHIRA_ENGINE_LINK_LIBRARIES Threads::Threads)
+
+# Batched reads through io_uring need liburing, otherwise files are read one at a time
+if(CHIRA_USE_IO_URING AND CMAKE_SYSTEM_NAME STREQUAL "Linux")
+    find_path(LIBURING_INCLUDE_DIR liburing.h)
+    find_library(LIBURING_LIBRARY uring)
+    if(LIBURING_INCLUDE_DIR AND LIBURING_LIBRARY)
+        list(APPEND CHIRA_ENGINE_DEFINITIONS CHIRA_USE_IO_URING)
+        list(APPEND CHIRA_ENGINE_INCLUDE_DIRS ${LIBURING_INCLUDE_DIR})
+        list(APPEND CHIRA_ENGINE_LINK_LIBRARIES ${LIBURING_LIBRARY})
+    else()
+        message(STATUS "liburing was not found, files will be read one at a time.")
+    endif()
+endif()
+
 # Basic ImGui sources
 list(APPEND IMGUI_HEADERS
         ${CMAKE_CURRENT_LIST_DIR}/thirdparty/imgui/imconfig.h
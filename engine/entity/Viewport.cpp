@@ -1,5 +1,6 @@
 #include "Viewport.h"
 
+#include <algorithm>
 #include <core/Assertions.h>
 #include <render/shader/UBO.h>
 #include <utility/Types.h>
@@ -134,8 +135,9 @@ void Viewport::render() {
     LightsUBO::get().update(directionalLightComponentArray, pointLightComponentArray, spotLightComponentArray,
                             {directionalLightsCount, pointLightsCount, spotLightsCount});
 
+    const auto* camera = this->getCamera();
     foreach(LAYER_COMPONENTS, [&](auto layer) {
-        if (!(this->getCamera()->activeLayers & layer.index)) {
+        if (!(camera->activeLayers & layer.index)) {
             return;
         }
 
@@ -150,7 +152,15 @@ void Viewport::render() {
             for (auto entity : meshView) {
                 auto& transformComponent = registry.template get<TransformComponent>(entity);
                 auto& meshComponent = registry.template get<MeshComponent>(entity);
-                meshComponent.mesh->render(transformComponent.getMatrix());
+                const auto model = transformComponent.getMatrix();
+                std::size_t lod = 0;
+                if (meshComponent.mesh->getLODCount() > 1) {
+                    // The largest scale axis is the one that makes the error most visible
+                    const float scale = std::max({glm::length(glm::vec3{model[0]}), glm::length(glm::vec3{model[1]}), glm::length(glm::vec3{model[2]})});
+                    // Measured where the mesh comes closest to the camera, so large meshes keep their detail up close
+                    lod = meshComponent.mesh->selectLOD(camera->getPixelsPerUnit(meshComponent.getWorldBounds(model), this->size) * scale);
+                }
+                meshComponent.mesh->render(model, MeshCullType::BACK, lod);
             }
 
             // Render MeshDynamicComponent
@@ -13,6 +13,7 @@ struct AudioWavStreamComponent {
 
     explicit AudioWavStreamComponent(const std::string& wavStreamId = "file://sounds/missing.wav") {
         this->wavFile = Resource::getResource<BinaryResource>(wavStreamId);
+        // Not copied, the resource keeps the file (which may be memory-mapped) alive while we hold it
         this->wavStream.loadMem(const_cast<unsigned char*>(this->wavFile->getBuffer()), static_cast<unsigned int>(this->wavFile->getBufferLength()), false, false);
     }
 
@@ -2,6 +2,7 @@
 
 #include <entt/entt.hpp>
 #include <core/Assertions.h>
+#include <math/Bounds.h>
 #include <math/Types.h>
 #include <utility/Types.h>
 #include "LayerComponents.h"
@@ -51,6 +52,31 @@ struct CameraComponent {
         }
     }
 
+    /// How many pixels one unit at the given point covers on a viewport of the given size.
+    [[nodiscard]] float getPixelsPerUnit(glm::vec3 point, glm::vec2i size) const {
+        const auto height = static_cast<float>(std::max(size.y, 1));
+        switch (this->projectionMode) {
+            using enum ProjectionMode;
+            case PERSPECTIVE: {
+                const float distance = std::max(glm::length(point - this->transform->getPosition()), this->nearDistance);
+                return height / (2.f * std::tan(glm::radians(this->fov) / 2.f) * distance);
+            }
+            case ORTHOGRAPHIC:
+                return height / this->orthoSize;
+            CHIRA_NO_DEFAULT;
+        }
+    }
+
+    /// Like above, at the point of the bounding sphere closest to the camera.
+    [[nodiscard]] float getPixelsPerUnit(const Bounds& bounds, glm::vec2i size) const {
+        const auto cameraPosition = this->transform->getPosition();
+        const auto toCamera = cameraPosition - bounds.center;
+        const auto distance = glm::length(toCamera);
+        if (distance <= std::max(bounds.radius, 0.f))
+            return this->getPixelsPerUnit(cameraPosition, size);
+        return this->getPixelsPerUnit(bounds.center + toCamera * (std::max(bounds.radius, 0.f) / distance), size);
+    }
+
     [[nodiscard]] glm::mat4 getView() const {
         const glm::vec3 position = this->transform->getPosition();
         return glm::lookAt(position, position + this->transform->getFrontVector(), this->transform->getUpVector());
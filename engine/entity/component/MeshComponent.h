@@ -1,5 +1,6 @@
 #pragma once
 
+#include <math/Bounds.h>
 #include <render/mesh/MeshDataResource.h>
 #include "TransformComponent.h"
 
@@ -10,6 +11,14 @@ struct MeshComponent {
             : transform(nullptr)
             , mesh(Resource::getResource<MeshDataResource>(meshId)) {}
 
+    /// The mesh's bounds moved by the given model matrix, usually the transform's.
+    [[nodiscard]] Bounds getWorldBounds(const glm::mat4& model) const {
+        return this->mesh->getBounds().transform(model);
+    }
+    [[nodiscard]] Bounds getWorldBounds() const {
+        return this->getWorldBounds(this->transform->getMatrix());
+    }
+
 public:
     TransformComponent* transform;
     SharedPointer<MeshDataResource> mesh;
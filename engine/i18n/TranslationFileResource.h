@@ -8,8 +8,8 @@ namespace chira {
 
 class TranslationFileResource : public JSONResource {
 public:
-    TranslationFileResource(std::string identifier_, std::string language_)
-        : JSONResource(std::move(identifier_))
+    TranslationFileResource(ResourceID identifier_, std::string language_)
+        : JSONResource(identifier_)
         , language(std::move(language_)) {}
 
     void compile(const nlohmann::json& translations) override {
@@ -11,8 +11,8 @@ Image::~Image() {
     }
 }
 
-Image::Image(std::string identifier_, bool vFlip)
-    : Resource(std::move(identifier_))
+Image::Image(ResourceID identifier_, bool vFlip)
+    : Resource(identifier_)
     , verticalFlip(vFlip) {}
 
 void Image::compile(const byte buffer[], std::size_t bufferLen) {
@@ -23,8 +23,18 @@ void Image::compile(const byte buffer[], std::size_t bufferLen) {
     this->bitDepth = bd;
 }
 
+void Image::compileView(const ResourceView& view) {
+    // stb_image doesn't need a null terminator
+    int w, h, bd;
+    this->image = Image::getUncompressedImage(view.getData(), static_cast<int>(view.getSize()), &w, &h, &bd, 0, this->isVerticallyFlipped());
+    this->width = w;
+    this->height = h;
+    this->bitDepth = bd;
+}
+
 byte* Image::getUncompressedImage(const byte buffer[], int bufferLen, int* width, int* height, int* fileChannels, int desiredChannels, bool vflip) {
-    stbi_set_flip_vertically_on_load(vflip);
+    // Images can be decoded on resource loading threads
+    stbi_set_flip_vertically_on_load_thread(vflip);
     return stbi_load_from_memory(buffer, bufferLen, width, height, fileChannels, desiredChannels);
 }
 
@@ -34,7 +44,8 @@ byte* Image::getUncompressedImage(const byte buffer[], int bufferLen, int desire
 }
 
 byte* Image::getUncompressedImage(std::string_view filepath, int* width, int* height, int* fileChannels, int desiredChannels, bool vflip) {
-    stbi_set_flip_vertically_on_load(vflip);
+    // Images can be decoded on resource loading threads
+    stbi_set_flip_vertically_on_load_thread(vflip);
     return stbi_load(filepath.data(), width, height, fileChannels, desiredChannels);
 }
 
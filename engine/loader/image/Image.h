@@ -7,7 +7,7 @@ namespace chira {
 
 class Image : public Resource {
 public:
-    explicit Image(std::string identifier_, bool vFlip = true);
+    explicit Image(ResourceID identifier_, bool vFlip = true);
     ~Image() override;
     Image(const Image& other) = delete;
     Image& operator=(const Image& other) = delete;
@@ -15,6 +15,15 @@ public:
     Image& operator=(Image&& other) noexcept = default;
 
     void compile(const byte buffer[], std::size_t bufferLen) override;
+    void compileView(const ResourceView& view) override;
+    [[nodiscard]] bool isThreadSafeToCompile() const override {
+        return true;
+    }
+    [[nodiscard]] std::size_t getCPUMemoryUsage() const override {
+        if (!this->image)
+            return 0;
+        return static_cast<std::size_t>(this->width) * this->height * this->bitDepth;
+    }
     [[nodiscard]] inline byte* getData() const {
         return this->image;
     }
@@ -44,6 +53,7 @@ protected:
     bool verticalFlip = true;
 private:
     CHIRA_REGISTER_DEFAULT_RESOURCE(Image, "file://textures/missing.png");
+    CHIRA_REGISTER_RESOURCE_TYPE(Image);
 };
 
 } // namespace chira
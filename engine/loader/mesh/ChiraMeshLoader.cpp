@@ -2,47 +2,357 @@
 
 #include <cstring>
 #include <algorithm>
+#include <glm/packing.hpp>
 #include <core/Logger.h>
-#include <resource/BinaryResource.h>
+#include <resource/Resource.h>
 #include <i18n/TranslationManager.h>
+#include <utility/Compression.h>
 
 using namespace chira;
 
 CHIRA_CREATE_LOG(CMDL);
 
-void ChiraMeshLoader::loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const {
-    auto meshData = Resource::getResource<BinaryResource>(identifier);
-    if (meshData->getBufferLength() < CHIRA_MESH_HEADER_SIZE) {
+// Unquantized vertices are stored exactly like Vertex, so they can be copied in one go
+static_assert(sizeof(Vertex) == 44);
+
+namespace {
+
+[[nodiscard]] std::uint32_t alignSection(std::uint32_t offset) {
+    return (offset + CHIRA_MESH_SECTION_ALIGNMENT - 1) / CHIRA_MESH_SECTION_ALIGNMENT * CHIRA_MESH_SECTION_ALIGNMENT;
+}
+
+template<typename T>
+void writeValue(byte*& out, const T& value) {
+    std::memcpy(out, &value, sizeof(T));
+    out += sizeof(T);
+}
+
+template<typename T>
+[[nodiscard]] T readValue(const byte*& in) {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return value;
+}
+
+void writeVertex(byte* out, const Vertex& vertex, std::uint32_t flags) {
+    writeValue(out, vertex.position);
+    if (flags & CHIRA_MESH_FLAG_SNORM_NORMALS) {
+        writeValue(out, glm::packSnorm2x16({vertex.normal.r, vertex.normal.g}));
+        writeValue(out, glm::packSnorm2x16({vertex.normal.b, 0.f}));
+    } else {
+        writeValue(out, vertex.normal);
+    }
+    if (flags & CHIRA_MESH_FLAG_UNORM_COLORS) {
+        writeValue(out, glm::packUnorm4x8({vertex.color.r, vertex.color.g, vertex.color.b, 1.f}));
+    } else {
+        writeValue(out, vertex.color);
+    }
+    if (flags & CHIRA_MESH_FLAG_HALF_UVS) {
+        writeValue(out, glm::packHalf2x16({vertex.uv.r, vertex.uv.g}));
+    } else {
+        writeValue(out, vertex.uv);
+    }
+}
+
+[[nodiscard]] Vertex readVertex(const byte* in, std::uint32_t flags) {
+    Vertex vertex;
+    vertex.position = readValue<glm::vec3>(in);
+    if (flags & CHIRA_MESH_FLAG_SNORM_NORMALS) {
+        const auto xy = glm::unpackSnorm2x16(readValue<std::uint32_t>(in));
+        const auto z = glm::unpackSnorm2x16(readValue<std::uint32_t>(in));
+        vertex.normal = {xy.x, xy.y, z.x};
+    } else {
+        vertex.normal = readValue<ColorRGB>(in);
+    }
+    if (flags & CHIRA_MESH_FLAG_UNORM_COLORS) {
+        const auto color = glm::unpackUnorm4x8(readValue<std::uint32_t>(in));
+        vertex.color = {color.r, color.g, color.b};
+    } else {
+        vertex.color = readValue<ColorRGB>(in);
+    }
+    if (flags & CHIRA_MESH_FLAG_HALF_UVS) {
+        const auto uv = glm::unpackHalf2x16(readValue<std::uint32_t>(in));
+        vertex.uv = {uv.x, uv.y};
+    } else {
+        vertex.uv = readValue<ColorRG>(in);
+    }
+    return vertex;
+}
+
+/// Meshes can be loaded on top of existing mesh data, so the new indices have to skip past the existing vertices.
+void offsetIndices(std::vector<Index>& indices, std::size_t firstIndex, std::size_t firstVertex) {
+    if (firstVertex == 0)
+        return;
+    for (auto i = firstIndex; i < indices.size(); i++) {
+        indices[i] += static_cast<Index>(firstVertex);
+    }
+}
+
+void readIndices(const byte* in, std::size_t count, std::uint32_t indexSize, std::vector<Index>& indices) {
+    const auto first = indices.size();
+    indices.resize(first + count);
+    if (indexSize == sizeof(Index)) {
+        std::memcpy(indices.data() + first, in, count * sizeof(Index));
+    } else {
+        for (std::size_t i = 0; i < count; i++) {
+            indices[first + i] = readValue<std::uint16_t>(in);
+        }
+    }
+}
+
+/// True if every index points at one of the vertexCount vertices, so a corrupt file can't make the GPU read past them.
+[[nodiscard]] bool areIndicesInRange(const byte* in, std::size_t count, std::uint32_t indexSize, std::uint32_t vertexCount) {
+    for (std::size_t i = 0; i < count; i++) {
+        const std::uint32_t index = indexSize == sizeof(std::uint16_t) ? readValue<std::uint16_t>(in) : readValue<std::uint32_t>(in);
+        if (index >= vertexCount)
+            return false;
+    }
+    return true;
+}
+
+void writeIndices(byte* out, const std::vector<Index>& indices, std::uint32_t indexSize) {
+    if (indexSize == sizeof(Index)) {
+        std::memcpy(out, indices.data(), indices.size() * sizeof(Index));
+    } else {
+        for (const auto index : indices) {
+            writeValue(out, static_cast<std::uint16_t>(index));
+        }
+    }
+}
+
+[[nodiscard]] bool loadMeshV1(const ChiraMeshHeader& header, const byte* data, std::size_t size, std::vector<Vertex>& vertices, std::vector<Index>& indices, Bounds* bounds) {
+    if (size < CHIRA_MESH_HEADER_SIZE + (static_cast<std::size_t>(header.vertexCount) * sizeof(Vertex)) + (static_cast<std::size_t>(header.indexCount) * sizeof(Index)))
+        return false;
+    const byte* indexData = data + CHIRA_MESH_HEADER_SIZE + (header.vertexCount * sizeof(Vertex));
+    if (!areIndicesInRange(indexData, header.indexCount, sizeof(Index), header.vertexCount))
+        return false;
+    const auto firstVertex = vertices.size();
+    vertices.resize(firstVertex + header.vertexCount);
+    std::memcpy(vertices.data() + firstVertex, data + CHIRA_MESH_HEADER_SIZE, header.vertexCount * sizeof(Vertex));
+    const auto firstIndex = indices.size();
+    indices.resize(firstIndex + header.indexCount);
+    std::memcpy(indices.data() + firstIndex, indexData, header.indexCount * sizeof(Index));
+    offsetIndices(indices, firstIndex, firstVertex);
+    // Version 1 meshes don't store their bounds
+    if (bounds)
+        *bounds = Bounds::fromVertices(vertices.data() + firstVertex, header.vertexCount);
+    return true;
+}
+
+[[nodiscard]] bool loadMeshV2(const ChiraMeshHeader& header, const byte* data, std::size_t size, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>* lods, Bounds* bounds) {
+    if (size < CHIRA_MESH_PAYLOAD_OFFSET)
+        return false;
+    ChiraMeshHeaderV2 headerV2;
+    std::memcpy(&headerV2, data + CHIRA_MESH_HEADER_SIZE, CHIRA_MESH_HEADER_V2_SIZE);
+
+    const auto knownFlags = CHIRA_MESH_FLAG_QUANTIZED | CHIRA_MESH_FLAG_COMPRESSED | CHIRA_MESH_FLAG_LODS;
+    if ((headerV2.flags & ~knownFlags) ||
+        headerV2.vertexStride != ChiraMeshLoader::getVertexStride(headerV2.flags) ||
+        (headerV2.indexSize != sizeof(std::uint16_t) && headerV2.indexSize != sizeof(std::uint32_t)) ||
+        headerV2.vertexOffset % CHIRA_MESH_SECTION_ALIGNMENT || headerV2.indexOffset % CHIRA_MESH_SECTION_ALIGNMENT ||
+        headerV2.vertexOffset + static_cast<std::uint64_t>(header.vertexCount) * headerV2.vertexStride > headerV2.payloadSize ||
+        headerV2.indexOffset + static_cast<std::uint64_t>(header.indexCount) * headerV2.indexSize > headerV2.payloadSize)
+        return false;
+
+    const byte* payload = data + CHIRA_MESH_PAYLOAD_OFFSET;
+    std::vector<byte> decompressed;
+    if (headerV2.flags & CHIRA_MESH_FLAG_COMPRESSED) {
+        if (size < CHIRA_MESH_PAYLOAD_OFFSET + static_cast<std::size_t>(headerV2.compressedSize))
+            return false;
+        // Don't trust the payload size with an allocation if the compressed data can't possibly fill it
+        if (headerV2.payloadSize > Compression::getMaxDecompressedSize(headerV2.compressedSize))
+            return false;
+        decompressed.resize(headerV2.payloadSize);
+        if (!Compression::decompress(payload, headerV2.compressedSize, decompressed.data(), decompressed.size()))
+            return false;
+        payload = decompressed.data();
+    } else if (size < CHIRA_MESH_PAYLOAD_OFFSET + static_cast<std::size_t>(headerV2.payloadSize)) {
+        return false;
+    }
+
+    // Check the indices and the LOD table before touching the output, so bad ones don't leave half a mesh behind
+    if (!areIndicesInRange(payload + headerV2.indexOffset, header.indexCount, headerV2.indexSize, header.vertexCount))
+        return false;
+    std::vector<ChiraMeshLOD> lodTable;
+    if (lods && (headerV2.flags & CHIRA_MESH_FLAG_LODS)) {
+        const std::uint64_t tableOffset = alignSection(headerV2.indexOffset + header.indexCount * headerV2.indexSize);
+        if (tableOffset + sizeof(std::uint32_t) > headerV2.payloadSize)
+            return false;
+        const byte* in = payload + tableOffset;
+        const auto lodCount = readValue<std::uint32_t>(in);
+        if (tableOffset + sizeof(std::uint32_t) + static_cast<std::uint64_t>(lodCount) * CHIRA_MESH_LOD_SIZE > headerV2.payloadSize)
+            return false;
+        lodTable.resize(lodCount);
+        for (auto& lod : lodTable) {
+            lod = readValue<ChiraMeshLOD>(in);
+            if (lod.indexOffset % CHIRA_MESH_SECTION_ALIGNMENT ||
+                lod.indexOffset + static_cast<std::uint64_t>(lod.indexCount) * headerV2.indexSize > headerV2.payloadSize ||
+                !areIndicesInRange(payload + lod.indexOffset, lod.indexCount, headerV2.indexSize, header.vertexCount))
+                return false;
+        }
+    }
+
+    const auto firstVertex = vertices.size();
+    vertices.resize(firstVertex + header.vertexCount);
+    if (headerV2.vertexStride == sizeof(Vertex)) {
+        std::memcpy(vertices.data() + firstVertex, payload + headerV2.vertexOffset, header.vertexCount * sizeof(Vertex));
+    } else {
+        for (std::size_t i = 0; i < header.vertexCount; i++) {
+            vertices[firstVertex + i] = readVertex(payload + headerV2.vertexOffset + i * headerV2.vertexStride, headerV2.flags);
+        }
+    }
+
+    const auto firstIndex = indices.size();
+    readIndices(payload + headerV2.indexOffset, header.indexCount, headerV2.indexSize, indices);
+    offsetIndices(indices, firstIndex, firstVertex);
+
+    for (const auto& lod : lodTable) {
+        auto& loaded = lods->emplace_back();
+        loaded.error = lod.error;
+        readIndices(payload + lod.indexOffset, lod.indexCount, headerV2.indexSize, loaded.indices);
+        offsetIndices(loaded.indices, 0, firstVertex);
+    }
+
+    if (bounds) {
+        *bounds = {};
+        if (header.vertexCount) {
+            for (int i = 0; i < 3; i++) {
+                bounds->min[i] = headerV2.boundsMin[i];
+                bounds->max[i] = headerV2.boundsMax[i];
+                bounds->center[i] = headerV2.sphereCenter[i];
+            }
+            bounds->radius = headerV2.sphereRadius;
+        }
+    }
+    return true;
+}
+
+void loadMeshFile(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>* lods, Bounds* bounds) {
+    // Read straight from the provider's view, the file is only needed until it's copied into the mesh
+    const ResourceID id{identifier};
+    auto* provider = Resource::getResourceProviderWithResource(id);
+    if (!provider) {
+        LOG_CMDL.error(TRF("error.cmdl_loader.unable_to_read", identifier));
+        return;
+    }
+    auto meshData = provider->readResource(id.getName());
+    if (meshData.getSize() < CHIRA_MESH_HEADER_SIZE) {
         // die
         LOG_CMDL.error(TRF("error.cmdl_loader.invalid_data", identifier));
         return;
     }
     ChiraMeshHeader header;
-    std::memcpy(&header, meshData->getBuffer(), CHIRA_MESH_HEADER_SIZE);
+    std::memcpy(&header, meshData.getData(), CHIRA_MESH_HEADER_SIZE);
 
     // read mesh data
+    bool loaded = false;
     if (header.version == 1) {
-        vertices.resize(header.vertexCount);
-        std::memcpy(vertices.data(), meshData->getBuffer() + CHIRA_MESH_HEADER_SIZE, header.vertexCount * sizeof(Vertex));
-        indices.resize(header.indexCount);
-        std::memcpy(indices.data(), meshData->getBuffer() + CHIRA_MESH_HEADER_SIZE + (header.vertexCount * sizeof(Vertex)), header.indexCount * sizeof(Index));
+        loaded = loadMeshV1(header, meshData.getData(), meshData.getSize(), vertices, indices, bounds);
+    } else if (header.version == 2) {
+        loaded = loadMeshV2(header, meshData.getData(), meshData.getSize(), vertices, indices, lods, bounds);
     }
+    if (!loaded) {
+        LOG_CMDL.error(TRF("error.cmdl_loader.invalid_data", identifier));
+    }
+}
+
+} // namespace
+
+void ChiraMeshLoader::loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const {
+    loadMeshFile(identifier, vertices, indices, nullptr, nullptr);
+}
+
+void ChiraMeshLoader::loadMeshWithLODs(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>& lods, Bounds& bounds) const {
+    bounds = {};
+    loadMeshFile(identifier, vertices, indices, &lods, &bounds);
 }
 
 std::vector<byte> ChiraMeshLoader::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) const {
-    std::vector<byte> bytebuffer;
+    return this->createMeshWithLODs(vertices, indices, {});
+}
+
+std::vector<byte> ChiraMeshLoader::createMeshWithLODs(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const std::vector<MeshLOD>& lods) const {
     ChiraMeshHeader header;
-    header.version = 1;
-    header.vertexCount = static_cast<Index>(vertices.size());
-    header.indexCount = static_cast<Index>(indices.size());
-    const unsigned int VERTEX_SIZE = (sizeof(Vertex) * header.vertexCount);
-    const unsigned int INDEX_SIZE = (sizeof(Index) * header.indexCount);
-
-    // Since each element in bytebuffer is one byte wide, this works
-    bytebuffer.resize(CHIRA_MESH_HEADER_SIZE + VERTEX_SIZE + INDEX_SIZE);
-    std::memcpy(bytebuffer.data(), &header, CHIRA_MESH_HEADER_SIZE);
-    std::memcpy(bytebuffer.data() + CHIRA_MESH_HEADER_SIZE, vertices.data(), VERTEX_SIZE);
-    std::memcpy(bytebuffer.data() + CHIRA_MESH_HEADER_SIZE + VERTEX_SIZE, indices.data(), INDEX_SIZE);
+    header.version = CHIRA_MESH_VERSION;
+    header.vertexCount = static_cast<unsigned int>(vertices.size());
+    header.indexCount = static_cast<unsigned int>(indices.size());
+
+    ChiraMeshHeaderV2 headerV2;
+    headerV2.flags = this->writeFlags & CHIRA_MESH_FLAG_QUANTIZED;
+    if (!lods.empty())
+        headerV2.flags |= CHIRA_MESH_FLAG_LODS;
+    headerV2.vertexStride = ChiraMeshLoader::getVertexStride(headerV2.flags);
+    const auto fitsInShort = [](Index index) {
+        return index <= UINT16_MAX;
+    };
+    const bool shortIndices = std::all_of(indices.begin(), indices.end(), fitsInShort) && std::all_of(lods.begin(), lods.end(), [&fitsInShort](const MeshLOD& lod) {
+        return std::all_of(lod.indices.begin(), lod.indices.end(), fitsInShort);
+    });
+    headerV2.indexSize = shortIndices ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+    headerV2.vertexOffset = 0;
+    headerV2.indexOffset = alignSection(header.vertexCount * headerV2.vertexStride);
+    headerV2.payloadSize = alignSection(headerV2.indexOffset + header.indexCount * headerV2.indexSize);
+    if (const auto bounds = Bounds::fromVertices(vertices); !bounds.isEmpty()) {
+        for (int i = 0; i < 3; i++) {
+            headerV2.boundsMin[i] = bounds.min[i];
+            headerV2.boundsMax[i] = bounds.max[i];
+            headerV2.sphereCenter[i] = bounds.center[i];
+        }
+        headerV2.sphereRadius = bounds.radius;
+    }
+
+    const auto lodTableOffset = headerV2.payloadSize;
+    std::vector<ChiraMeshLOD> lodTable(lods.size());
+    if (!lods.empty()) {
+        headerV2.payloadSize = alignSection(lodTableOffset + static_cast<std::uint32_t>(sizeof(std::uint32_t) + lods.size() * CHIRA_MESH_LOD_SIZE));
+        for (std::size_t i = 0; i < lods.size(); i++) {
+            lodTable[i].indexOffset = headerV2.payloadSize;
+            lodTable[i].indexCount = static_cast<std::uint32_t>(lods[i].indices.size());
+            lodTable[i].error = lods[i].error;
+            headerV2.payloadSize = alignSection(headerV2.payloadSize + lodTable[i].indexCount * headerV2.indexSize);
+        }
+    }
 
+    std::vector<byte> payload(headerV2.payloadSize);
+    if (headerV2.vertexStride == sizeof(Vertex)) {
+        std::memcpy(payload.data() + headerV2.vertexOffset, vertices.data(), vertices.size() * sizeof(Vertex));
+    } else {
+        for (std::size_t i = 0; i < vertices.size(); i++) {
+            writeVertex(payload.data() + headerV2.vertexOffset + i * headerV2.vertexStride, vertices[i], headerV2.flags);
+        }
+    }
+    writeIndices(payload.data() + headerV2.indexOffset, indices, headerV2.indexSize);
+    if (!lods.empty()) {
+        byte* out = payload.data() + lodTableOffset;
+        writeValue(out, static_cast<std::uint32_t>(lods.size()));
+        for (std::size_t i = 0; i < lods.size(); i++) {
+            writeValue(out, lodTable[i]);
+            writeIndices(payload.data() + lodTable[i].indexOffset, lods[i].indices, headerV2.indexSize);
+        }
+    }
+
+    if (this->writeFlags & CHIRA_MESH_FLAG_COMPRESSED) {
+        auto compressed = Compression::compress(payload.data(), payload.size());
+        // Not worth decompressing if it barely got smaller
+        if (compressed.size() < payload.size() - payload.size() / 8) {
+            headerV2.flags |= CHIRA_MESH_FLAG_COMPRESSED;
+            headerV2.compressedSize = static_cast<std::uint32_t>(compressed.size());
+            payload = std::move(compressed);
+        }
+    }
+
+    std::vector<byte> bytebuffer(CHIRA_MESH_PAYLOAD_OFFSET + payload.size());
+    std::memcpy(bytebuffer.data(), &header, CHIRA_MESH_HEADER_SIZE);
+    std::memcpy(bytebuffer.data() + CHIRA_MESH_HEADER_SIZE, &headerV2, CHIRA_MESH_HEADER_V2_SIZE);
+    std::memcpy(bytebuffer.data() + CHIRA_MESH_PAYLOAD_OFFSET, payload.data(), payload.size());
     return bytebuffer;
 }
+
+std::uint32_t ChiraMeshLoader::getVertexStride(std::uint32_t flags) {
+    std::uint32_t stride = sizeof(glm::vec3);
+    stride += (flags & CHIRA_MESH_FLAG_SNORM_NORMALS) ? sizeof(std::uint32_t) * 2 : sizeof(ColorRGB);
+    stride += (flags & CHIRA_MESH_FLAG_UNORM_COLORS) ? sizeof(std::uint32_t) : sizeof(ColorRGB);
+    stride += (flags & CHIRA_MESH_FLAG_HALF_UVS) ? sizeof(std::uint32_t) : sizeof(ColorRG);
+    return stride;
+}
@@ -1,15 +1,45 @@
 #pragma once
 
+#include <cstdint>
 #include "IMeshLoader.h"
 
 namespace chira {
 
+enum ChiraMeshFlags : std::uint32_t {
+    CHIRA_MESH_FLAG_NONE          =      0,
+    CHIRA_MESH_FLAG_SNORM_NORMALS = 1 << 0, // Normals are four signed normalized 16-bit integers, the last is padding
+    CHIRA_MESH_FLAG_HALF_UVS      = 1 << 1, // UVs are two half floats
+    CHIRA_MESH_FLAG_UNORM_COLORS  = 1 << 2, // Colors are four unsigned normalized 8-bit integers, the last is padding
+    CHIRA_MESH_FLAG_COMPRESSED    = 1 << 3, // The payload is compressed with Compression::compress
+    CHIRA_MESH_FLAG_LODS          = 1 << 4, // A table of LODs follows the index section
+    CHIRA_MESH_FLAG_QUANTIZED     = CHIRA_MESH_FLAG_SNORM_NORMALS | CHIRA_MESH_FLAG_HALF_UVS | CHIRA_MESH_FLAG_UNORM_COLORS,
+};
+
 class ChiraMeshLoader : public IMeshLoader {
 public:
+    /// The flags are only used when writing meshes, any version 2 mesh can be read. The LOD flag is set when there are LODs to write.
+    explicit ChiraMeshLoader(std::uint32_t writeFlags_ = CHIRA_MESH_FLAG_NONE)
+            : writeFlags(writeFlags_) {}
     void loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const override;
     [[nodiscard]] std::vector<byte> createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) const override;
+    void loadMeshWithLODs(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>& lods, Bounds& bounds) const override;
+    [[nodiscard]] std::vector<byte> createMeshWithLODs(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const std::vector<MeshLOD>& lods) const override;
+    [[nodiscard]] std::uint32_t getWriteFlags() const {
+        return this->writeFlags;
+    }
+    void setWriteFlags(std::uint32_t writeFlags_) {
+        this->writeFlags = writeFlags_;
+    }
+    /// The size of one vertex in a version 2 mesh with the given flags.
+    [[nodiscard]] static std::uint32_t getVertexStride(std::uint32_t flags);
+private:
+    std::uint32_t writeFlags;
 };
 
+constexpr unsigned int CHIRA_MESH_VERSION = 2;
+/// Sections in version 2 meshes start on a multiple of this, so a mapped file can be read or uploaded in place.
+constexpr std::uint32_t CHIRA_MESH_SECTION_ALIGNMENT = 16;
+
 struct ChiraMeshHeader {
     unsigned int version = 0;
     unsigned int vertexCount = 0;
@@ -17,4 +47,41 @@ struct ChiraMeshHeader {
 };
 constexpr unsigned short CHIRA_MESH_HEADER_SIZE = sizeof(ChiraMeshHeader);
 
+/// Follows ChiraMeshHeader in version 2 meshes. The payload comes after it, and holds the vertex and index sections.
+/// Vertices hold position, normal, color, and UV in that order, with the normal, color and UV sizes set by the flags.
+struct ChiraMeshHeaderV2 {
+    std::uint32_t flags = CHIRA_MESH_FLAG_NONE;
+    std::uint32_t vertexStride = 0;
+    /// 2 when every index fits in 16 bits, otherwise 4.
+    std::uint32_t indexSize = 0;
+    /// Offsets from the start of the payload, after it's decompressed.
+    std::uint32_t vertexOffset = 0;
+    std::uint32_t indexOffset = 0;
+    std::uint32_t payloadSize = 0;
+    /// 0 if the payload is not compressed.
+    std::uint32_t compressedSize = 0;
+    float boundsMin[3]{};
+    float boundsMax[3]{};
+    float sphereCenter[3]{};
+    float sphereRadius = 0.f;
+};
+constexpr unsigned short CHIRA_MESH_HEADER_V2_SIZE = sizeof(ChiraMeshHeaderV2);
+
+/// With CHIRA_MESH_FLAG_LODS, the index section is followed by a 32-bit LOD count and one of these for each LOD,
+/// starting on the next section boundary. Each LOD's indices get their own section, and are the same size as the others.
+struct ChiraMeshLOD {
+    /// From the start of the payload, like the other offsets.
+    std::uint32_t indexOffset = 0;
+    std::uint32_t indexCount = 0;
+    float error = 0.f;
+};
+constexpr unsigned short CHIRA_MESH_LOD_SIZE = sizeof(ChiraMeshLOD);
+constexpr std::uint32_t CHIRA_MESH_PAYLOAD_OFFSET = CHIRA_MESH_HEADER_SIZE + CHIRA_MESH_HEADER_V2_SIZE;
+
+// Both headers are copied straight out of the file, and the payload has to start aligned
+static_assert(CHIRA_MESH_HEADER_SIZE == 12);
+static_assert(CHIRA_MESH_HEADER_V2_SIZE == 68);
+static_assert(CHIRA_MESH_LOD_SIZE == 12);
+static_assert(CHIRA_MESH_PAYLOAD_OFFSET % CHIRA_MESH_SECTION_ALIGNMENT == 0);
+
 } // namespace chira
@@ -5,15 +5,34 @@
 #include <memory>
 #include <unordered_map>
 #include <core/Platform.h>
+#include <math/Bounds.h>
 #include <math/Vertex.h>
 
 namespace chira {
 
+/// A simplified version of a mesh that indexes the same vertices as the full detail mesh.
+struct MeshLOD {
+    std::vector<Index> indices;
+    /// How far the simplified surface can stray from the full detail one, in the mesh's units.
+    float error = 0.f;
+};
+
 class IMeshLoader {
 public:
     virtual ~IMeshLoader() = default;
     virtual void loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const = 0;
     [[nodiscard]] virtual std::vector<byte> createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) const = 0;
+    /// Also reads the LODs stored with the mesh, if the format has any, and the bounds of the vertices it added.
+    /// Formats that don't store bounds work them out from the vertices.
+    virtual void loadMeshWithLODs(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices, std::vector<MeshLOD>& lods, Bounds& bounds) const {
+        const auto firstVertex = vertices.size();
+        this->loadMesh(identifier, vertices, indices);
+        bounds = Bounds::fromVertices(vertices.data() + firstVertex, vertices.size() - firstVertex);
+    }
+    /// Formats that can't store LODs leave them out.
+    [[nodiscard]] virtual std::vector<byte> createMeshWithLODs(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const std::vector<MeshLOD>& lods) const {
+        return this->createMesh(vertices, indices);
+    }
     static void addMeshLoader(const std::string& name, IMeshLoader* meshLoader);
     static IMeshLoader* getMeshLoader(const std::string& name);
 private:
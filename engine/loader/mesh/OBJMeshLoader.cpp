@@ -1,118 +1,344 @@
 #include "OBJMeshLoader.h"
 
 #include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <config/ConEntry.h>
 #include <core/Logger.h>
-#include <resource/StringResource.h>
+#include <resource/Resource.h>
 #include <i18n/TranslationManager.h>
-#include <sstream>
+#include <math/VertexWelder.h>
+#include <utility/ThreadPool.h>
 
 using namespace chira;
 
 CHIRA_CREATE_LOG(OBJ);
 
+[[maybe_unused]]
+ConVar obj_loader_chunk_kb{"obj_loader_chunk_kb", 1024, "The smallest piece of an OBJ file in kilobytes that gets parsed as its own task on the resource loading pool. Set to 0 to parse on one thread.", CON_FLAG_CACHE};
+
+namespace {
+
+/// An index into one of the attribute lists. Negative OBJ indices count back from the end of the list, but a chunk
+/// doesn't know how long the list is until the chunks before it are parsed, so those are kept relative to the chunk.
+struct OBJIndex {
+    std::int64_t value = 0;
+    bool relative = false;
+    bool present = false;
+};
+
+struct OBJCorner {
+    OBJIndex position;
+    OBJIndex uv;
+    OBJIndex normal;
+};
+
+struct OBJChunk {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<OBJCorner> corners;
+    /// The number of corners in each face, in order.
+    std::vector<std::uint32_t> faceSizes;
+    std::size_t invalidLines = 0;
+};
+
+[[nodiscard]] bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+[[nodiscard]] const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && isSpace(*p))
+        p++;
+    return p;
+}
+
+[[nodiscard]] bool parseFloat(const char*& p, const char* end, float& out) {
+    p = skipSpaces(p, end);
+    // from_chars doesn't take a leading plus
+    if (p < end && *p == '+')
+        p++;
+    const auto [next, error] = std::from_chars(p, end, out);
+    if (error != std::errc{})
+        return false;
+    p = next;
+    return true;
+}
+
+[[nodiscard]] bool parseIndex(const char*& p, const char* end, std::size_t count, OBJIndex& out) {
+    std::int64_t value;
+    const auto [next, error] = std::from_chars(p, end, value);
+    if (error != std::errc{} || value == 0)
+        return false;
+    p = next;
+    out.present = true;
+    if (value > 0) {
+        out.value = value - 1;
+        out.relative = false;
+    } else {
+        out.value = static_cast<std::int64_t>(count) + value;
+        out.relative = true;
+    }
+    return true;
+}
+
+/// Parses a list of corners like "1 2 3", "1/2 2/3 3/4", "1//2 2//3 3//4", or "1/2/3 2/3/4 3/4/5".
+[[nodiscard]] bool parseFace(const char* p, const char* end, OBJChunk& chunk) {
+    std::uint32_t size = 0;
+    while (true) {
+        p = skipSpaces(p, end);
+        if (p == end)
+            break;
+        OBJCorner corner;
+        if (!parseIndex(p, end, chunk.positions.size(), corner.position))
+            return false;
+        if (p < end && *p == '/') {
+            p++;
+            if (p < end && *p != '/' && !isSpace(*p) && !parseIndex(p, end, chunk.uvs.size(), corner.uv))
+                return false;
+            if (p < end && *p == '/') {
+                p++;
+                if (!parseIndex(p, end, chunk.normals.size(), corner.normal))
+                    return false;
+            }
+        }
+        if (p < end && !isSpace(*p))
+            return false;
+        chunk.corners.push_back(corner);
+        size++;
+    }
+    if (size < 3) {
+        chunk.corners.resize(chunk.corners.size() - size);
+        return false;
+    }
+    chunk.faceSizes.push_back(size);
+    return true;
+}
+
+/// Returns false if the line is not valid.
+[[nodiscard]] bool parseLine(const char* p, const char* end, OBJChunk& chunk) {
+    p = skipSpaces(p, end);
+    const char* keyword = p;
+    while (p < end && !isSpace(*p))
+        p++;
+    const std::string_view type{keyword, static_cast<std::size_t>(p - keyword)};
+
+    if (type == "v") {
+        glm::vec3 position;
+        if (!parseFloat(p, end, position.x) || !parseFloat(p, end, position.y) || !parseFloat(p, end, position.z))
+            return false;
+        chunk.positions.push_back(position);
+    } else if (type == "vt") {
+        glm::vec2 uv{0.f};
+        if (!parseFloat(p, end, uv.x))
+            return false;
+        // The second coordinate is optional
+        if (!parseFloat(p, end, uv.y))
+            uv.y = 0.f;
+        chunk.uvs.push_back(uv);
+    } else if (type == "vn") {
+        glm::vec3 normal;
+        if (!parseFloat(p, end, normal.x) || !parseFloat(p, end, normal.y) || !parseFloat(p, end, normal.z))
+            return false;
+        chunk.normals.push_back(normal);
+    } else if (type == "f") {
+        return parseFace(p, end, chunk);
+    }
+    // Everything else is either empty or something meshes don't use (groups, materials, smoothing...)
+    return true;
+}
+
+void parseChunk(const char* begin, const char* end, OBJChunk& chunk) {
+    while (begin < end) {
+        const auto* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        if (!lineEnd)
+            lineEnd = end;
+        const char* contentEnd = lineEnd;
+        if (const auto* comment = static_cast<const char*>(std::memchr(begin, '#', lineEnd - begin)))
+            contentEnd = comment;
+        if (!parseLine(begin, contentEnd, chunk))
+            chunk.invalidLines++;
+        begin = lineEnd + 1;
+    }
+}
+
+/// Splits the file at line breaks into at most maxChunks pieces that are at least the size set by obj_loader_chunk_kb.
+[[nodiscard]] std::vector<std::pair<const char*, const char*>> splitChunks(const char* begin, const char* end, std::size_t maxChunks) {
+    const auto size = static_cast<std::size_t>(end - begin);
+    const auto minChunkSize = static_cast<std::size_t>(std::max(obj_loader_chunk_kb.getValue<int>(), 0)) * 1024;
+    std::size_t chunkCount = 1;
+    if (minChunkSize > 0)
+        chunkCount = std::clamp<std::size_t>(size / minChunkSize, 1, maxChunks);
+
+    std::vector<std::pair<const char*, const char*>> chunks;
+    const char* chunkBegin = begin;
+    for (std::size_t i = 1; i < chunkCount && chunkBegin < end; i++) {
+        const char* split = std::max(begin + size * i / chunkCount, chunkBegin);
+        const auto* lineEnd = static_cast<const char*>(std::memchr(split, '\n', end - split));
+        if (!lineEnd)
+            break;
+        chunks.emplace_back(chunkBegin, lineEnd + 1);
+        chunkBegin = lineEnd + 1;
+    }
+    chunks.emplace_back(chunkBegin, end);
+    return chunks;
+}
+
+/// Turns an index from a chunk into an index into the whole attribute list, or returns false if it's out of range.
+[[nodiscard]] bool resolveIndex(const OBJIndex& index, std::size_t chunkOffset, std::size_t count, std::size_t& out) {
+    const auto value = index.relative ? static_cast<std::int64_t>(chunkOffset) + index.value : index.value;
+    if (value < 0 || static_cast<std::size_t>(value) >= count)
+        return false;
+    out = static_cast<std::size_t>(value);
+    return true;
+}
+
+void appendString(std::vector<byte>& out, std::string_view str) {
+    out.insert(out.end(), str.begin(), str.end());
+}
+
+template<typename T>
+void appendNumber(std::vector<byte>& out, T number) {
+    char buffer[32];
+    // Floats are written in the shortest form that reads back to the same value
+    const auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out.insert(out.end(), buffer, end);
+}
+
+} // namespace
+
 void OBJMeshLoader::loadMesh(const std::string& identifier, std::vector<Vertex>& vertices, std::vector<Index>& indices) const {
-    std::vector<glm::vec3> vertexBuffer;
-    std::vector<ColorRG> uvBuffer;
-    std::vector<ColorRGB> normalBuffer;
-
-    auto meshData = Resource::getResource<StringResource>(identifier);
-    std::istringstream meshDataStream{meshData->getString()};
-
-    std::string line;
-    Index currentIndex = 0;
-    while (std::getline(meshDataStream, line)) {
-        if (line.substr(0,2) == "v ") {
-            glm::vec3 pos;
-            std::istringstream iss(line.substr(2));
-            iss >> pos.x >> pos.y >> pos.z;
-            vertexBuffer.push_back(pos);
-        } else if (line.substr(0,3) == "vt ") {
-            ColorRG uv;
-            std::istringstream iss(line.substr(2));
-            iss >> uv.r >> uv.g;
-            uvBuffer.push_back(uv);
-        } else if (line.substr(0,3) == "vn ") {
-            ColorRGB normal;
-            std::istringstream iss(line.substr(2));
-            iss >> normal.r >> normal.g >> normal.b;
-            normalBuffer.push_back(normal);
-        } else if (line.substr(0,2) == "f ") {
-            // this line has 10 zeroes to check if OBJ is triangulated concisely
-            int objIndices[10];
-            std::string data = line.substr(2);
-            std::replace(data.begin(), data.end(), '/', ' ');
-            std::istringstream iss(data);
-            unsigned short counter = 0;
-            bool includeUVs = false;
-            while (iss >> objIndices[counter]) {
-                objIndices[counter] -= 1;
-                if (counter >= 9) {
-                    LOG_OBJ.warning(TRF("warn.obj_loader.not_triangulated", identifier));
+    // Parse straight from the provider's view instead of copying the file into a string first
+    const ResourceID id{identifier};
+    auto* provider = Resource::getResourceProviderWithResource(id);
+    if (!provider) {
+        LOG_OBJ.error(TRF("error.obj_loader.unable_to_read", identifier));
+        return;
+    }
+    const auto meshData = provider->readResource(id.getName());
+    const auto* begin = reinterpret_cast<const char*>(meshData.getData());
+    const auto* end = begin + meshData.getSize();
+
+    // Small files are one chunk and parsed right here, the loading thread helps with the rest of the chunks
+    auto& pool = Resource::getLoadingPool();
+    const auto ranges = splitChunks(begin, end, pool.getThreadCount() + 1);
+    std::vector<OBJChunk> chunks(ranges.size());
+    if (ranges.size() == 1) {
+        parseChunk(ranges[0].first, ranges[0].second, chunks[0]);
+    } else {
+        pool.parallelFor(ranges.size(), [&ranges, &chunks](std::size_t i) {
+            parseChunk(ranges[i].first, ranges[i].second, chunks[i]);
+        });
+    }
+
+    // Chunks can refer to attributes from the chunks before them, so gather them all before building faces
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::size_t invalidLines = 0;
+    std::size_t triangleCount = 0;
+    for (const auto& chunk : chunks) {
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        invalidLines += chunk.invalidLines;
+        for (const auto faceSize : chunk.faceSizes) {
+            triangleCount += faceSize - 2;
+        }
+    }
+
+    VertexWelder welder{vertices.size() + std::max({positions.size(), uvs.size(), normals.size()})};
+    indices.reserve(indices.size() + triangleCount * 3);
+
+    std::size_t positionOffset = 0, uvOffset = 0, normalOffset = 0;
+    std::vector<Vertex> face;
+    for (const auto& chunk : chunks) {
+        auto corner = chunk.corners.begin();
+        for (const auto faceSize : chunk.faceSizes) {
+            // Resolve the whole face before welding any of it, so a bad face doesn't leave unused vertices behind
+            face.clear();
+            for (std::uint32_t i = 0; i < faceSize; i++, corner++) {
+                std::size_t position, uv = 0, normal = 0;
+                if (!resolveIndex(corner->position, positionOffset, positions.size(), position) ||
+                    (corner->uv.present && !resolveIndex(corner->uv, uvOffset, uvs.size(), uv)) ||
+                    (corner->normal.present && !resolveIndex(corner->normal, normalOffset, normals.size(), normal))) {
+                    // Skip the rest of the face
+                    corner += faceSize - i;
                     break;
-                } else if (counter >= 6) {
-                    includeUVs = true;
                 }
-                counter++;
+                face.emplace_back(
+                        positions[position],
+                        corner->normal.present ? ColorRGB{normals[normal].x, normals[normal].y, normals[normal].z} : ColorRGB{},
+                        ColorRGB{1, 1, 1},
+                        corner->uv.present ? ColorRG{uvs[uv].x, uvs[uv].y} : ColorRG{});
             }
-            if (includeUVs) {
-                addVertex({{vertexBuffer[objIndices[0]].x, vertexBuffer[objIndices[0]].y, vertexBuffer[objIndices[0]].z},
-                           {normalBuffer[objIndices[2]].r, normalBuffer[objIndices[2]].g, normalBuffer[objIndices[2]].b},
-                           {uvBuffer[objIndices[1]].r, uvBuffer[objIndices[1]].g}},
-                          &currentIndex, vertices, indices);
-                addVertex({{vertexBuffer[objIndices[3]].x, vertexBuffer[objIndices[3]].y, vertexBuffer[objIndices[3]].z},
-                           {normalBuffer[objIndices[5]].r, normalBuffer[objIndices[5]].g, normalBuffer[objIndices[5]].b},
-                           {uvBuffer[objIndices[4]].r, uvBuffer[objIndices[4]].g}},
-                          &currentIndex, vertices, indices);
-                addVertex({{vertexBuffer[objIndices[6]].x, vertexBuffer[objIndices[6]].y, vertexBuffer[objIndices[6]].z},
-                           {normalBuffer[objIndices[8]].r, normalBuffer[objIndices[8]].g, normalBuffer[objIndices[8]].b},
-                           {uvBuffer[objIndices[7]].r, uvBuffer[objIndices[7]].g}},
-                          &currentIndex, vertices, indices);
-            } else {
-                addVertex({{vertexBuffer[objIndices[0]].x, vertexBuffer[objIndices[0]].y, vertexBuffer[objIndices[0]].z},
-                           {normalBuffer[objIndices[1]].r, normalBuffer[objIndices[1]].g, normalBuffer[objIndices[1]].b}},
-                          &currentIndex, vertices, indices);
-                addVertex({{vertexBuffer[objIndices[2]].x, vertexBuffer[objIndices[2]].y, vertexBuffer[objIndices[2]].z},
-                           {normalBuffer[objIndices[3]].r, normalBuffer[objIndices[3]].g, normalBuffer[objIndices[3]].b}},
-                          &currentIndex, vertices, indices);
-                addVertex({{vertexBuffer[objIndices[4]].x, vertexBuffer[objIndices[4]].y, vertexBuffer[objIndices[4]].z},
-                           {normalBuffer[objIndices[5]].r, normalBuffer[objIndices[5]].g, normalBuffer[objIndices[5]].b}},
-                          &currentIndex, vertices, indices);
+            if (face.size() != faceSize) {
+                invalidLines++;
+                continue;
+            }
+            // Polygons are split into a fan of triangles around the first corner
+            const auto first = welder.weld(vertices, face[0]);
+            auto previous = welder.weld(vertices, face[1]);
+            for (std::uint32_t i = 2; i < faceSize; i++) {
+                const auto current = welder.weld(vertices, face[i]);
+                indices.push_back(first);
+                indices.push_back(previous);
+                indices.push_back(current);
+                previous = current;
             }
         }
+        positionOffset += chunk.positions.size();
+        uvOffset += chunk.uvs.size();
+        normalOffset += chunk.normals.size();
     }
-}
 
-void OBJMeshLoader::addVertex(Vertex v, Index* currentIndex, std::vector<Vertex>& vertices, std::vector<Index>& indices) {
-    auto position = std::find(vertices.begin(), vertices.end(), v);
-    if (position != vertices.end()) {
-        indices.push_back(static_cast<Index>(position - vertices.begin()));
-    } else {
-        vertices.push_back(v);
-        indices.push_back(*currentIndex);
-        *currentIndex += 1;
+    if (invalidLines > 0) {
+        LOG_OBJ.warning(TRF("warn.obj_loader.invalid_lines", identifier, invalidLines));
     }
 }
 
 std::vector<byte> OBJMeshLoader::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) const {
-    std::stringstream meshDataStream;
-    meshDataStream.setf(std::stringstream::fixed);
-    // The following could be modified to actually use indices and save file space...
-    // But it doesn't have to be right now :P
-    for (const auto index : indices) {
-        meshDataStream << "v " << std::setprecision(6) << vertices[index].position.x << ' ' << vertices[index].position.y << ' ' << vertices[index].position.z << '\n';
-        meshDataStream << "vt " << std::setprecision(6) << vertices[index].uv.r << ' ' << vertices[index].uv.g << '\n';
-        meshDataStream << "vn " << std::setprecision(6) << vertices[index].normal.r << ' ' << vertices[index].normal.g << ' ' << vertices[index].normal.b << '\n';
+    std::vector<byte> out;
+    // Roughly how long the lines end up, so the buffer doesn't keep growing
+    out.reserve(vertices.size() * 96 + indices.size() * 24);
+
+    for (const auto& vertex : vertices) {
+        appendString(out, "v ");
+        appendNumber(out, vertex.position.x);
+        out.push_back(' ');
+        appendNumber(out, vertex.position.y);
+        out.push_back(' ');
+        appendNumber(out, vertex.position.z);
+        out.push_back('\n');
     }
-    for (Index i = 1; i < indices.size() + 1; i += 3) {
-        meshDataStream << "f " << i   << '/' << i   << '/' << i   << ' '
-                               << i+1 << '/' << i+1 << '/' << i+1 << ' '
-                               << i+2 << '/' << i+2 << '/' << i+2 << '\n';
+    for (const auto& vertex : vertices) {
+        appendString(out, "vt ");
+        appendNumber(out, vertex.uv.r);
+        out.push_back(' ');
+        appendNumber(out, vertex.uv.g);
+        out.push_back('\n');
+    }
+    for (const auto& vertex : vertices) {
+        appendString(out, "vn ");
+        appendNumber(out, vertex.normal.r);
+        out.push_back(' ');
+        appendNumber(out, vertex.normal.g);
+        out.push_back(' ');
+        appendNumber(out, vertex.normal.b);
+        out.push_back('\n');
+    }
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        appendString(out, "f");
+        for (std::size_t j = i; j < i + 3; j++) {
+            const auto index = indices[j] + 1;
+            out.push_back(' ');
+            appendNumber(out, index);
+            out.push_back('/');
+            appendNumber(out, index);
+            out.push_back('/');
+            appendNumber(out, index);
+        }
+        out.push_back('\n');
     }
-    meshDataStream >> std::noskipws;
-
-    std::vector<byte> out;
-    byte temp;
-    while (meshDataStream >> temp)
-        out.push_back(temp);
     return out;
 }
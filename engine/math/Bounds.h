@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Vertex.h"
+
+namespace chira {
+
+/// An axis aligned box and a sphere around the same vertices.
+struct Bounds {
+    glm::vec3 min{};
+    glm::vec3 max{};
+    glm::vec3 center{};
+    /// Negative when there's nothing inside.
+    float radius = -1.f;
+
+    /// The sphere is centered on the box, which is close enough to the smallest sphere for culling and cheap to find.
+    [[nodiscard]] static Bounds fromVertices(const Vertex* vertices, std::size_t count) {
+        Bounds bounds;
+        if (!count)
+            return bounds;
+        bounds.min = bounds.max = vertices[0].position;
+        for (std::size_t i = 1; i < count; i++) {
+            bounds.min = glm::min(bounds.min, vertices[i].position);
+            bounds.max = glm::max(bounds.max, vertices[i].position);
+        }
+        bounds.center = (bounds.min + bounds.max) * 0.5f;
+        float radiusSquared = 0.f;
+        for (std::size_t i = 0; i < count; i++) {
+            const auto offset = vertices[i].position - bounds.center;
+            radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+        }
+        bounds.radius = std::sqrt(radiusSquared);
+        return bounds;
+    }
+
+    [[nodiscard]] static Bounds fromVertices(const std::vector<Vertex>& vertices) {
+        return fromVertices(vertices.data(), vertices.size());
+    }
+
+    [[nodiscard]] bool isEmpty() const {
+        return this->radius < 0.f;
+    }
+
+    /// Grows the bounds to hold the vertices. The sphere only grows as much as each vertex outside it needs,
+    /// so it can end up looser than the one fromVertices() would find.
+    void extend(const Vertex* vertices, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            const auto& position = vertices[i].position;
+            if (this->isEmpty()) {
+                this->min = this->max = this->center = position;
+                this->radius = 0.f;
+                continue;
+            }
+            this->min = glm::min(this->min, position);
+            this->max = glm::max(this->max, position);
+            const auto distance = glm::length(position - this->center);
+            if (distance > this->radius) {
+                const auto newRadius = (this->radius + distance) * 0.5f;
+                this->center += (position - this->center) * ((newRadius - this->radius) / distance);
+                this->radius = newRadius;
+            }
+        }
+    }
+
+    /// Grows the bounds to hold other bounds.
+    void merge(const Bounds& other) {
+        if (other.isEmpty())
+            return;
+        if (this->isEmpty()) {
+            *this = other;
+            return;
+        }
+        this->min = glm::min(this->min, other.min);
+        this->max = glm::max(this->max, other.max);
+        const auto distance = glm::length(other.center - this->center);
+        if (distance + other.radius <= this->radius)
+            return;
+        if (distance + this->radius <= other.radius) {
+            this->center = other.center;
+            this->radius = other.radius;
+            return;
+        }
+        const auto newRadius = (distance + this->radius + other.radius) * 0.5f;
+        this->center += (other.center - this->center) * ((newRadius - this->radius) / distance);
+        this->radius = newRadius;
+    }
+
+    /// The bounds after moving them by a model matrix, without going back to the vertices.
+    /// The box is the smallest one that holds the transformed box, and the sphere is scaled by the largest axis.
+    [[nodiscard]] Bounds transform(const glm::mat4& matrix) const {
+        if (this->isEmpty())
+            return *this;
+        const auto boxCenter = glm::vec3{matrix * glm::vec4{(this->min + this->max) * 0.5f, 1.f}};
+        const auto extent = (this->max - this->min) * 0.5f;
+        glm::vec3 newExtent{};
+        for (int column = 0; column < 3; column++) {
+            newExtent += glm::abs(glm::vec3{matrix[column]}) * extent[column];
+        }
+        const float scale = std::max({glm::length(glm::vec3{matrix[0]}), glm::length(glm::vec3{matrix[1]}), glm::length(glm::vec3{matrix[2]})});
+        return {
+                .min = boxCenter - newExtent,
+                .max = boxCenter + newExtent,
+                .center = glm::vec3{matrix * glm::vec4{this->center, 1.f}},
+                .radius = this->radius * scale,
+        };
+    }
+};
+
+} // namespace chira
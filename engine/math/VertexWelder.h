@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+
+namespace chira {
+
+/// Finds vertices that were already added to a vertex list in constant time, so indexed meshes can be built in linear time.
+/// The vertex list is passed to every call instead of being held, and vertices added to it by other means are picked up
+/// the next time it is used. If the list is cleared or shrinks, the welder starts over.
+class VertexWelder {
+public:
+    /// With an epsilon of 0, only vertices that compare equal are welded. Otherwise every attribute is snapped to a grid
+    /// epsilon wide, and vertices in the same grid cell are welded onto the first of them.
+    explicit VertexWelder(std::size_t expectedVertexCount = 0, float epsilon_ = 0.f)
+            : epsilon(epsilon_) {
+        this->reserve(expectedVertexCount);
+    }
+
+    /// Returns the index of a matching vertex, adding the vertex to the end of the list if there isn't one.
+    Index weld(std::vector<Vertex>& vertices, const Vertex& vertex) {
+        this->sync(vertices);
+        const auto hash = this->hashVertex(vertex);
+        const auto mask = this->buckets.size() - 1;
+        auto bucket = static_cast<std::size_t>(hash) & mask;
+        for (; this->buckets[bucket] != 0; bucket = (bucket + 1) & mask) {
+            if (const auto index = this->buckets[bucket] - 1; this->matches(vertices[index], vertex))
+                return index;
+        }
+        vertices.push_back(vertex);
+        this->buckets[bucket] = static_cast<Index>(vertices.size());
+        this->weldedCount = vertices.size();
+        if (this->weldedCount * 2 > this->buckets.size())
+            this->rehash(vertices, this->buckets.size() * 2);
+        return static_cast<Index>(vertices.size() - 1);
+    }
+
+    /// Makes room for the given number of vertices without rehashing.
+    void reserve(std::size_t vertexCount) {
+        if (vertexCount * 2 <= this->buckets.size())
+            return;
+        this->buckets.assign(std::bit_ceil(std::max<std::size_t>(vertexCount * 2, 16)), 0);
+        // The vertices are indexed again the next time the list is seen
+        this->weldedCount = 0;
+    }
+
+    /// Forgets every vertex.
+    void clear() {
+        std::fill(this->buckets.begin(), this->buckets.end(), 0);
+        this->weldedCount = 0;
+    }
+
+    [[nodiscard]] float getEpsilon() const {
+        return this->epsilon;
+    }
+private:
+    static constexpr std::size_t ATTRIBUTE_COUNT = 11;
+
+    /// 0 is an empty bucket, anything else is a vertex index plus one.
+    std::vector<Index> buckets = std::vector<Index>(16, 0);
+    std::size_t weldedCount = 0;
+    float epsilon;
+
+    [[nodiscard]] static std::array<float, ATTRIBUTE_COUNT> getAttributes(const Vertex& vertex) {
+        return {
+                vertex.position.x, vertex.position.y, vertex.position.z,
+                vertex.normal.r, vertex.normal.g, vertex.normal.b,
+                vertex.color.r, vertex.color.g, vertex.color.b,
+                vertex.uv.r, vertex.uv.g,
+        };
+    }
+
+    /// The grid cell of an attribute, or its bits if there is no grid.
+    [[nodiscard]] std::uint64_t getAttributeKey(float attribute) const {
+        if (this->epsilon > 0.f)
+            return static_cast<std::uint64_t>(static_cast<std::int64_t>(std::floor(attribute / this->epsilon + 0.5f)));
+        // Adding zero turns -0 into 0, they compare equal so they have to hash the same
+        return std::bit_cast<std::uint32_t>(attribute + 0.f);
+    }
+
+    [[nodiscard]] std::uint64_t hashVertex(const Vertex& vertex) const {
+        // FNV-1a over each attribute instead of each byte
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        for (float attribute : getAttributes(vertex)) {
+            hash ^= this->getAttributeKey(attribute);
+            hash *= 0x100000001b3ull;
+        }
+        // The low bits pick the bucket, mix the high bits into them
+        return hash ^ (hash >> 32);
+    }
+
+    [[nodiscard]] bool matches(const Vertex& lhs, const Vertex& rhs) const {
+        if (this->epsilon <= 0.f)
+            return lhs == rhs;
+        const auto lhsAttributes = getAttributes(lhs);
+        const auto rhsAttributes = getAttributes(rhs);
+        for (std::size_t i = 0; i < ATTRIBUTE_COUNT; i++) {
+            if (this->getAttributeKey(lhsAttributes[i]) != this->getAttributeKey(rhsAttributes[i]))
+                return false;
+        }
+        return true;
+    }
+
+    /// Indexes vertices that were added to the list since it was last seen.
+    void sync(const std::vector<Vertex>& vertices) {
+        if (vertices.size() == this->weldedCount)
+            return;
+        if (vertices.size() < this->weldedCount) {
+            this->clear();
+        }
+        if (vertices.size() * 2 > this->buckets.size()) {
+            this->rehash(vertices, std::bit_ceil(vertices.size() * 2));
+            return;
+        }
+        for (std::size_t i = this->weldedCount; i < vertices.size(); i++) {
+            this->insert(vertices, static_cast<Index>(i));
+        }
+        this->weldedCount = vertices.size();
+    }
+
+    void rehash(const std::vector<Vertex>& vertices, std::size_t bucketCount) {
+        this->buckets.assign(bucketCount, 0);
+        for (std::size_t i = 0; i < vertices.size(); i++) {
+            this->insert(vertices, static_cast<Index>(i));
+        }
+        this->weldedCount = vertices.size();
+    }
+
+    /// Duplicates are inserted too, but lookups always find the first of them.
+    void insert(const std::vector<Vertex>& vertices, Index index) {
+        const auto mask = this->buckets.size() - 1;
+        auto bucket = static_cast<std::size_t>(this->hashVertex(vertices[index])) & mask;
+        while (this->buckets[bucket] != 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        this->buckets[bucket] = index + 1;
+    }
+};
+
+} // namespace chira
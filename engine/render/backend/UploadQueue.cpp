@@ -0,0 +1,114 @@
+#include "UploadQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <config/ConEntry.h>
+
+using namespace chira;
+
+[[maybe_unused]]
+ConVar gpu_upload_budget_ms{"gpu_upload_budget_ms", 2.0, "The time in milliseconds each frame can spend uploading newly loaded assets to the GPU.", CON_FLAG_CACHE};
+
+[[maybe_unused]]
+ConVar gpu_upload_budget_kb{"gpu_upload_budget_kb", 16384, "The amount of data in kilobytes each frame can upload to the GPU for newly loaded assets.", CON_FLAG_CACHE};
+
+namespace {
+
+struct QueuedUpload {
+    UploadQueue::Ticket ticket;
+    std::size_t size;
+    std::function<void()> upload;
+};
+
+std::mutex queueMutex;
+std::deque<QueuedUpload> queue;
+UploadQueue::Ticket lastTicket = 0;
+
+/// Pops the next upload so it can run without holding the lock, since uploads can queue more uploads.
+bool popUpload(QueuedUpload& upload) {
+    std::scoped_lock lock{queueMutex};
+    if (queue.empty())
+        return false;
+    upload = std::move(queue.front());
+    queue.pop_front();
+    return true;
+}
+
+} // namespace
+
+UploadQueue::Ticket UploadQueue::enqueue(std::size_t size, std::function<void()> upload) {
+    std::scoped_lock lock{queueMutex};
+    queue.push_back({++lastTicket, size, std::move(upload)});
+    return lastTicket;
+}
+
+void UploadQueue::cancel(Ticket ticket) {
+    if (!ticket)
+        return;
+    std::scoped_lock lock{queueMutex};
+    std::erase_if(queue, [ticket](const QueuedUpload& upload) {
+        return upload.ticket == ticket;
+    });
+}
+
+void UploadQueue::run(Ticket ticket) {
+    if (!ticket)
+        return;
+    QueuedUpload upload;
+    {
+        std::scoped_lock lock{queueMutex};
+        const auto queued = std::find_if(queue.begin(), queue.end(), [ticket](const QueuedUpload& upload_) {
+            return upload_.ticket == ticket;
+        });
+        if (queued == queue.end())
+            return;
+        upload = std::move(*queued);
+        queue.erase(queued);
+    }
+    upload.upload();
+}
+
+bool UploadQueue::isPending(Ticket ticket) {
+    std::scoped_lock lock{queueMutex};
+    return std::any_of(queue.begin(), queue.end(), [ticket](const QueuedUpload& upload) {
+        return upload.ticket == ticket;
+    });
+}
+
+void UploadQueue::update() {
+    const auto start = std::chrono::steady_clock::now();
+    const auto timeBudget = std::chrono::duration<double, std::milli>{gpu_upload_budget_ms.getValue<double>()};
+    const auto sizeBudget = static_cast<std::size_t>(std::max(gpu_upload_budget_kb.getValue<int>(), 0)) * 1024;
+
+    std::size_t uploaded = 0;
+    QueuedUpload upload;
+    while (popUpload(upload)) {
+        upload.upload();
+        uploaded += upload.size;
+        if (uploaded >= sizeBudget || std::chrono::steady_clock::now() - start >= timeBudget)
+            break;
+    }
+}
+
+void UploadQueue::flush() {
+    QueuedUpload upload;
+    while (popUpload(upload)) {
+        upload.upload();
+    }
+}
+
+std::size_t UploadQueue::getPendingCount() {
+    std::scoped_lock lock{queueMutex};
+    return queue.size();
+}
+
+std::size_t UploadQueue::getPendingSize() {
+    std::scoped_lock lock{queueMutex};
+    std::size_t total = 0;
+    for (const auto& upload : queue) {
+        total += upload.size;
+    }
+    return total;
+}
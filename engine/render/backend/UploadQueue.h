@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace chira {
+
+/// Spreads GPU uploads over several frames so a burst of loads doesn't stall one frame on the driver.
+/// Uploads run on the main thread in the order they were queued, until gpu_upload_budget_ms or
+/// gpu_upload_budget_kb is used up for the frame. Whatever is waiting should draw with a placeholder.
+class UploadQueue {
+public:
+    using Ticket = std::uint64_t;
+
+    UploadQueue() = delete;
+
+    /// Queues an upload of about the given size in bytes. Can be called from any thread.
+    /// The returned ticket is never 0, so 0 can be used to mean nothing is queued.
+    static Ticket enqueue(std::size_t size, std::function<void()> upload);
+    /// Drops an upload that hasn't run yet. Call this when whatever the upload writes to is destroyed.
+    static void cancel(Ticket ticket);
+    /// Runs a queued upload right now, ahead of the rest. Does nothing if it already ran or was cancelled.
+    static void run(Ticket ticket);
+    [[nodiscard]] static bool isPending(Ticket ticket);
+
+    /// Runs queued uploads until the frame's budget is used up. At least one runs every frame. Called once per frame.
+    static void update();
+    /// Runs every queued upload right now.
+    static void flush();
+
+    [[nodiscard]] static std::size_t getPendingCount();
+    /// The total size in bytes of the uploads still queued.
+    [[nodiscard]] static std::size_t getPendingSize();
+};
+
+} // namespace chira
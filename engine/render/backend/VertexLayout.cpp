@@ -0,0 +1,193 @@
+#include "VertexLayout.h"
+
+#include <cstring>
+#include <limits>
+#include <glm/packing.hpp>
+#include <core/Assertions.h>
+
+using namespace chira;
+
+// Layouts with every attribute as floats are uploaded straight from the vertices
+static_assert(sizeof(Vertex) == 44);
+
+namespace {
+
+[[nodiscard]] glm::vec4 getComponents(const Vertex& vertex, VertexAttribute attribute) {
+    switch (attribute) {
+        case VertexAttribute::POSITION:
+            return {vertex.position, 0.f};
+        case VertexAttribute::NORMAL:
+            return {vertex.normal.r, vertex.normal.g, vertex.normal.b, 0.f};
+        case VertexAttribute::COLOR:
+            return {vertex.color.r, vertex.color.g, vertex.color.b, 1.f};
+        case VertexAttribute::UV:
+            return {vertex.uv.r, vertex.uv.g, 0.f, 0.f};
+    }
+    return {};
+}
+
+template<typename T>
+byte* writeValue(byte* out, T value) {
+    std::memcpy(out, &value, sizeof(T));
+    return out + sizeof(T);
+}
+
+/// Writes the components two at a time, so an odd one out is padded with the next component.
+template<typename Pack>
+byte* writePairs(byte* out, glm::vec4 components, int count, Pack pack) {
+    for (int i = 0; i < count; i += 2) {
+        out = writeValue(out, pack(glm::vec2{components[i], components[i + 1]}));
+    }
+    return out;
+}
+
+[[nodiscard]] bool isInRange(glm::vec4 components, int count, float min, float max) {
+    for (int i = 0; i < count; i++) {
+        if (components[i] < min || components[i] > max)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+VertexLayout::VertexLayout(VertexAttributeFormat position, VertexAttributeFormat normal, VertexAttributeFormat color, VertexAttributeFormat uv)
+        : formats{position, normal, color, uv} {
+    runtime_assert(position != VertexAttributeFormat::NONE, "Vertex layouts must have positions!");
+}
+
+VertexLayout VertexLayout::fit(const std::vector<Vertex>& vertices, bool quantize /*= true*/) {
+    bool hasNormals = false, hasColors = false, hasUVs = false;
+    bool normalsFitSnorm = true, colorsFitUnorm = true, uvsFitUnorm = true;
+    const Vertex defaults{};
+    for (const auto& vertex : vertices) {
+        hasNormals |= vertex.normal != defaults.normal;
+        hasColors |= vertex.color != defaults.color;
+        hasUVs |= vertex.uv != defaults.uv;
+        normalsFitSnorm &= isInRange(getComponents(vertex, VertexAttribute::NORMAL), 3, -1.f, 1.f);
+        colorsFitUnorm &= isInRange(getComponents(vertex, VertexAttribute::COLOR), 3, 0.f, 1.f);
+        uvsFitUnorm &= isInRange(getComponents(vertex, VertexAttribute::UV), 2, 0.f, 1.f);
+    }
+
+    using Format = VertexAttributeFormat;
+    const auto normalFormat = quantize && normalsFitSnorm ? Format::SNORM16 : Format::FLOAT;
+    const auto colorFormat = quantize && colorsFitUnorm ? Format::UNORM8 : Format::FLOAT;
+    // Half floats lose precision towards 1, so UVs only use them when they don't fit
+    const auto uvFormat = quantize ? (uvsFitUnorm ? Format::UNORM16 : Format::HALF_FLOAT) : Format::FLOAT;
+    return {
+            Format::FLOAT,
+            hasNormals ? normalFormat : Format::NONE,
+            hasColors ? colorFormat : Format::NONE,
+            hasUVs ? uvFormat : Format::NONE,
+    };
+}
+
+VertexAttributeFormat VertexLayout::getFormat(VertexAttribute attribute) const {
+    return this->formats[static_cast<std::size_t>(attribute)];
+}
+
+bool VertexLayout::hasAttribute(VertexAttribute attribute) const {
+    return this->getFormat(attribute) != VertexAttributeFormat::NONE;
+}
+
+int VertexLayout::getComponentCount(VertexAttribute attribute) {
+    return attribute == VertexAttribute::UV ? 2 : 3;
+}
+
+glm::vec4 VertexLayout::getDefaultValue(VertexAttribute attribute) {
+    return getComponents(Vertex{}, attribute);
+}
+
+std::uint32_t VertexLayout::getSize(VertexAttribute attribute) const {
+    const auto components = static_cast<std::uint32_t>(getComponentCount(attribute));
+    switch (this->getFormat(attribute)) {
+        case VertexAttributeFormat::NONE:
+            return 0;
+        case VertexAttributeFormat::FLOAT:
+            return components * sizeof(float);
+        case VertexAttributeFormat::HALF_FLOAT:
+        case VertexAttributeFormat::SNORM16:
+        case VertexAttributeFormat::UNORM16:
+            return (components + 1) / 2 * sizeof(std::uint32_t);
+        case VertexAttributeFormat::UNORM8:
+            return sizeof(std::uint32_t);
+    }
+    return 0;
+}
+
+std::uint32_t VertexLayout::getOffset(VertexAttribute attribute) const {
+    std::uint32_t offset = 0;
+    for (std::size_t i = 0; i < static_cast<std::size_t>(attribute); i++) {
+        offset += this->getSize(static_cast<VertexAttribute>(i));
+    }
+    return offset;
+}
+
+std::uint32_t VertexLayout::getStride() const {
+    return this->getOffset(VertexAttribute::UV) + this->getSize(VertexAttribute::UV);
+}
+
+bool VertexLayout::matchesVertex() const {
+    return *this == VertexLayout{};
+}
+
+std::vector<byte> VertexLayout::pack(const std::vector<Vertex>& vertices) const {
+    std::vector<byte> out(vertices.size() * this->getStride());
+    this->pack(vertices.data(), vertices.size(), out.data());
+    return out;
+}
+
+void VertexLayout::pack(const Vertex* vertices, std::size_t count, byte* out) const {
+    if (this->matchesVertex()) {
+        std::memcpy(out, vertices, count * sizeof(Vertex));
+        return;
+    }
+    for (const auto* vertex = vertices; vertex != vertices + count; vertex++) {
+        for (std::size_t i = 0; i < VERTEX_ATTRIBUTE_COUNT; i++) {
+            const auto attribute = static_cast<VertexAttribute>(i);
+            const auto components = getComponents(*vertex, attribute);
+            const auto componentCount = getComponentCount(attribute);
+            switch (this->formats[i]) {
+                case VertexAttributeFormat::NONE:
+                    break;
+                case VertexAttributeFormat::FLOAT:
+                    for (int j = 0; j < componentCount; j++) {
+                        out = writeValue(out, components[j]);
+                    }
+                    break;
+                case VertexAttributeFormat::HALF_FLOAT:
+                    out = writePairs(out, components, componentCount, glm::packHalf2x16);
+                    break;
+                case VertexAttributeFormat::SNORM16:
+                    out = writePairs(out, components, componentCount, glm::packSnorm2x16);
+                    break;
+                case VertexAttributeFormat::UNORM16:
+                    out = writePairs(out, components, componentCount, glm::packUnorm2x16);
+                    break;
+                case VertexAttributeFormat::UNORM8:
+                    out = writeValue(out, glm::packUnorm4x8(components));
+                    break;
+            }
+        }
+    }
+}
+
+std::uint32_t chira::getIndexSize(std::size_t vertexCount) {
+    return vertexCount <= static_cast<std::size_t>(std::numeric_limits<std::uint16_t>::max()) + 1 ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+}
+
+std::vector<byte> chira::packIndices(const std::vector<Index>& indices, std::uint32_t indexSize) {
+    std::vector<byte> out(indices.size() * indexSize);
+    packIndices(indices.data(), indices.size(), indexSize, out.data());
+    return out;
+}
+
+void chira::packIndices(const Index* indices, std::size_t count, std::uint32_t indexSize, byte* out) {
+    if (indexSize == sizeof(std::uint16_t)) {
+        for (const auto* index = indices; index != indices + count; index++) {
+            out = writeValue(out, static_cast<std::uint16_t>(*index));
+        }
+    } else {
+        std::memcpy(out, indices, count * sizeof(Index));
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <math/Types.h>
+#include <math/Vertex.h>
+
+namespace chira {
+
+/// The attributes of a Vertex, in the order they're stored. Each one's shader location is its value here.
+enum class VertexAttribute {
+    POSITION,
+    NORMAL,
+    COLOR,
+    UV,
+};
+constexpr std::size_t VERTEX_ATTRIBUTE_COUNT = 4;
+
+enum class VertexAttributeFormat {
+    /// Not uploaded, shaders read the attribute's default value instead.
+    NONE,
+    FLOAT,
+    HALF_FLOAT,
+    /// Signed normalized 16-bit integers, for values between -1 and 1.
+    SNORM16,
+    /// Unsigned normalized 16-bit integers, for values between 0 and 1.
+    UNORM16,
+    /// Unsigned normalized 8-bit integers, for values between 0 and 1.
+    UNORM8,
+};
+
+/// Which attributes of a Vertex are uploaded, and how each one is stored. They are interleaved in attribute order,
+/// and each is padded to a multiple of 4 bytes so it stays aligned.
+class VertexLayout {
+public:
+    /// Every attribute as floats, which is stored exactly like Vertex.
+    VertexLayout() = default;
+    /// Positions can't be left out.
+    VertexLayout(VertexAttributeFormat position, VertexAttributeFormat normal, VertexAttributeFormat color, VertexAttributeFormat uv);
+    /// Leaves out attributes that only ever hold their default value. If quantize is true, the normals, colors and UVs
+    /// that are left get the smallest format that holds their range. Positions are always floats.
+    [[nodiscard]] static VertexLayout fit(const std::vector<Vertex>& vertices, bool quantize = true);
+
+    [[nodiscard]] VertexAttributeFormat getFormat(VertexAttribute attribute) const;
+    [[nodiscard]] bool hasAttribute(VertexAttribute attribute) const;
+    /// How many components the attribute has in shaders and in Vertex, not counting padding.
+    [[nodiscard]] static int getComponentCount(VertexAttribute attribute);
+    /// What shaders read when the attribute is left out, which is what a default constructed Vertex holds.
+    [[nodiscard]] static glm::vec4 getDefaultValue(VertexAttribute attribute);
+    /// In bytes, including padding. 0 if the attribute is left out.
+    [[nodiscard]] std::uint32_t getSize(VertexAttribute attribute) const;
+    /// In bytes, from the start of a vertex.
+    [[nodiscard]] std::uint32_t getOffset(VertexAttribute attribute) const;
+    [[nodiscard]] std::uint32_t getStride() const;
+    /// True if the layout is stored exactly like Vertex, so vertices can be uploaded without packing them.
+    [[nodiscard]] bool matchesVertex() const;
+    /// Converts the vertices to this layout.
+    [[nodiscard]] std::vector<byte> pack(const std::vector<Vertex>& vertices) const;
+    /// Converts count vertices to this layout, writing them to out, which must have room for count times the stride.
+    void pack(const Vertex* vertices, std::size_t count, byte* out) const;
+
+    bool operator==(const VertexLayout& other) const = default;
+private:
+    std::array<VertexAttributeFormat, VERTEX_ATTRIBUTE_COUNT> formats{
+            VertexAttributeFormat::FLOAT, VertexAttributeFormat::FLOAT, VertexAttributeFormat::FLOAT, VertexAttributeFormat::FLOAT,
+    };
+};
+
+/// 2 when every index into this many vertices fits in 16 bits, otherwise 4.
+[[nodiscard]] std::uint32_t getIndexSize(std::size_t vertexCount);
+/// Converts the indices to the given size, which is 2 or 4.
+[[nodiscard]] std::vector<byte> packIndices(const std::vector<Index>& indices, std::uint32_t indexSize);
+/// Converts count indices to the given size, writing them to out.
+void packIndices(const Index* indices, std::size_t count, std::uint32_t indexSize, byte* out);
+
+} // namespace chira
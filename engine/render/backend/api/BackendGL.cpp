@@ -1,6 +1,8 @@
 #include "BackendGL.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <map>
 #include <stack>
 #include <string>
@@ -665,61 +667,216 @@ void Renderer::destroyUniformBuffer(Renderer::UniformBufferHandle handle) {
     return GL_BACK;
 }
 
-Renderer::MeshHandle Renderer::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode) {
-    MeshHandle handle{ .numIndices = static_cast<int>(indices.size()) };
+[[nodiscard]] static constexpr int getVertexAttributeFormatGL(VertexAttributeFormat format) {
+    switch (format) {
+        case VertexAttributeFormat::NONE:
+        case VertexAttributeFormat::FLOAT:
+            return GL_FLOAT;
+        case VertexAttributeFormat::HALF_FLOAT:
+            return GL_HALF_FLOAT;
+        case VertexAttributeFormat::SNORM16:
+            return GL_SHORT;
+        case VertexAttributeFormat::UNORM16:
+            return GL_UNSIGNED_SHORT;
+        case VertexAttributeFormat::UNORM8:
+            return GL_UNSIGNED_BYTE;
+    }
+    return GL_FLOAT;
+}
+
+[[nodiscard]] static constexpr int getIndexTypeGL(unsigned int indexSize) {
+    return indexSize == sizeof(std::uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+/// Points the bound vertex array at the bound vertex buffer. Attributes left out of the layout are disabled.
+static void setVertexAttributesGL(const VertexLayout& layout) {
+    for (unsigned int i = 0; i < VERTEX_ATTRIBUTE_COUNT; i++) {
+        const auto attribute = static_cast<VertexAttribute>(i);
+        if (!layout.hasAttribute(attribute)) {
+            glDisableVertexAttribArray(i);
+            continue;
+        }
+        const auto format = layout.getFormat(attribute);
+        const auto normalized = format != VertexAttributeFormat::FLOAT && format != VertexAttributeFormat::HALF_FLOAT;
+        glVertexAttribPointer(i, VertexLayout::getComponentCount(attribute), getVertexAttributeFormatGL(format),
+                              normalized ? GL_TRUE : GL_FALSE, static_cast<GLsizei>(layout.getStride()),
+                              reinterpret_cast<void*>(static_cast<std::uintptr_t>(layout.getOffset(attribute))));
+        glEnableVertexAttribArray(i);
+    }
+}
+
+/// Fills the bound vertex and index buffers, and returns the size of each index.
+static unsigned int uploadMeshBuffersGL(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const VertexLayout& layout, int glDrawMode) {
+    if (layout.matchesVertex()) {
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data(), glDrawMode);
+    } else {
+        const auto packed = layout.pack(vertices);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(packed.size()), packed.data(), glDrawMode);
+    }
+
+    const auto indexSize = getIndexSize(vertices.size());
+    if (indexSize == sizeof(Index)) {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(Index)), indices.data(), glDrawMode);
+    } else {
+        const auto packed = packIndices(indices, indexSize);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(packed.size()), packed.data(), glDrawMode);
+    }
+    return indexSize;
+}
+
+/// Waits for the GPU to pass the fence, then deletes it.
+static void waitForFenceGL(void*& fence) {
+    if (!fence)
+        return;
+    const auto sync = static_cast<GLsync>(fence);
+    while (glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000) == GL_TIMEOUT_EXPIRED) {}
+    glDeleteSync(sync);
+    fence = nullptr;
+}
+
+static void deleteFencesGL(Renderer::MeshHandle* handle) {
+    for (auto& fence : handle->fences) {
+        if (fence) {
+            glDeleteSync(static_cast<GLsync>(fence));
+            fence = nullptr;
+        }
+    }
+}
+
+/// Writes part of the bound buffer without waiting on the GPU, so only write parts that aren't being drawn from.
+template<typename Write>
+static void writeBufferRangeGL(GLenum target, std::size_t offset, std::size_t length, Write write) {
+    if (!length)
+        return;
+    auto* mapped = static_cast<byte*>(glMapBufferRange(target, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(length),
+                                                       GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    if (!mapped) {
+        LOG_GL.error("Failed to map mesh buffer for writing!");
+        return;
+    }
+    write(mapped);
+    glUnmapBuffer(target);
+}
+
+Renderer::MeshHandle Renderer::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const VertexLayout& layout, MeshDrawMode drawMode) {
+    MeshHandle handle{ .numIndices = static_cast<int>(indices.size()), .layout = layout };
     glGenVertexArrays(1, &handle.vaoHandle);
     glGenBuffers(1, &handle.vboHandle);
     glGenBuffers(1, &handle.eboHandle);
 
     glBindVertexArray(handle.vaoHandle);
-
-    const auto glDrawMode = getMeshDrawModeGL(drawMode);
-
     glBindBuffer(GL_ARRAY_BUFFER, handle.vboHandle);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data(), glDrawMode);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle.eboHandle);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(Index)), indices.data(), glDrawMode);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
-    glEnableVertexAttribArray(0);
-    // normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, normal)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, color)));
-    glEnableVertexAttribArray(2);
-    // texture coord attribute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, uv)));
-    glEnableVertexAttribArray(3);
+    setVertexAttributesGL(layout);
+    if (drawMode == MeshDrawMode::DYNAMIC) {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        streamMesh(&handle, vertices, indices, 0, 0, layout);
+        return handle;
+    }
+    handle.indexSize = uploadMeshBuffersGL(vertices, indices, layout, getMeshDrawModeGL(drawMode));
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
     return handle;
 }
 
-void Renderer::updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode) {
+void Renderer::updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const VertexLayout& layout, MeshDrawMode drawMode) {
     runtime_assert(static_cast<bool>(*handle), "Invalid mesh handle given to GL renderer!");
-    const auto glDrawMode = getMeshDrawModeGL(drawMode);
+    if (drawMode == MeshDrawMode::DYNAMIC) {
+        streamMesh(handle, vertices, indices, 0, 0, layout);
+        return;
+    }
+    glBindVertexArray(handle->vaoHandle);
     glBindBuffer(GL_ARRAY_BUFFER, handle->vboHandle);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data(), glDrawMode);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle->eboHandle);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(Index)), indices.data(), glDrawMode);
+    handle->indexSize = uploadMeshBuffersGL(vertices, indices, layout, getMeshDrawModeGL(drawMode));
+    if (layout != handle->layout) {
+        setVertexAttributesGL(layout);
+        handle->layout = layout;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
     handle->numIndices = static_cast<int>(indices.size());
 }
 
-void Renderer::drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType) {
+void Renderer::streamMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices,
+                          std::size_t firstVertex, std::size_t firstIndex, const VertexLayout& layout) {
+    runtime_assert(static_cast<bool>(*handle), "Invalid mesh handle given to GL renderer!");
+    glBindVertexArray(handle->vaoHandle);
+    glBindBuffer(GL_ARRAY_BUFFER, handle->vboHandle);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle->eboHandle);
+
+    // Nothing past what was last written can be unchanged
+    const auto uploadedIndices = static_cast<std::size_t>(handle->numIndices);
+    firstVertex = std::min({firstVertex, handle->numVertices, vertices.size()});
+    firstIndex = std::min({firstIndex, uploadedIndices, indices.size()});
+
+    const auto stride = layout.getStride();
+    const auto indexSize = getIndexSize(vertices.size());
+    if (vertices.size() > handle->vertexCapacity || indices.size() > handle->indexCapacity || layout != handle->layout || indexSize != handle->indexSize) {
+        if (vertices.size() > handle->vertexCapacity)
+            handle->vertexCapacity = std::max(vertices.size(), handle->vertexCapacity * 2);
+        if (indices.size() > handle->indexCapacity)
+            handle->indexCapacity = std::max(indices.size(), handle->indexCapacity * 2);
+        // Draws still reading the old storage keep it until they finish, so the fences aren't needed anymore
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(MESH_STREAM_SEGMENTS * handle->vertexCapacity * stride), nullptr, GL_DYNAMIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(MESH_STREAM_SEGMENTS * handle->indexCapacity * indexSize), nullptr, GL_DYNAMIC_DRAW);
+        deleteFencesGL(handle);
+        if (layout != handle->layout) {
+            setVertexAttributesGL(layout);
+            handle->layout = layout;
+        }
+        handle->indexSize = indexSize;
+        handle->segment = 0;
+        firstVertex = firstIndex = 0;
+    } else if (firstVertex < handle->numVertices || firstIndex < uploadedIndices) {
+        // Draws still in flight may be reading what changed, so move on to the next segment and write everything there
+        handle->fences[handle->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        handle->segment = (handle->segment + 1) % MESH_STREAM_SEGMENTS;
+        waitForFenceGL(handle->fences[handle->segment]);
+        firstVertex = firstIndex = 0;
+    }
+    // Otherwise only new vertices and indices were added, and nothing has been drawn from where they go yet
+
+    const auto vertexBase = handle->segment * handle->vertexCapacity;
+    writeBufferRangeGL(GL_ARRAY_BUFFER, (vertexBase + firstVertex) * stride, (vertices.size() - firstVertex) * stride, [&](byte* out) {
+        layout.pack(vertices.data() + firstVertex, vertices.size() - firstVertex, out);
+    });
+    const auto indexBase = handle->segment * handle->indexCapacity;
+    writeBufferRangeGL(GL_ELEMENT_ARRAY_BUFFER, (indexBase + firstIndex) * indexSize, (indices.size() - firstIndex) * indexSize, [&](byte* out) {
+        packIndices(indices.data() + firstIndex, indices.size() - firstIndex, indexSize, out);
+    });
+    handle->numVertices = vertices.size();
+    handle->numIndices = static_cast<int>(indices.size());
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void Renderer::drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType, int firstIndex, int numIndices) {
     runtime_assert(static_cast<bool>(handle), "Invalid mesh handle given to GL renderer!");
     pushState(RenderMode::CULL_FACE, true);
     glDepthFunc(getMeshDepthFunctionGL(depthFunction));
     glCullFace(getMeshCullTypeGL(cullType));
     glBindVertexArray(handle.vaoHandle);
-    glDrawElements(GL_TRIANGLES, handle.numIndices, GL_UNSIGNED_INT, nullptr);
+    // Attributes that weren't uploaded read the current value, which isn't part of the vertex array
+    for (unsigned int i = 0; i < VERTEX_ATTRIBUTE_COUNT; i++) {
+        const auto attribute = static_cast<VertexAttribute>(i);
+        if (!handle.layout.hasAttribute(attribute))
+            glVertexAttrib4fv(i, glm::value_ptr(VertexLayout::getDefaultValue(attribute)));
+    }
+    // Static meshes have no segments, so they always start at 0
+    const auto indexOffset = handle.segment * handle.indexCapacity + static_cast<std::size_t>(firstIndex);
+    glDrawElementsBaseVertex(GL_TRIANGLES, numIndices < 0 ? handle.numIndices : numIndices, getIndexTypeGL(handle.indexSize),
+                             reinterpret_cast<void*>(static_cast<std::uintptr_t>(indexOffset * handle.indexSize)),
+                             static_cast<GLint>(handle.segment * handle.vertexCapacity));
     popState(RenderMode::CULL_FACE);
 }
 
 void Renderer::destroyMesh(MeshHandle handle) {
     runtime_assert(static_cast<bool>(handle), "Invalid mesh handle given to GL renderer!");
+    deleteFencesGL(&handle);
     glDeleteVertexArrays(1, &handle.vaoHandle);
     glDeleteBuffers(1, &handle.vboHandle);
     glDeleteBuffers(1, &handle.eboHandle);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <string_view>
 #include <vector>
@@ -7,6 +8,7 @@
 #include <math/Color.h>
 #include <math/Vertex.h>
 #include "../RenderTypes.h"
+#include "../VertexLayout.h"
 
 struct SDL_Window;
 
@@ -59,11 +61,27 @@ struct UniformBufferHandle {
     inline bool operator!() const { return !handle; }
 };
 
+/// How many copies of a dynamic mesh its buffers hold, so one can be written while the others are drawn.
+constexpr std::size_t MESH_STREAM_SEGMENTS = 3;
+
 struct MeshHandle {
     unsigned int vaoHandle = 0;
     unsigned int vboHandle = 0;
     unsigned int eboHandle = 0;
     int numIndices = 0;
+    /// In bytes, 2 or 4.
+    unsigned int indexSize = sizeof(Index);
+    VertexLayout layout{};
+
+    // Only used by dynamic meshes
+    std::size_t numVertices = 0;
+    /// How many vertices and indices fit in each segment.
+    std::size_t vertexCapacity = 0;
+    std::size_t indexCapacity = 0;
+    /// The segment being drawn from.
+    std::size_t segment = 0;
+    /// Signaled once the GPU is done drawing from each segment.
+    std::array<void*, MESH_STREAM_SEGMENTS> fences{};
 
     explicit inline operator bool() const { return vaoHandle && vboHandle && eboHandle; }
     inline bool operator!() const { return !vaoHandle || !vboHandle || !eboHandle; }
@@ -122,9 +140,16 @@ void updateUniformBuffer(UniformBufferHandle handle, const void* buffer, std::pt
 void updateUniformBufferPart(UniformBufferHandle handle, std::ptrdiff_t start, const void* buffer, std::ptrdiff_t length);
 void destroyUniformBuffer(UniformBufferHandle handle);
 
-[[nodiscard]] MeshHandle createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode);
-void updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode);
-void drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType);
+/// The vertices are uploaded in the given layout. Indices are uploaded as 16-bit integers when they fit.
+[[nodiscard]] MeshHandle createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const VertexLayout& layout, MeshDrawMode drawMode);
+void updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const VertexLayout& layout, MeshDrawMode drawMode);
+/// Updates a dynamic mesh without reallocating its buffers, unless it outgrew them, in which case they double in size.
+/// Everything before firstVertex and firstIndex must be unchanged since the last update. If only new vertices and
+/// indices were added, only those are written. Otherwise the mesh is written to the next segment once the GPU is done with it.
+void streamMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices,
+                std::size_t firstVertex, std::size_t firstIndex, const VertexLayout& layout);
+/// Draws numIndices indices from firstIndex on, or all of them if numIndices is negative.
+void drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType, int firstIndex, int numIndices);
 void destroyMesh(MeshHandle handle);
 
 void initImGui(SDL_Window* window, void* context);
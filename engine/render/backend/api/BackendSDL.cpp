@@ -420,7 +420,7 @@ void Renderer::destroyUniformBuffer(Renderer::UniformBufferHandle handle) {
     STUBFUNC(destroyUniformBuffer);
 }
 
-Renderer::MeshHandle Renderer::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode) {
+Renderer::MeshHandle Renderer::createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const VertexLayout& layout, MeshDrawMode drawMode) {
     MeshHandle handle{ 
         .numIndices = static_cast<int>(indices.size()),
         .numVertices = static_cast<int>(vertices.size())
@@ -435,7 +435,7 @@ Renderer::MeshHandle Renderer::createMesh(const std::vector<Vertex>& vertices, c
     return handle;
 }
 
-void Renderer::updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode) {
+void Renderer::updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const VertexLayout& layout, MeshDrawMode drawMode) {
     runtime_assert(static_cast<bool>(*handle), "Invalid mesh handle given to SDL renderer!");
     handle->indices.clear();
     for (Index i : indices) {
@@ -449,7 +449,12 @@ void Renderer::updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertice
     handle->numVertices = static_cast<int>(vertices.size());
 }
 
-void Renderer::drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType) {
+void Renderer::streamMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices,
+                          std::size_t firstVertex, std::size_t firstIndex, const VertexLayout& layout) {
+    updateMesh(handle, vertices, indices, layout, MeshDrawMode::DYNAMIC);
+}
+
+void Renderer::drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType, int firstIndex, int numIndices) {
     runtime_assert(static_cast<bool>(handle), "Invalid mesh handle given to SDL renderer!");
     std::vector<SDL_Vertex> vertices;
 
@@ -471,7 +476,7 @@ void Renderer::drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, Mesh
 
     SDL_RenderGeometry(g_Renderer, nullptr, 
         vertices.data(), handle.numVertices,
-        handle.indices.data(), handle.numIndices
+        handle.indices.data() + firstIndex, numIndices < 0 ? handle.numIndices : numIndices
     );
 }
 
@@ -7,6 +7,7 @@
 #include <math/Color.h>
 #include <math/Vertex.h>
 #include "../RenderTypes.h"
+#include "../VertexLayout.h"
 
 struct SDL_Window;
 struct SDL_Renderer;
@@ -124,9 +125,14 @@ void updateUniformBuffer(UniformBufferHandle handle, const void* buffer, std::pt
 void updateUniformBufferPart(UniformBufferHandle handle, std::ptrdiff_t start, const void* buffer, std::ptrdiff_t length);
 void destroyUniformBuffer(UniformBufferHandle handle);
 
-[[nodiscard]] MeshHandle createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode);
-void updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, MeshDrawMode drawMode);
-void drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType);
+/// The layout is ignored, SDL draws straight from the vertices.
+[[nodiscard]] MeshHandle createMesh(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const VertexLayout& layout, MeshDrawMode drawMode);
+void updateMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices, const VertexLayout& layout, MeshDrawMode drawMode);
+/// Copies the whole mesh like updateMesh(), there are no GPU buffers to stream to.
+void streamMesh(MeshHandle* handle, const std::vector<Vertex>& vertices, const std::vector<Index>& indices,
+                std::size_t firstVertex, std::size_t firstIndex, const VertexLayout& layout);
+/// Draws numIndices indices from firstIndex on, or all of them if numIndices is negative.
+void drawMesh(MeshHandle handle, MeshDepthFunction depthFunction, MeshCullType cullType, int firstIndex, int numIndices);
 void destroyMesh(MeshHandle handle);
 
 void initImGui(SDL_Window* window, SDL_Renderer* renderer);
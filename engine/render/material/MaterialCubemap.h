@@ -7,7 +7,7 @@ namespace chira {
 
 class MaterialCubemap final : public IMaterial {
 public:
-    explicit MaterialCubemap(std::string identifier_) : IMaterial(std::move(identifier_)) {}
+    explicit MaterialCubemap(ResourceID identifier_) : IMaterial(identifier_) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
     void use() const override;
     [[nodiscard]] SharedPointer<TextureCubemap> getTextureCubemap() const;
@@ -2,8 +2,8 @@
 
 using namespace chira;
 
-IMaterial::IMaterial(std::string identifier_)
-        : Resource(std::move(identifier_)) {}
+IMaterial::IMaterial(ResourceID identifier_)
+        : Resource(identifier_) {}
 
 void IMaterial::compile(const byte buffer[], std::size_t bufferLength) {
     Serial::loadFromBuffer(this, buffer, bufferLength);
@@ -11,7 +11,7 @@ namespace chira {
 
 class IMaterial : public Resource {
 public:
-    explicit IMaterial(std::string identifier_);
+    explicit IMaterial(ResourceID identifier_);
     void compile(const byte buffer[], std::size_t bufferLength) override;
     virtual void use() const;
     [[nodiscard]] SharedPointer<Shader> getShader() const;
@@ -34,6 +34,7 @@ using MaterialFactory = AbstractFactory<SharedPointer<IMaterial>>;
 } // namespace chira
 
 #define CHIRA_REGISTER_MATERIAL_TYPE(ResourceClassName)                                      \
+    CHIRA_REGISTER_RESOURCE_TYPE(ResourceClassName);                                         \
     static inline const bool ResourceClassName##FactoryRegistryHelper =                      \
         chira::MaterialFactory::registerTypeFactory(                                         \
             #ResourceClassName,                                                              \
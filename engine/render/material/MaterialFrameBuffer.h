@@ -8,8 +8,8 @@ class Frame;
 
 class MaterialFrameBuffer final : public IMaterial {
 public:
-    MaterialFrameBuffer(std::string identifier_, Renderer::FrameBufferHandle* handle_)
-        : IMaterial(std::move(identifier_))
+    MaterialFrameBuffer(ResourceID identifier_, Renderer::FrameBufferHandle* handle_)
+        : IMaterial(identifier_)
         , handle(handle_) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
     void use() const override;
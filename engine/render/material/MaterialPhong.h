@@ -7,7 +7,7 @@ namespace chira {
 
 class MaterialPhong final : public IMaterial {
 public:
-    explicit MaterialPhong(std::string identifier_) : IMaterial(std::move(identifier_)) {}
+    explicit MaterialPhong(ResourceID identifier_) : IMaterial(identifier_) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
     void use() const override;
     [[nodiscard]] SharedPointer<Texture> getTextureDiffuse() const;
@@ -6,7 +6,7 @@ namespace chira {
 
 class MaterialUntextured final : public IMaterial {
 public:
-    explicit MaterialUntextured(std::string identifier_) : IMaterial(std::move(identifier_)) {}
+    explicit MaterialUntextured(ResourceID identifier_) : IMaterial(identifier_) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
 
 public:
@@ -7,18 +7,101 @@
 
 using namespace chira;
 
+[[maybe_unused]]
+ConVar r_lod_threshold{"r_lod_threshold", 1.0, "How many pixels a mesh LOD's error can cover before a more detailed LOD is drawn.", CON_FLAG_CACHE};
+
+[[maybe_unused]]
+ConVar r_lod_bias{"r_lod_bias", 0, "Added to the LOD picked for each mesh. Negative values draw more detail, positive values less.", CON_FLAG_CACHE};
+
+[[maybe_unused]]
+ConVar r_quantize_vertices{"r_quantize_vertices", true, "Upload mesh normals, colors and UVs as small integers or half floats instead of floats.", CON_FLAG_CACHE};
+
 void MeshData::setupForRendering() {
-    this->handle = Renderer::createMesh(this->vertices, this->indices, MeshDrawMode::STATIC);
+    this->uploadedLayout = this->getUploadLayout();
+    this->handle = this->lods.empty()
+            ? Renderer::createMesh(this->vertices, this->indices, this->uploadedLayout, this->drawMode)
+            : Renderer::createMesh(this->vertices, this->getIndicesWithLODs(), this->uploadedLayout, this->drawMode);
+    this->updateUploadedLODs();
     this->initialized = true;
+    this->onMemoryUsageChanged();
+}
+
+void MeshData::queueSetupForRendering(bool releaseCPUCopyAfter /*= false*/) {
+    this->uploadTicket = UploadQueue::enqueue(this->getUploadSize(this->getUploadLayout()), [this, releaseCPUCopyAfter] {
+        this->uploadTicket = 0;
+        this->setupForRendering();
+        if (releaseCPUCopyAfter)
+            this->releaseCPUCopy();
+    });
 }
 
 void MeshData::updateMeshData() {
     if (!this->initialized)
         return;
-    Renderer::updateMesh(&this->handle, this->vertices, this->indices, this->drawMode);
+    // Updating means the vertices changed
+    this->fittedLayout.reset();
+    this->uploadedLayout = this->getUploadLayout();
+    if (this->drawMode == MeshDrawMode::DYNAMIC) {
+        // LOD indices come after the full detail ones, so adding indices moves them
+        if (this->lods.empty())
+            Renderer::streamMesh(&this->handle, this->vertices, this->indices, this->unchangedVertexCount, this->unchangedIndexCount, this->uploadedLayout);
+        else
+            Renderer::streamMesh(&this->handle, this->vertices, this->getIndicesWithLODs(), this->unchangedVertexCount, 0, this->uploadedLayout);
+    } else if (this->lods.empty()) {
+        Renderer::updateMesh(&this->handle, this->vertices, this->indices, this->uploadedLayout, this->drawMode);
+    } else {
+        Renderer::updateMesh(&this->handle, this->vertices, this->getIndicesWithLODs(), this->uploadedLayout, this->drawMode);
+    }
+    this->updateUploadedLODs();
+    this->onMemoryUsageChanged();
+}
+
+VertexLayout MeshData::getUploadLayout() {
+    if (this->vertexLayout)
+        return *this->vertexLayout;
+    if (!this->fittedLayout)
+        this->fittedLayout = VertexLayout::fit(this->vertices, r_quantize_vertices.getValue<bool>());
+    return *this->fittedLayout;
+}
+
+std::size_t MeshData::getUploadSize(const VertexLayout& layout) const {
+    auto indexCount = this->indices.size();
+    for (const auto& lod : this->lods) {
+        indexCount += lod.indices.size();
+    }
+    return this->vertices.size() * layout.getStride() + indexCount * getIndexSize(this->vertices.size());
+}
+
+std::vector<Index> MeshData::getIndicesWithLODs() const {
+    auto size = this->indices.size();
+    for (const auto& lod : this->lods) {
+        size += lod.indices.size();
+    }
+    std::vector<Index> combined;
+    combined.reserve(size);
+    combined.insert(combined.end(), this->indices.begin(), this->indices.end());
+    for (const auto& lod : this->lods) {
+        combined.insert(combined.end(), lod.indices.begin(), lod.indices.end());
+    }
+    return combined;
 }
 
-void MeshData::render(glm::mat4 model, MeshCullType cullType /*= MeshCullType::BACK*/) {
+void MeshData::updateUploadedLODs() {
+    this->uploadedLODs.clear();
+    this->uploadedLODs.emplace_back(0, static_cast<int>(this->indices.size()));
+    auto indexCount = this->indices.size();
+    for (const auto& lod : this->lods) {
+        this->uploadedLODs.emplace_back(static_cast<int>(indexCount), static_cast<int>(lod.indices.size()));
+        indexCount += lod.indices.size();
+    }
+    this->uploadedSize = this->getUploadSize(this->uploadedLayout);
+    this->unchangedVertexCount = this->vertices.size();
+    this->unchangedIndexCount = this->indices.size();
+}
+
+void MeshData::render(glm::mat4 model, MeshCullType cullType /*= MeshCullType::BACK*/, std::size_t lod /*= 0*/) {
+    if (this->uploadTicket)
+        return;
     if (!this->initialized)
         this->setupForRendering();
     if (this->material) {
@@ -26,10 +109,22 @@ void MeshData::render(glm::mat4 model, MeshCullType cullType /*= MeshCullType::B
         if (this->material->getShader()->usesModelMatrix())
             this->material->getShader()->setUniform("m", model);
     }
-    Renderer::drawMesh(this->handle, this->depthFunction, cullType);
+    const auto& [firstIndex, indexCount] = this->uploadedLODs[std::min(lod, this->uploadedLODs.size() - 1)];
+    Renderer::drawMesh(this->handle, this->depthFunction, cullType, firstIndex, indexCount);
+}
+
+std::size_t MeshData::selectLOD(float pixelsPerUnit) const {
+    const auto threshold = r_lod_threshold.getValue<float>();
+    std::size_t lod = 0;
+    while (lod < this->lods.size() && this->lods[lod].error * pixelsPerUnit < threshold) {
+        lod++;
+    }
+    const auto biased = static_cast<int>(lod) + r_lod_bias.getValue<int>();
+    return static_cast<std::size_t>(std::clamp(biased, 0, static_cast<int>(this->lods.size())));
 }
 
 MeshData::~MeshData() {
+    UploadQueue::cancel(this->uploadTicket);
     if (this->initialized) {
         Renderer::destroyMesh(this->handle);
     }
@@ -51,15 +146,64 @@ void MeshData::setDepthFunction(MeshDepthFunction function) {
     this->depthFunction = function;
 }
 
+void MeshData::setVertexLayout(std::optional<VertexLayout> layout) {
+    this->vertexLayout = layout;
+}
+
 std::vector<byte> MeshData::getMeshData(const std::string& meshLoader) const {
-    return IMeshLoader::getMeshLoader(meshLoader)->createMesh(this->vertices, this->indices);
+    if (this->cpuCopyReleased) {
+        std::vector<Vertex> reloadedVertices;
+        std::vector<Index> reloadedIndices;
+        std::vector<MeshLOD> reloadedLODs;
+        if (this->reloadCPUCopy(reloadedVertices, reloadedIndices, reloadedLODs))
+            return IMeshLoader::getMeshLoader(meshLoader)->createMeshWithLODs(reloadedVertices, reloadedIndices, reloadedLODs);
+    }
+    return IMeshLoader::getMeshLoader(meshLoader)->createMeshWithLODs(this->vertices, this->indices, this->lods);
 }
 
 void MeshData::appendMeshData(const std::string& loader, const std::string& identifier) {
-    IMeshLoader::getMeshLoader(loader)->loadMesh(identifier, this->vertices, this->indices);
+    // Appending to nothing would drop what was uploaded the next time the mesh is updated
+    if (this->cpuCopyReleased) {
+        this->lods.clear();
+        if (this->reloadCPUCopy(this->vertices, this->indices, this->lods))
+            this->cpuCopyReleased = false;
+    }
+    // LODs of what was already here wouldn't cover what's being added, so only a mesh loaded on its own has them
+    const bool loadLODs = this->indices.empty();
+    this->lods.clear();
+    this->fittedLayout.reset();
+    Bounds loadedBounds;
+    if (loadLODs) {
+        IMeshLoader::getMeshLoader(loader)->loadMeshWithLODs(identifier, this->vertices, this->indices, this->lods, loadedBounds);
+    } else {
+        const auto firstVertex = this->vertices.size();
+        IMeshLoader::getMeshLoader(loader)->loadMesh(identifier, this->vertices, this->indices);
+        loadedBounds = Bounds::fromVertices(this->vertices.data() + firstVertex, this->vertices.size() - firstVertex);
+    }
+    this->bounds.merge(loadedBounds);
 }
 
 void MeshData::clearMeshData() {
     this->vertices.clear();
     this->indices.clear();
+    this->lods.clear();
+    this->fittedLayout.reset();
+    this->bounds = {};
+    this->unchangedVertexCount = 0;
+    this->unchangedIndexCount = 0;
+}
+
+bool MeshData::releaseCPUCopy() {
+    // Dynamic meshes are edited after they're uploaded, and the rest would have nothing to edit or save
+    if (!this->initialized || this->drawMode == MeshDrawMode::DYNAMIC || !this->canReloadCPUCopy())
+        return false;
+    // clear() keeps the capacity around
+    std::vector<Vertex>{}.swap(this->vertices);
+    std::vector<Index>{}.swap(this->indices);
+    for (auto& lod : this->lods) {
+        std::vector<Index>{}.swap(lod.indices);
+    }
+    this->cpuCopyReleased = true;
+    this->onMemoryUsageChanged();
+    return true;
 }
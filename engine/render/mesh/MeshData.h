@@ -1,9 +1,14 @@
 #pragma once
 
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 #include <loader/mesh/IMeshLoader.h>
+#include <math/Bounds.h>
 #include <render/backend/RenderTypes.h>
+#include <render/backend/UploadQueue.h>
+#include <render/backend/VertexLayout.h>
 #include <render/material/MaterialFactory.h>
 
 namespace chira {
@@ -11,28 +16,94 @@ namespace chira {
 class MeshData {
 public:
     MeshData() = default;
-    void render(glm::mat4 model, MeshCullType cullType = MeshCullType::BACK);
+    /// Draws nothing while the mesh is queued for upload. LOD 0 is the full detail mesh.
+    void render(glm::mat4 model, MeshCullType cullType = MeshCullType::BACK, std::size_t lod = 0);
     virtual ~MeshData();
     [[nodiscard]] SharedPointer<IMaterial> getMaterial() const;
     void setMaterial(SharedPointer<IMaterial> newMaterial);
     [[nodiscard]] MeshDepthFunction getDepthFunction() const;
     void setDepthFunction(MeshDepthFunction function);
+    /// Meshes fit their layout to their vertices when they're uploaded, unless one is set here. Pass nothing to fit it again.
+    /// Takes effect the next time the mesh is uploaded.
+    void setVertexLayout(std::optional<VertexLayout> layout);
+    /// The layout the vertices were last uploaded in.
+    [[nodiscard]] VertexLayout getVertexLayout() const {
+        return this->uploadedLayout;
+    }
+    /// Reads the mesh again if its CPU copy was released.
     [[nodiscard]] std::vector<byte> getMeshData(const std::string& meshLoader) const;
     void appendMeshData(const std::string& loader, const std::string& identifier);
+    /// True if the vertices and indices were freed after they were uploaded.
+    [[nodiscard]] bool isCPUCopyReleased() const {
+        return this->cpuCopyReleased;
+    }
+    /// Includes the full detail mesh.
+    [[nodiscard]] std::size_t getLODCount() const {
+        return this->lods.size() + 1;
+    }
+    /// Computed when the mesh is loaded, or when a MeshDataBuilder is updated. Kept when the CPU copy is released.
+    [[nodiscard]] const Bounds& getBounds() const {
+        return this->bounds;
+    }
+    /// Picks the least detailed LOD whose error covers fewer pixels than r_lod_threshold, then adds r_lod_bias.
+    /// pixelsPerUnit is how many pixels one unit of the mesh covers where it's drawn.
+    [[nodiscard]] std::size_t selectLOD(float pixelsPerUnit) const;
 protected:
     bool initialized = false;
+    bool cpuCopyReleased = false;
+    UploadQueue::Ticket uploadTicket = 0;
+    /// The size of the mesh data when it was last uploaded.
+    std::size_t uploadedSize = 0;
     Renderer::MeshHandle handle{};
+    std::optional<VertexLayout> vertexLayout;
+    VertexLayout uploadedLayout{};
     MeshDrawMode drawMode = MeshDrawMode::STATIC;
     MeshDepthFunction depthFunction = MeshDepthFunction::LEQUAL;
     SharedPointer<IMaterial> material;
     std::vector<Vertex> vertices;
     std::vector<Index> indices;
+    /// How many vertices and indices at the start are unchanged since they were uploaded. Dynamic meshes only write what
+    /// comes after. Anything that changes vertices or indices in place must lower these.
+    std::size_t unchangedVertexCount = 0;
+    std::size_t unchangedIndexCount = 0;
+    Bounds bounds;
+    /// From most to least detailed, not counting the full detail mesh. Their errors stay when the CPU copy is released.
+    std::vector<MeshLOD> lods;
+    /// Where each LOD's indices start in the uploaded index buffer, and how many there are, including the full detail mesh.
+    std::vector<std::pair<int, int>> uploadedLODs;
     /// Establishes the vertex buffers and copies the current mesh data into them.
     void setupForRendering();
-    /// Updates the vertex buffers with the current mesh data.
+    /// Calls setupForRendering() from the upload queue, then releases the CPU copy if asked to.
+    void queueSetupForRendering(bool releaseCPUCopyAfter = false);
+    /// Updates the vertex buffers with the current mesh data. Dynamic meshes are streamed, see Renderer::streamMesh().
     void updateMeshData();
     /// Does not call updateMeshData().
     void clearMeshData();
+    /// Frees the vertices and indices once they are uploaded. Only do this for meshes that are never edited again.
+    /// Dynamic meshes and meshes that can't be read again keep them. Returns true if they were freed.
+    bool releaseCPUCopy();
+    /// True if reloadCPUCopy() can read the mesh data again.
+    [[nodiscard]] virtual bool canReloadCPUCopy() const {
+        return false;
+    }
+    /// Reads the mesh data from where it came from after the CPU copy was released.
+    /// Meshes built in code can't be read again, and return false.
+    virtual bool reloadCPUCopy(std::vector<Vertex>& vertices_, std::vector<Index>& indices_, std::vector<MeshLOD>& lods_) const {
+        return false;
+    }
+    /// Records where each LOD was uploaded and how big the upload was.
+    void updateUploadedLODs();
+    /// Called after the mesh is uploaded or updated, or its CPU copy is freed.
+    virtual void onMemoryUsageChanged() {}
+private:
+    /// The smallest layout that holds the vertices, kept until they change so queueing and uploading fit them once.
+    std::optional<VertexLayout> fittedLayout;
+    /// The set layout, or the smallest one that holds the vertices.
+    [[nodiscard]] VertexLayout getUploadLayout();
+    /// How many bytes uploading the mesh in the given layout takes.
+    [[nodiscard]] std::size_t getUploadSize(const VertexLayout& layout) const;
+    /// The full detail indices followed by each LOD's, which is how they're uploaded.
+    [[nodiscard]] std::vector<Index> getIndicesWithLODs() const;
 };
 
 } // namespace chira
@@ -1,25 +1,20 @@
 #include "MeshDataBuilder.h"
 
-#include <algorithm>
-
 using namespace chira;
 
 MeshDataBuilder::MeshDataBuilder() : MeshData() {
     this->drawMode = MeshDrawMode::DYNAMIC;
+    // Fitting the layout would mean reading every vertex on each update, and a new layout means writing all of them again
+    this->vertexLayout = VertexLayout{};
 }
 
-void MeshDataBuilder::addVertex(Vertex vertex, bool addDuplicate) { // NOLINT(misc-no-recursion)
+void MeshDataBuilder::addVertex(Vertex vertex, bool addDuplicate) {
     if (addDuplicate) {
         this->vertices.push_back(vertex);
-        this->indices.push_back(this->currentIndex);
-        this->currentIndex += 1;
+        this->indices.push_back(static_cast<Index>(this->vertices.size() - 1));
         return;
     }
-    if (auto position = std::find(this->vertices.begin(), this->vertices.end(), vertex); position != this->vertices.end()) {
-        this->indices.push_back(static_cast<Index>(position - this->vertices.begin()));
-    } else {
-        this->addVertex(vertex, true);
-    }
+    this->indices.push_back(this->welder.weld(this->vertices, vertex));
 }
 
 void MeshDataBuilder::addTriangle(Vertex v1, Vertex v2, Vertex v3, bool addDuplicate) {
@@ -194,12 +189,32 @@ void MeshDataBuilder::addCube(Vertex center, glm::vec3 size, bool visibleOutside
     }
 }
 
+void MeshDataBuilder::reserve(std::size_t vertexCount) {
+    this->vertices.reserve(vertexCount);
+    this->indices.reserve(vertexCount);
+    this->welder.reserve(vertexCount);
+}
+
+void MeshDataBuilder::updateBounds() {
+    // Vertices are only ever added, so the bounds only need to grow to hold the new ones. This is tracked apart from
+    // what was uploaded, because render() can upload the mesh before update() is ever called
+    if (this->bounds.isEmpty())
+        this->bounds = Bounds::fromVertices(this->vertices);
+    else
+        this->bounds.extend(this->vertices.data() + this->boundedVertexCount, this->vertices.size() - this->boundedVertexCount);
+    this->boundedVertexCount = this->vertices.size();
+}
+
 void MeshDataBuilder::update() {
+    this->updateBounds();
     if (!this->initialized)
         this->setupForRendering();
-    this->updateMeshData();
+    else
+        this->updateMeshData();
 }
 
 void MeshDataBuilder::clear() {
     this->clearMeshData();
+    this->welder.clear();
+    this->boundedVertexCount = 0;
 }
@@ -2,6 +2,7 @@
 
 #include <render/mesh/MeshData.h>
 #include <math/Axis.h>
+#include <math/VertexWelder.h>
 
 namespace chira {
 
@@ -14,15 +15,21 @@ public:
     void addSquare(Vertex v1, Vertex v2, Vertex v3, Vertex v4, bool addDuplicate = false);
     void addSquare(Vertex center, glm::vec2 size, SignedAxis normal, float offset = 0, bool addDuplicate = false);
     void addCube(Vertex center, glm::vec3 size, bool visibleOutside = true, bool addDuplicate = false);
+    /// Makes room for the given number of vertices, so building large meshes doesn't keep growing the vertex lookup.
+    void reserve(std::size_t vertexCount);
     void update();
     /// Does not call update().
     void clear();
 
 protected:
-    Index currentIndex = 0;
-    /// Pass true to addDuplicate if you don't want to scan the entire vertex vector to calculate the index.
+    VertexWelder welder;
+    /// How many vertices at the start are already inside the bounds.
+    std::size_t boundedVertexCount = 0;
+    /// Pass true to addDuplicate if you don't want to look up the vertex to calculate the index.
     /// This will make a duplicate vertex if one already exists.
     void addVertex(Vertex vertex, bool addDuplicate = false);
+    /// Grows the bounds to hold the vertices added since the last time they were updated.
+    void updateBounds();
 };
 
 } // namespace chira
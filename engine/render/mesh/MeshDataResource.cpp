@@ -16,5 +16,24 @@ void MeshDataResource::compile(const byte buffer[], std::size_t bufferLength) {
         this->material = CHIRA_GET_MATERIAL(this->materialType, this->materialPath);
     }
     this->appendMeshData(this->modelLoader, this->modelPath);
-    this->setupForRendering();
+    this->queueSetupForRendering(!this->keepCPUCopy || !Resource::shouldKeepCPUCopies());
+}
+
+std::size_t MeshDataResource::getCPUMemoryUsage() const {
+    auto size = this->vertices.size() * sizeof(Vertex) + this->indices.size() * sizeof(Index);
+    for (const auto& lod : this->lods) {
+        size += lod.indices.size() * sizeof(Index);
+    }
+    return size;
+}
+
+std::size_t MeshDataResource::getGPUMemoryUsage() const {
+    return this->initialized ? this->uploadedSize : 0;
+}
+
+bool MeshDataResource::reloadCPUCopy(std::vector<Vertex>& vertices_, std::vector<Index>& indices_, std::vector<MeshLOD>& lods_) const {
+    // The bounds were kept when the CPU copy was released
+    Bounds reloadedBounds;
+    IMeshLoader::getMeshLoader(this->modelLoader)->loadMeshWithLODs(this->modelPath, vertices_, indices_, lods_, reloadedBounds);
+    return true;
 }
@@ -9,10 +9,28 @@ namespace chira {
 
 class MeshDataResource : public Resource, public MeshData {
 public:
-    explicit MeshDataResource(std::string identifier_) : Resource(std::move(identifier_)), MeshData() {}
+    /// If keepCPUCopy_ is false, or res_keep_cpu_copies is off, the vertices and indices are freed once they are uploaded.
+    explicit MeshDataResource(ResourceID identifier_, bool keepCPUCopy_ = true)
+            : Resource(identifier_)
+            , MeshData()
+            , keepCPUCopy(keepCPUCopy_) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
+    [[nodiscard]] std::size_t getCPUMemoryUsage() const override;
+    /// How big the mesh was when it was uploaded, in its vertex layout.
+    [[nodiscard]] std::size_t getGPUMemoryUsage() const override;
+
+protected:
+    [[nodiscard]] bool canReloadCPUCopy() const override {
+        return true;
+    }
+    /// Reads the model file again.
+    bool reloadCPUCopy(std::vector<Vertex>& vertices_, std::vector<Index>& indices_, std::vector<MeshLOD>& lods_) const override;
+    void onMemoryUsageChanged() override {
+        this->updateCachedMemoryUsage();
+    }
 
 private:
+    bool keepCPUCopy;
     bool materialSetInCode = false;
     std::string materialType{"MaterialTextured"};
     std::string materialPath{"file://materials/unlitTextured.json"};
@@ -34,6 +52,7 @@ public:
 
 private:
     CHIRA_REGISTER_DEFAULT_RESOURCE(MeshDataResource, "file://meshes/missing.json");
+    CHIRA_REGISTER_RESOURCE_TYPE(MeshDataResource);
 };
 
 } // namespace chira
@@ -0,0 +1,361 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+using namespace chira;
+
+namespace {
+
+/// A FIFO cache that only tracks when each vertex was last added, which is all that's needed to tell if it's still in.
+class VertexCacheSimulator {
+public:
+    VertexCacheSimulator(std::size_t vertexCount, unsigned int cacheSize_)
+            : cacheTime(vertexCount, 0)
+            , cacheSize(cacheSize_)
+            , time(cacheSize_ + 1) {}
+
+    /// Returns true if the vertex was not in the cache, and adds it.
+    bool miss(Index vertex) {
+        if (this->time - this->cacheTime[vertex] <= this->cacheSize)
+            return false;
+        this->cacheTime[vertex] = this->time++;
+        return true;
+    }
+
+    /// How long ago the vertex was added, in cache insertions.
+    [[nodiscard]] std::uint32_t getAge(Index vertex) const {
+        return this->time - this->cacheTime[vertex];
+    }
+
+    void clear() {
+        this->time += this->cacheSize + 1;
+    }
+
+private:
+    std::vector<std::uint32_t> cacheTime;
+    std::uint32_t cacheSize;
+    std::uint32_t time;
+};
+
+/// Picks the view with the axis and side given by view / 2 and view % 2, keeping the view right-handed so winding
+/// still tells front faces from back faces. Smaller depths are closer.
+[[nodiscard]] glm::vec3 projectForView(const glm::vec3& position, int view) {
+    switch (view) {
+        case 0: return {-position.z, position.y, -position.x};
+        case 1: return { position.z, position.y,  position.x};
+        case 2: return { position.x, -position.z, -position.y};
+        case 3: return { position.x, position.z,  position.y};
+        case 4: return { position.x, position.y, -position.z};
+        default: return {-position.x, position.y,  position.z};
+    }
+}
+
+[[nodiscard]] float edgeFunction(const glm::vec3& a, const glm::vec3& b, float x, float y) {
+    return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+constexpr int OVERDRAW_RESOLUTION = 256;
+
+/// Draws a counter-clockwise triangle with a depth test, and returns how many pixels passed it.
+std::uint64_t rasterizeTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, std::vector<float>& depthBuffer) {
+    const float area = edgeFunction(a, b, c.x, c.y);
+    if (area <= 0.f)
+        return 0;
+    const int minX = std::max(static_cast<int>(std::floor(std::min({a.x, b.x, c.x}))), 0);
+    const int minY = std::max(static_cast<int>(std::floor(std::min({a.y, b.y, c.y}))), 0);
+    const int maxX = std::min(static_cast<int>(std::ceil(std::max({a.x, b.x, c.x}))), OVERDRAW_RESOLUTION - 1);
+    const int maxY = std::min(static_cast<int>(std::ceil(std::max({a.y, b.y, c.y}))), OVERDRAW_RESOLUTION - 1);
+
+    std::uint64_t shaded = 0;
+    for (int y = minY; y <= maxY; y++) {
+        for (int x = minX; x <= maxX; x++) {
+            const float px = static_cast<float>(x) + 0.5f, py = static_cast<float>(y) + 0.5f;
+            const float wa = edgeFunction(b, c, px, py);
+            const float wb = edgeFunction(c, a, px, py);
+            const float wc = edgeFunction(a, b, px, py);
+            if (wa < 0.f || wb < 0.f || wc < 0.f)
+                continue;
+            const float depth = (wa * a.z + wb * b.z + wc * c.z) / area;
+            if (auto& pixel = depthBuffer[y * OVERDRAW_RESOLUTION + x]; depth < pixel) {
+                pixel = depth;
+                shaded++;
+            }
+        }
+    }
+    return shaded;
+}
+
+} // namespace
+
+MeshOptimizer::VertexCacheStatistics MeshOptimizer::analyzeVertexCache(const std::vector<Index>& indices, std::size_t vertexCount, unsigned int cacheSize) {
+    VertexCacheSimulator cache{vertexCount, cacheSize};
+    std::vector<bool> used(vertexCount, false);
+    std::size_t misses = 0, usedCount = 0;
+    for (const auto index : indices) {
+        if (index >= vertexCount)
+            continue;
+        if (cache.miss(index))
+            misses++;
+        if (!used[index]) {
+            used[index] = true;
+            usedCount++;
+        }
+    }
+
+    VertexCacheStatistics statistics;
+    if (indices.size() >= 3)
+        statistics.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    if (usedCount > 0)
+        statistics.atvr = static_cast<float>(misses) / static_cast<float>(usedCount);
+    return statistics;
+}
+
+float MeshOptimizer::analyzeOverdraw(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) {
+    std::vector<float> depthBuffer(OVERDRAW_RESOLUTION * OVERDRAW_RESOLUTION);
+    std::vector<glm::vec3> projected(vertices.size());
+    std::uint64_t shaded = 0, covered = 0;
+
+    for (int view = 0; view < 6; view++) {
+        glm::vec3 min{std::numeric_limits<float>::max()}, max{std::numeric_limits<float>::lowest()};
+        for (std::size_t i = 0; i < vertices.size(); i++) {
+            projected[i] = projectForView(vertices[i].position, view);
+            min = glm::min(min, projected[i]);
+            max = glm::max(max, projected[i]);
+        }
+        const float extent = std::max(max.x - min.x, max.y - min.y);
+        if (vertices.empty() || extent <= 0.f)
+            continue;
+        // Keep the aspect ratio so triangles don't get stretched
+        const float scale = static_cast<float>(OVERDRAW_RESOLUTION - 1) / extent;
+        for (auto& position : projected) {
+            position.x = (position.x - min.x) * scale;
+            position.y = (position.y - min.y) * scale;
+        }
+
+        std::fill(depthBuffer.begin(), depthBuffer.end(), std::numeric_limits<float>::max());
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+            shaded += rasterizeTriangle(projected[indices[i]], projected[indices[i + 1]], projected[indices[i + 2]], depthBuffer);
+        }
+        covered += std::count_if(depthBuffer.begin(), depthBuffer.end(), [](float depth) {
+            return depth != std::numeric_limits<float>::max();
+        });
+    }
+    return covered > 0 ? static_cast<float>(shaded) / static_cast<float>(covered) : 0.f;
+}
+
+std::vector<std::size_t> MeshOptimizer::optimizeVertexCache(std::vector<Index>& indices, std::size_t vertexCount, unsigned int cacheSize) {
+    const std::size_t triangleCount = indices.size() / 3;
+    std::vector<std::size_t> clusters;
+    if (triangleCount == 0)
+        return clusters;
+
+    // The triangles using each vertex, and how many of them are left to draw
+    std::vector<std::uint32_t> liveTriangles(vertexCount, 0);
+    for (std::size_t i = 0; i < triangleCount * 3; i++) {
+        liveTriangles[indices[i]]++;
+    }
+    std::vector<std::uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    std::inclusive_scan(liveTriangles.begin(), liveTriangles.end(), adjacencyOffsets.begin() + 1);
+    std::vector<std::uint32_t> adjacency(triangleCount * 3);
+    {
+        auto cursors = adjacencyOffsets;
+        for (std::size_t i = 0; i < triangleCount * 3; i++) {
+            adjacency[cursors[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+        }
+    }
+
+    VertexCacheSimulator cache{vertexCount, cacheSize};
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<Index> deadEnd;
+    std::vector<Index> candidates;
+    std::vector<Index> output;
+    output.reserve(indices.size());
+    Index vertexCursor = 0;
+
+    // Vertices that were just used but still have triangles left, in case the fan runs out of good candidates
+    const auto skipDeadEnd = [&]() -> std::int64_t {
+        while (!deadEnd.empty()) {
+            const auto vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[vertex] > 0)
+                return vertex;
+        }
+        for (; vertexCursor < vertexCount; vertexCursor++) {
+            if (liveTriangles[vertexCursor] > 0)
+                return vertexCursor;
+        }
+        return -1;
+    };
+
+    std::int64_t fan = indices[0];
+    bool hardBoundary = true;
+    while (fan >= 0) {
+        candidates.clear();
+        for (auto i = adjacencyOffsets[fan]; i < adjacencyOffsets[fan + 1]; i++) {
+            const auto triangle = adjacency[i];
+            if (emitted[triangle])
+                continue;
+            if (hardBoundary) {
+                clusters.push_back(output.size() / 3);
+                hardBoundary = false;
+            }
+            for (std::size_t corner = 0; corner < 3; corner++) {
+                const auto vertex = indices[triangle * 3 + corner];
+                output.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                cache.miss(vertex);
+            }
+            emitted[triangle] = true;
+        }
+
+        // Fan around whichever vertex will still be in the cache once its triangles are drawn, oldest first
+        fan = -1;
+        std::int64_t bestPriority = -1;
+        for (const auto vertex : candidates) {
+            if (liveTriangles[vertex] == 0)
+                continue;
+            std::int64_t priority = 0;
+            if (cache.getAge(vertex) + 2 * liveTriangles[vertex] <= cacheSize)
+                priority = cache.getAge(vertex);
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fan = vertex;
+            }
+        }
+        if (fan < 0) {
+            fan = skipDeadEnd();
+            hardBoundary = true;
+        }
+    }
+
+    // Keep a broken last triangle if there is one, it's not this function's business
+    output.insert(output.end(), indices.begin() + static_cast<std::ptrdiff_t>(triangleCount * 3), indices.end());
+    indices.swap(output);
+    return clusters;
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<Index>& indices, const std::vector<Vertex>& vertices, const std::vector<std::size_t>& clusters,
+                                     unsigned int cacheSize, float threshold) {
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+    std::vector<std::size_t> hardClusters = clusters;
+    if (hardClusters.empty() || hardClusters[0] != 0)
+        hardClusters.insert(hardClusters.begin(), 0);
+
+    // Split each cluster wherever the part so far is already about as cache efficient as the whole cluster
+    VertexCacheSimulator cache{vertices.size(), cacheSize};
+    std::vector<std::size_t> softClusters;
+    for (std::size_t cluster = 0; cluster < hardClusters.size(); cluster++) {
+        const auto begin = hardClusters[cluster];
+        const auto end = cluster + 1 < hardClusters.size() ? hardClusters[cluster + 1] : triangleCount;
+        if (begin >= end)
+            continue;
+
+        cache.clear();
+        std::size_t misses = 0;
+        for (auto i = begin * 3; i < end * 3; i++) {
+            misses += cache.miss(indices[i]);
+        }
+        const float maxACMR = threshold * static_cast<float>(misses) / static_cast<float>(end - begin);
+
+        cache.clear();
+        std::size_t start = begin;
+        misses = 0;
+        for (auto triangle = begin; triangle < end; triangle++) {
+            for (std::size_t corner = 0; corner < 3; corner++) {
+                misses += cache.miss(indices[triangle * 3 + corner]);
+            }
+            if (triangle + 1 < end && static_cast<float>(misses) <= maxACMR * static_cast<float>(triangle + 1 - start)) {
+                softClusters.push_back(start);
+                start = triangle + 1;
+                misses = 0;
+                cache.clear();
+            }
+        }
+        softClusters.push_back(start);
+    }
+
+    // Draw the clusters facing away from the middle of the mesh first, since those are the ones most likely to be in front
+    const auto getTriangle = [&](std::size_t triangle) {
+        return std::array<glm::vec3, 3>{
+                vertices[indices[triangle * 3]].position,
+                vertices[indices[triangle * 3 + 1]].position,
+                vertices[indices[triangle * 3 + 2]].position,
+        };
+    };
+    glm::vec3 meshCentroid{0.f};
+    float meshArea = 0.f;
+    for (std::size_t triangle = 0; triangle < triangleCount; triangle++) {
+        const auto [a, b, c] = getTriangle(triangle);
+        const float area = glm::length(glm::cross(b - a, c - a));
+        meshCentroid += (a + b + c) * (area / 3.f);
+        meshArea += area;
+    }
+    if (meshArea > 0.f)
+        meshCentroid /= meshArea;
+
+    std::vector<float> sortKeys(softClusters.size());
+    for (std::size_t cluster = 0; cluster < softClusters.size(); cluster++) {
+        const auto end = cluster + 1 < softClusters.size() ? softClusters[cluster + 1] : triangleCount;
+        glm::vec3 centroid{0.f}, normal{0.f};
+        float clusterArea = 0.f;
+        for (auto triangle = softClusters[cluster]; triangle < end; triangle++) {
+            const auto [a, b, c] = getTriangle(triangle);
+            // The cross product's length is twice the area, so this weights the normals by area too
+            const auto faceNormal = glm::cross(b - a, c - a);
+            const float area = glm::length(faceNormal);
+            centroid += (a + b + c) * (area / 3.f);
+            normal += faceNormal;
+            clusterArea += area;
+        }
+        if (clusterArea > 0.f)
+            centroid /= clusterArea;
+        const float normalLength = glm::length(normal);
+        sortKeys[cluster] = normalLength > 0.f ? glm::dot(centroid - meshCentroid, normal / normalLength) : 0.f;
+    }
+
+    std::vector<std::size_t> order(softClusters.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](std::size_t lhs, std::size_t rhs) {
+        return sortKeys[lhs] > sortKeys[rhs];
+    });
+
+    std::vector<Index> output;
+    output.reserve(indices.size());
+    for (const auto cluster : order) {
+        const auto end = cluster + 1 < softClusters.size() ? softClusters[cluster + 1] : triangleCount;
+        output.insert(output.end(), indices.begin() + static_cast<std::ptrdiff_t>(softClusters[cluster] * 3), indices.begin() + static_cast<std::ptrdiff_t>(end * 3));
+    }
+    output.insert(output.end(), indices.begin() + static_cast<std::ptrdiff_t>(triangleCount * 3), indices.end());
+    indices.swap(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<Index>& indices) {
+    constexpr auto UNUSED = std::numeric_limits<Index>::max();
+    std::vector<Index> remap(vertices.size(), UNUSED);
+    std::vector<Vertex> output;
+    output.reserve(vertices.size());
+    for (auto& index : indices) {
+        if (remap[index] == UNUSED) {
+            remap[index] = static_cast<Index>(output.size());
+            output.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(output);
+}
+
+void MeshOptimizer::optimize(std::vector<Vertex>& vertices, std::vector<Index>& indices, unsigned int cacheSize, float overdrawThreshold) {
+    const auto clusters = MeshOptimizer::optimizeVertexCache(indices, vertices.size(), cacheSize);
+    MeshOptimizer::optimizeOverdraw(indices, vertices, clusters, cacheSize, overdrawThreshold);
+    // Has to come last, it renumbers the vertices the other passes look at
+    MeshOptimizer::optimizeVertexFetch(vertices, indices);
+}
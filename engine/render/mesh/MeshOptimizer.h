@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <math/Vertex.h>
+
+/// Reorders meshes so the GPU does less work drawing them. None of this changes what the mesh looks like.
+namespace chira::MeshOptimizer {
+
+/// The FIFO post-transform cache size that's optimized for, which is on the small side for current hardware.
+constexpr unsigned int DEFAULT_CACHE_SIZE = 16;
+/// How much worse the vertex cache is allowed to get to let the overdraw optimization split the mesh up more.
+constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+struct VertexCacheStatistics {
+    /// Average cache misses per triangle, from 0.5 in the best case up to 3.
+    float acmr = 0.f;
+    /// Average transforms per vertex, 1 is perfect.
+    float atvr = 0.f;
+};
+
+/// Simulates a FIFO cache of the given size over the indices.
+[[nodiscard]] VertexCacheStatistics analyzeVertexCache(const std::vector<Index>& indices, std::size_t vertexCount, unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+
+/// Rasterizes the mesh from both sides of each axis with back-face culling and early depth testing, and returns how many
+/// times each covered pixel was shaded on average. 1 means no overdraw at all.
+[[nodiscard]] float analyzeOverdraw(const std::vector<Vertex>& vertices, const std::vector<Index>& indices);
+
+/// Reorders triangles for the vertex cache with Tipsify (Sander, Nehab and Barczak, 2007).
+/// Returns the first triangle of each cluster, where the cache was starting over anyway. Pass them to optimizeOverdraw().
+std::vector<std::size_t> optimizeVertexCache(std::vector<Index>& indices, std::size_t vertexCount, unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+
+/// Splits the clusters further where that costs less than the threshold in cache efficiency, then draws the clusters
+/// facing out from the middle of the mesh first so they hide more of the rest.
+void optimizeOverdraw(std::vector<Index>& indices, const std::vector<Vertex>& vertices, const std::vector<std::size_t>& clusters,
+                      unsigned int cacheSize = DEFAULT_CACHE_SIZE, float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+/// Orders vertices by when the indices first use them and drops unused vertices, so vertex reads stay close together.
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<Index>& indices);
+
+/// Runs every optimization in the right order.
+void optimize(std::vector<Vertex>& vertices, std::vector<Index>& indices,
+              unsigned int cacheSize = DEFAULT_CACHE_SIZE, float overdrawThreshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+} // namespace chira::MeshOptimizer
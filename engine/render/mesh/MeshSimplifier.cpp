@@ -0,0 +1,423 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace chira;
+
+namespace {
+
+/// The sum of squared distances to a set of planes, weighted by the area that put each plane there.
+struct Quadric {
+    double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+    double ab = 0, ac = 0, ad = 0;
+    double bc = 0, bd = 0, cd = 0;
+    double weight = 0;
+
+    void addPlane(const glm::vec3& normal, const glm::vec3& point, double planeWeight) {
+        const double a = normal.x, b = normal.y, c = normal.z;
+        const double d = -(a * point.x + b * point.y + c * point.z);
+        this->a2 += a * a * planeWeight; this->b2 += b * b * planeWeight; this->c2 += c * c * planeWeight; this->d2 += d * d * planeWeight;
+        this->ab += a * b * planeWeight; this->ac += a * c * planeWeight; this->ad += a * d * planeWeight;
+        this->bc += b * c * planeWeight; this->bd += b * d * planeWeight; this->cd += c * d * planeWeight;
+        this->weight += planeWeight;
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        this->a2 += other.a2; this->b2 += other.b2; this->c2 += other.c2; this->d2 += other.d2;
+        this->ab += other.ab; this->ac += other.ac; this->ad += other.ad;
+        this->bc += other.bc; this->bd += other.bd; this->cd += other.cd;
+        this->weight += other.weight;
+        return *this;
+    }
+
+    /// The weighted average squared distance from the point to the planes.
+    [[nodiscard]] double evaluate(const glm::vec3& point) const {
+        if (this->weight <= 0)
+            return 0;
+        const double x = point.x, y = point.y, z = point.z;
+        const double error = this->a2 * x * x + this->b2 * y * y + this->c2 * z * z + this->d2 +
+                             2 * (this->ab * x * y + this->ac * x * z + this->ad * x + this->bc * y * z + this->bd * y + this->cd * z);
+        return std::max(error / this->weight, 0.0);
+    }
+};
+
+/// Borders have to stay put much more than the rest of the surface, or holes open up where LODs meet other meshes.
+constexpr double BORDER_WEIGHT = 10.0;
+
+enum class VertexKind : std::uint8_t {
+    INTERIOR,
+    /// On exactly one open border, can only collapse along it.
+    BORDER,
+    /// Where borders meet or the mesh isn't manifold, never collapses.
+    LOCKED,
+};
+
+struct PositionHash {
+    std::size_t operator()(const glm::vec3& position) const {
+        std::size_t hash = 14695981039346656037ull;
+        for (int i = 0; i < 3; i++) {
+            // Adding 0 turns -0 into 0, they compare equal so they have to hash equal
+            hash = (hash ^ std::hash<float>{}(position[i] + 0.f)) * 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+[[nodiscard]] std::uint64_t edgeKey(Index a, Index b) {
+    return (static_cast<std::uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+[[nodiscard]] glm::vec3 triangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    return glm::cross(b - a, c - a);
+}
+
+constexpr auto NO_WEDGE = std::numeric_limits<Index>::max();
+
+struct Collapse {
+    Index from;
+    Index to;
+    double error;
+};
+
+class Simplifier {
+public:
+    Simplifier(const std::vector<Vertex>& vertices_, const std::vector<Index>& indices, bool keepSeams_)
+            : vertices(vertices_)
+            , positionOf(vertices_.size())
+            , quadrics(vertices_.size())
+            , triangles(indices.begin(), indices.begin() + static_cast<std::ptrdiff_t>(indices.size() / 3 * 3))
+            , keepSeams(keepSeams_) {
+        // Vertices in the same place but with different attributes are wedges of one position, and move together
+        std::unordered_map<glm::vec3, Index, PositionHash> firstAt;
+        firstAt.reserve(vertices_.size());
+        for (Index i = 0; i < vertices_.size(); i++) {
+            this->positionOf[i] = firstAt.try_emplace(vertices_[i].position, i).first->second;
+        }
+        this->removeDegenerateTriangles();
+
+        for (std::size_t i = 0; i < this->triangles.size(); i += 3) {
+            const auto& a = this->getPosition(this->triangles[i]);
+            auto normal = triangleNormal(a, this->getPosition(this->triangles[i + 1]), this->getPosition(this->triangles[i + 2]));
+            const auto length = glm::length(normal);
+            if (length <= 0.f)
+                continue;
+            normal /= length;
+            for (int corner = 0; corner < 3; corner++) {
+                this->quadrics[this->positionOf[this->triangles[i + corner]]].addPlane(normal, a, length * 0.5);
+            }
+        }
+        this->buildAdjacency();
+        for (std::size_t i = 0; i < this->triangles.size(); i += 3) {
+            for (int corner = 0; corner < 3; corner++) {
+                const auto from = this->positionOf[this->triangles[i + corner]];
+                const auto to = this->positionOf[this->triangles[i + (corner + 1) % 3]];
+                if (!this->borderEdges.contains(edgeKey(from, to)))
+                    continue;
+                // A plane through the edge at a right angle to the surface keeps the border from sliding sideways
+                const auto& a = this->vertices[from].position;
+                const auto& b = this->vertices[to].position;
+                const auto surfaceNormal = triangleNormal(this->getPosition(this->triangles[i]), this->getPosition(this->triangles[i + 1]), this->getPosition(this->triangles[i + 2]));
+                const auto borderNormal = glm::cross(b - a, surfaceNormal);
+                const auto length = glm::length(borderNormal);
+                if (length <= 0.f)
+                    continue;
+                const auto edgeLengthSquared = glm::dot(b - a, b - a);
+                this->quadrics[from].addPlane(borderNormal / length, a, edgeLengthSquared * BORDER_WEIGHT);
+                this->quadrics[to].addPlane(borderNormal / length, a, edgeLengthSquared * BORDER_WEIGHT);
+            }
+        }
+    }
+
+    /// Returns how many triangles were removed.
+    std::size_t runPass(std::size_t targetTriangleCount) {
+        const auto triangleCount = this->triangles.size() / 3;
+        if (triangleCount <= targetTriangleCount)
+            return 0;
+        this->buildAdjacency();
+
+        std::vector<Collapse> collapses;
+        collapses.reserve(this->triangles.size());
+        for (std::size_t i = 0; i < this->triangles.size(); i += 3) {
+            for (int corner = 0; corner < 3; corner++) {
+                const auto a = this->positionOf[this->triangles[i + corner]];
+                const auto b = this->positionOf[this->triangles[i + (corner + 1) % 3]];
+                const bool border = this->borderEdges.contains(edgeKey(a, b));
+                // Interior edges show up once from each side
+                if (!border && a > b)
+                    continue;
+                const auto ab = this->getCollapseError(a, b, border);
+                const auto ba = this->getCollapseError(b, a, border);
+                if (ab <= ba && ab < std::numeric_limits<double>::infinity())
+                    collapses.push_back({a, b, ab});
+                else if (ba < ab)
+                    collapses.push_back({b, a, ba});
+            }
+        }
+        if (collapses.empty())
+            return 0;
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) {
+            return lhs.error < rhs.error;
+        });
+        // Every collapse takes out about two triangles, stopping there leaves the rest to be chosen with fresh errors.
+        // Collapses blocked by one next to them aren't replaced with worse ones further down either, unless none went,
+        // since the errors further down might not be worth it once the ones here are done
+        const auto collapseLimit = std::min(std::max<std::size_t>((triangleCount - targetTriangleCount) / 2, 1), collapses.size());
+        const auto errorLimit = collapses[collapseLimit - 1].error;
+        std::size_t collapsed = 0;
+
+        std::vector<Index> remap(this->vertices.size());
+        for (Index i = 0; i < remap.size(); i++) {
+            remap[i] = i;
+        }
+        std::vector<bool> touched(this->vertices.size(), false);
+        std::size_t removed = 0;
+        for (const auto& collapse : collapses) {
+            if (triangleCount - removed <= targetTriangleCount || collapsed >= collapseLimit || (collapse.error > errorLimit && collapsed > 0))
+                break;
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+            if (this->flipsTriangle(collapse.from, collapse.to))
+                continue;
+            this->mapWedges(collapse.from, collapse.to, remap);
+            for (auto t = this->firstTriangle[collapse.from]; t < this->firstTriangle[collapse.from + 1]; t++) {
+                const auto triangle = this->adjacentTriangles[t];
+                bool hasTo = false;
+                for (int corner = 0; corner < 3; corner++) {
+                    const auto position = this->positionOf[this->triangles[triangle * 3 + corner]];
+                    touched[position] = true;
+                    hasTo |= position == collapse.to;
+                }
+                if (hasTo)
+                    removed++;
+            }
+            this->quadrics[collapse.to] += this->quadrics[collapse.from];
+            collapsed++;
+            this->maxError = std::max(this->maxError, collapse.error);
+        }
+
+        for (auto& index : this->triangles) {
+            index = remap[index];
+        }
+        this->removeDegenerateTriangles();
+        return removed;
+    }
+
+    [[nodiscard]] const std::vector<Index>& getTriangles() const {
+        return this->triangles;
+    }
+
+    [[nodiscard]] float getError() const {
+        return static_cast<float>(std::sqrt(this->maxError));
+    }
+
+private:
+    const std::vector<Vertex>& vertices;
+    /// The first vertex at the same position as each vertex, which stands for all of them.
+    std::vector<Index> positionOf;
+    std::vector<Quadric> quadrics;
+    std::vector<Index> triangles;
+    std::vector<VertexKind> kinds;
+    /// The triangles around each position, from firstTriangle[position] up to firstTriangle[position + 1].
+    std::vector<std::size_t> firstTriangle;
+    std::vector<std::size_t> adjacentTriangles;
+    std::unordered_set<std::uint64_t> borderEdges;
+    bool keepSeams;
+    double maxError = 0;
+
+    [[nodiscard]] const glm::vec3& getPosition(Index vertex) const {
+        return this->vertices[vertex].position;
+    }
+
+    void removeDegenerateTriangles() {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < this->triangles.size(); i += 3) {
+            const auto a = this->positionOf[this->triangles[i]];
+            const auto b = this->positionOf[this->triangles[i + 1]];
+            const auto c = this->positionOf[this->triangles[i + 2]];
+            if (a == b || b == c || c == a)
+                continue;
+            std::copy_n(this->triangles.begin() + static_cast<std::ptrdiff_t>(i), 3, this->triangles.begin() + static_cast<std::ptrdiff_t>(kept));
+            kept += 3;
+        }
+        this->triangles.resize(kept);
+    }
+
+    void buildAdjacency() {
+        const auto positionCount = this->vertices.size();
+        this->firstTriangle.assign(positionCount + 1, 0);
+        for (const auto index : this->triangles) {
+            this->firstTriangle[this->positionOf[index] + 1]++;
+        }
+        for (std::size_t i = 0; i < positionCount; i++) {
+            this->firstTriangle[i + 1] += this->firstTriangle[i];
+        }
+        this->adjacentTriangles.resize(this->triangles.size());
+        auto next = this->firstTriangle;
+        for (std::size_t i = 0; i < this->triangles.size(); i++) {
+            this->adjacentTriangles[next[this->positionOf[this->triangles[i]]]++] = i / 3;
+        }
+
+        // An edge used once is on a border, by three or more triangles the mesh isn't manifold there
+        std::unordered_map<std::uint64_t, int> edgeUses;
+        edgeUses.reserve(this->triangles.size());
+        for (std::size_t i = 0; i < this->triangles.size(); i += 3) {
+            for (int corner = 0; corner < 3; corner++) {
+                edgeUses[edgeKey(this->positionOf[this->triangles[i + corner]], this->positionOf[this->triangles[i + (corner + 1) % 3]])]++;
+            }
+        }
+        this->borderEdges.clear();
+        this->kinds.assign(positionCount, VertexKind::INTERIOR);
+        std::vector<std::uint8_t> borderCount(positionCount, 0);
+        for (const auto& [key, uses] : edgeUses) {
+            const auto a = static_cast<Index>(key >> 32);
+            const auto b = static_cast<Index>(key & 0xffffffff);
+            if (uses == 1) {
+                this->borderEdges.insert(key);
+                borderCount[a] = static_cast<std::uint8_t>(std::min(borderCount[a] + 1, 3));
+                borderCount[b] = static_cast<std::uint8_t>(std::min(borderCount[b] + 1, 3));
+            } else if (uses > 2) {
+                this->kinds[a] = VertexKind::LOCKED;
+                this->kinds[b] = VertexKind::LOCKED;
+            }
+        }
+        for (std::size_t i = 0; i < positionCount; i++) {
+            if (this->kinds[i] == VertexKind::LOCKED || borderCount[i] == 0)
+                continue;
+            this->kinds[i] = borderCount[i] == 2 ? VertexKind::BORDER : VertexKind::LOCKED;
+        }
+    }
+
+    [[nodiscard]] double getCollapseError(Index from, Index to, bool borderEdge) const {
+        if (this->kinds[from] == VertexKind::LOCKED || (this->kinds[from] == VertexKind::BORDER && !borderEdge) || !this->keepsSeams(from, to))
+            return std::numeric_limits<double>::infinity();
+        Quadric quadric = this->quadrics[from];
+        quadric += this->quadrics[to];
+        return quadric.evaluate(this->vertices[to].position);
+    }
+
+    /// Seams can only collapse along themselves: every wedge at the source has to share a triangle with the target,
+    /// or the collapse would drag the seam across the surface. Without keepSeams that's allowed anyway.
+    [[nodiscard]] bool keepsSeams(Index from, Index to) const {
+        if (!this->keepSeams)
+            return true;
+        for (auto t = this->firstTriangle[from]; t < this->firstTriangle[from + 1]; t++) {
+            const auto wedge = this->getWedgeAt(this->adjacentTriangles[t], from);
+            bool connected = false;
+            for (auto other = this->firstTriangle[from]; other < this->firstTriangle[from + 1] && !connected; other++) {
+                const auto triangle = this->adjacentTriangles[other];
+                connected = this->getWedgeAt(triangle, from) == wedge && this->getWedgeAt(triangle, to) != NO_WEDGE;
+            }
+            if (!connected)
+                return false;
+        }
+        return true;
+    }
+
+    /// Works out which wedge at the target each wedge at the source turns into: the one it shares a triangle with,
+    /// or the one with the closest attributes if there isn't one.
+    void mapWedges(Index from, Index to, std::vector<Index>& remap) const {
+        for (auto t = this->firstTriangle[from]; t < this->firstTriangle[from + 1]; t++) {
+            const auto triangle = this->adjacentTriangles[t];
+            if (const auto target = this->getWedgeAt(triangle, to); target != NO_WEDGE)
+                remap[this->getWedgeAt(triangle, from)] = target;
+        }
+        for (auto t = this->firstTriangle[from]; t < this->firstTriangle[from + 1]; t++) {
+            const auto wedge = this->getWedgeAt(this->adjacentTriangles[t], from);
+            if (this->positionOf[remap[wedge]] != to)
+                remap[wedge] = this->getClosestWedge(wedge, to);
+        }
+    }
+
+    /// The corner of the triangle at the given position.
+    [[nodiscard]] Index getWedgeAt(std::size_t triangle, Index position) const {
+        for (int corner = 0; corner < 3; corner++) {
+            if (this->positionOf[this->triangles[triangle * 3 + corner]] == position)
+                return this->triangles[triangle * 3 + corner];
+        }
+        return NO_WEDGE;
+    }
+
+    [[nodiscard]] Index getClosestWedge(Index wedge, Index position) const {
+        const auto& vertex = this->vertices[wedge];
+        Index closest = position;
+        float closestDistance = std::numeric_limits<float>::max();
+        for (auto t = this->firstTriangle[position]; t < this->firstTriangle[position + 1]; t++) {
+            for (int corner = 0; corner < 3; corner++) {
+                const auto candidate = this->triangles[this->adjacentTriangles[t] * 3 + corner];
+                if (this->positionOf[candidate] != position)
+                    continue;
+                const auto& other = this->vertices[candidate];
+                const glm::vec3 normal{vertex.normal.r - other.normal.r, vertex.normal.g - other.normal.g, vertex.normal.b - other.normal.b};
+                const glm::vec3 color{vertex.color.r - other.color.r, vertex.color.g - other.color.g, vertex.color.b - other.color.b};
+                const glm::vec3 uv{vertex.uv.r - other.uv.r, vertex.uv.g - other.uv.g, 0.f};
+                const float distance = glm::dot(normal, normal) + glm::dot(color, color) + glm::dot(uv, uv);
+                if (distance < closestDistance) {
+                    closest = candidate;
+                    closestDistance = distance;
+                }
+            }
+        }
+        return closest;
+    }
+
+    /// True if moving the source onto the target turns any triangle that stays over, or makes it nearly flat.
+    [[nodiscard]] bool flipsTriangle(Index from, Index to) const {
+        for (auto t = this->firstTriangle[from]; t < this->firstTriangle[from + 1]; t++) {
+            const auto triangle = this->adjacentTriangles[t] * 3;
+            glm::vec3 before[3], after[3];
+            bool hasTo = false;
+            for (int corner = 0; corner < 3; corner++) {
+                const auto position = this->positionOf[this->triangles[triangle + corner]];
+                hasTo |= position == to;
+                before[corner] = this->vertices[position].position;
+                after[corner] = position == from ? this->vertices[to].position : before[corner];
+            }
+            if (hasTo)
+                continue;
+            const auto normalBefore = triangleNormal(before[0], before[1], before[2]);
+            const auto normalAfter = triangleNormal(after[0], after[1], after[2]);
+            if (glm::dot(normalBefore, normalAfter) <= 1e-2f * glm::length(normalBefore) * glm::length(normalAfter))
+                return true;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+std::vector<Index> MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<Index>& indices,
+                                            std::size_t targetIndexCount, float* error, bool keepSeams) {
+    Simplifier simplifier{vertices, indices, keepSeams};
+    while (simplifier.runPass(targetIndexCount / 3) > 0) {}
+    if (error)
+        *error = simplifier.getError();
+    return simplifier.getTriangles();
+}
+
+std::vector<MeshLOD> MeshSimplifier::generateLODs(const std::vector<Vertex>& vertices, const std::vector<Index>& indices, std::size_t maxLODs) {
+    std::vector<MeshLOD> lods;
+    while (lods.size() < maxLODs) {
+        // Simplifying the last LOD instead of the full mesh is much faster, and adding up the errors keeps them honest
+        const auto& previous = lods.empty() ? indices : lods.back().indices;
+        const auto target = previous.size() / 6 * 3;
+        const auto reducedEnough = [&previous](const std::vector<Index>& simplified) {
+            return !simplified.empty() && static_cast<float>(simplified.size()) <= static_cast<float>(previous.size()) * (1.f - MIN_LOD_REDUCTION);
+        };
+        float error = 0.f;
+        auto simplified = MeshSimplifier::simplify(vertices, previous, target, &error);
+        if (!reducedEnough(simplified)) {
+            // Some meshes have a seam on nearly every edge, like ones with a UV island for each face
+            simplified = MeshSimplifier::simplify(vertices, previous, target, &error, false);
+            if (!reducedEnough(simplified))
+                break;
+        }
+        const auto totalError = (lods.empty() ? 0.f : lods.back().error) + error;
+        lods.push_back({std::move(simplified), totalError});
+    }
+    return lods;
+}
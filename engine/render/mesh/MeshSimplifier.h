@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <loader/mesh/IMeshLoader.h>
+#include <math/Vertex.h>
+
+/// Removes triangles from meshes while keeping their shape, for drawing them far away.
+namespace chira::MeshSimplifier {
+
+/// How many LODs generateLODs() makes at most.
+constexpr std::size_t DEFAULT_LOD_COUNT = 4;
+/// A LOD that doesn't get rid of at least this much of the last one isn't worth keeping.
+constexpr float MIN_LOD_REDUCTION = 0.25f;
+
+/// Collapses edges in order of their quadric error (Garland and Heckbert, 1997) until the mesh has at most the target
+/// number of indices, or nothing more can go. Vertices are never moved, so the result indexes the same vertices.
+/// Open borders only collapse along themselves. Seams between vertices with different normals, colors or UVs only
+/// collapse along the seam too, unless keepSeams is false, which stretches the attributes across them instead.
+/// If error is not null, it gets how far the result strays from the mesh.
+[[nodiscard]] std::vector<Index> simplify(const std::vector<Vertex>& vertices, const std::vector<Index>& indices,
+                                          std::size_t targetIndexCount, float* error = nullptr, bool keepSeams = true);
+
+/// Simplifies each LOD to about half the triangles of the one before it, until the count is reached or it stops
+/// getting meaningfully smaller. Seams are kept unless that stops the mesh getting smaller.
+/// The errors are added up along the chain, so they only ever get bigger.
+[[nodiscard]] std::vector<MeshLOD> generateLODs(const std::vector<Vertex>& vertices, const std::vector<Index>& indices,
+                                                std::size_t maxLODs = DEFAULT_LOD_COUNT);
+
+} // namespace chira::MeshSimplifier
@@ -10,8 +10,8 @@ using namespace chira;
 
 CHIRA_CREATE_LOG(SHADER);
 
-Shader::Shader(std::string identifier_)
-        : Resource(std::move(identifier_)) {}
+Shader::Shader(ResourceID identifier_)
+        : Resource(identifier_) {}
 
 void Shader::compile(const byte buffer[], std::size_t bufferLength) {
     Serial::loadFromBuffer(this, buffer, bufferLength);
@@ -35,7 +35,8 @@ void Shader::use() const {
 }
 
 Shader::~Shader() {
-    Renderer::destroyShader(this->handle);
+    if (this->handle)
+        Renderer::destroyShader(this->handle);
 }
 
 void Shader::addPreprocessorSymbol(const std::string& name, const std::string& value) {
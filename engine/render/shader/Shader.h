@@ -14,7 +14,7 @@ constexpr std::string_view SHADER_PREPROCESSOR_DEFAULT_SUFFIX = "#";
 
 class Shader : public Resource {
 public:
-    explicit Shader(std::string identifier_);
+    explicit Shader(ResourceID identifier_);
     void compile(const byte buffer[], std::size_t bufferLength) override;
     void use() const;
     ~Shader() override;
@@ -114,6 +114,9 @@ public:
                 cereal::make_nvp("fragment", this->fragmentPath)
         );
     }
+
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(Shader);
 };
 
 } // namespace chira
@@ -10,14 +10,20 @@ namespace chira {
 
 class ITexture : public Resource {
 public:
-    explicit ITexture(std::string identifier_)
-            : Resource(std::move(identifier_)) {}
+    explicit ITexture(ResourceID identifier_)
+            : Resource(identifier_) {}
 
     virtual void use() const = 0;
     virtual void use(TextureUnit activeTextureUnit) const = 0;
 
+    [[nodiscard]] std::size_t getGPUMemoryUsage() const override {
+        return this->gpuMemoryUsage;
+    }
+
 protected:
     Renderer::TextureHandle handle{};
+    /// Estimated size of the texture on the GPU, set when it is compiled
+    std::size_t gpuMemoryUsage = 0;
 };
 
 } // namespace chira
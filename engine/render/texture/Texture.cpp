@@ -2,16 +2,18 @@
 
 #include <core/Logger.h>
 #include <render/backend/RenderBackend.h>
+#include <render/backend/UploadQueue.h>
 
 using namespace chira;
 
 CHIRA_CREATE_LOG(TEXTURE);
 
-Texture::Texture(std::string identifier_, bool cacheTexture /*= true*/)
-    : ITexture(std::move(identifier_))
+Texture::Texture(ResourceID identifier_, bool cacheTexture /*= true*/)
+    : ITexture(identifier_)
     , cache(cacheTexture) {}
 
 Texture::~Texture() {
+    UploadQueue::cancel(this->uploadTicket);
     if (this->handle)
         Renderer::destroyTexture(this->handle);
 }
@@ -21,17 +23,37 @@ void Texture::compile(const byte buffer[], std::size_t bufferLength) {
 
     auto imageFile = Resource::getResource<Image>(this->filePath, this->verticalFlip);
 
-    this->handle = Renderer::createTexture2D(*imageFile, this->wrapModeS, this->wrapModeT, this->filterMode,
-                                             this->mipmaps, TextureUnit::G0);
-    if (this->cache) {
+    // The upload holds onto the image until it runs
+    this->uploadTicket = UploadQueue::enqueue(imageFile->getCPUMemoryUsage(), [this, imageFile] {
+        this->handle = Renderer::createTexture2D(*imageFile, this->wrapModeS, this->wrapModeT, this->filterMode,
+                                                 this->mipmaps, TextureUnit::G0);
+        this->uploadTicket = 0;
+    });
+    // Uploaded in the same format as the image, mipmaps add another third
+    this->gpuMemoryUsage = imageFile->getCPUMemoryUsage() * (this->mipmaps ? 4 : 3) / 3;
+    if (this->cache && Resource::shouldKeepCPUCopies()) {
         this->file = imageFile;
+    } else {
+        // The cache would keep the decoded image alive otherwise, anything else using it holds its own reference
+        Resource::removeResource(this->filePath);
     }
 }
 
 void Texture::use() const {
-    Renderer::useTexture(this->handle, TextureUnit::G0);
+    this->use(TextureUnit::G0);
 }
 
 void Texture::use(TextureUnit activeTextureUnit) const {
-    Renderer::useTexture(this->handle, activeTextureUnit);
+    if (this->handle) {
+        Renderer::useTexture(this->handle, activeTextureUnit);
+        return;
+    }
+    // Draw with the default texture until this one is uploaded, and upload that first if it's still waiting its turn
+    const auto placeholder = Resource::getDefaultResource<Texture>();
+    if (!placeholder)
+        return;
+    if (!placeholder->handle)
+        UploadQueue::run(placeholder->uploadTicket);
+    if (placeholder->handle)
+        Renderer::useTexture(placeholder->handle, activeTextureUnit);
 }
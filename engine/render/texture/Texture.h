@@ -1,6 +1,7 @@
 #pragma once
 
 #include <loader/image/Image.h>
+#include <render/backend/UploadQueue.h>
 #include <utility/Serial.h>
 #include "ITexture.h"
 
@@ -8,13 +9,16 @@ namespace chira {
 
 class Texture final : public ITexture {
 public:
-    explicit Texture(std::string identifier_, bool cacheTexture = true);
+    /// If cacheTexture is false, or res_keep_cpu_copies is off, the decoded image is freed once it is uploaded.
+    explicit Texture(ResourceID identifier_, bool cacheTexture = true);
     ~Texture() override;
     void compile(const byte buffer[], std::size_t bufferLength) override;
     void use() const override;
+    /// Draws with the default texture until the texture is uploaded (see UploadQueue).
     void use(TextureUnit activeTextureUnit) const override;
 
 protected:
+    UploadQueue::Ticket uploadTicket = 0;
     SharedPointer<Image> file;
     std::string filePath{"file://textures/missing.png"};
     WrapMode wrapModeS = WrapMode::REPEAT;
@@ -36,6 +40,10 @@ public:
                 cereal::make_nvp("filterMode", this->filterMode)
         );
     }
+
+private:
+    CHIRA_REGISTER_DEFAULT_RESOURCE(Texture, "file://textures/missing.json");
+    CHIRA_REGISTER_RESOURCE_TYPE(Texture);
 };
 
 } // namespace chira
@@ -8,8 +8,8 @@ using namespace chira;
 
 CHIRA_CREATE_LOG(TEXTURECUBEMAP);
 
-TextureCubemap::TextureCubemap(std::string identifier_)
-    : ITexture(std::move(identifier_)) {}
+TextureCubemap::TextureCubemap(ResourceID identifier_)
+    : ITexture(identifier_) {}
 
 TextureCubemap::~TextureCubemap() {
     if (this->handle)
@@ -29,6 +29,14 @@ void TextureCubemap::compile(const byte buffer[], std::size_t bufferLength) {
     this->handle = Renderer::createTextureCubemap(*fileRT, *fileLT, *fileUP, *fileDN, *fileFD, *fileBK,
                                                   this->wrapModeS, this->wrapModeT, this->wrapModeR, this->filterMode,
                                                   this->mipmaps, TextureUnit::G0);
+    // Uploaded in the same format as the images, mipmaps add another third
+    this->gpuMemoryUsage = (fileFD->getCPUMemoryUsage() + fileBK->getCPUMemoryUsage() + fileUP->getCPUMemoryUsage() +
+                            fileDN->getCPUMemoryUsage() + fileLT->getCPUMemoryUsage() + fileRT->getCPUMemoryUsage()) * (this->mipmaps ? 4 : 3) / 3;
+    if (!Resource::shouldKeepCPUCopies()) {
+        for (const auto& imagePath : {this->imageFD, this->imageBK, this->imageUP, this->imageDN, this->imageLT, this->imageRT}) {
+            Resource::removeResource(imagePath);
+        }
+    }
 }
 
 void TextureCubemap::use() const {
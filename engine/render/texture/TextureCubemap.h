@@ -8,7 +8,7 @@ namespace chira {
 
 class TextureCubemap final : public ITexture {
 public:
-    explicit TextureCubemap(std::string identifier_);
+    explicit TextureCubemap(ResourceID identifier_);
     ~TextureCubemap() override;
     void compile(const byte buffer[], std::size_t bufferLength) override;
     void use() const override;
@@ -56,6 +56,9 @@ public:
                 cereal::make_nvp("filterMode", this->filterMode)
         );
     }
+
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(TextureCubemap);
 };
 
 } // namespace chira
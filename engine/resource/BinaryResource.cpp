@@ -1,23 +1,19 @@
 #include "BinaryResource.h"
 
-#include <cstring>
-
 using namespace chira;
 
 void BinaryResource::compile(const byte buffer[], std::size_t bufferLength) {
-    this->bufferLength_ = bufferLength - 1;
-    this->buffer_ = new byte[this->bufferLength_];
-    std::memcpy(this->buffer_, buffer, this->bufferLength_);
+    this->view = ResourceView::fromNullTerminatedBuffer({buffer, buffer + bufferLength});
 }
 
-BinaryResource::~BinaryResource() {
-    delete[] this->buffer_;
+void BinaryResource::compileView(const ResourceView& view_) {
+    this->view = view_;
 }
 
 const byte* BinaryResource::getBuffer() const {
-    return this->buffer_;
+    return this->view.getData();
 }
 
 std::size_t BinaryResource::getBufferLength() const {
-    return this->bufferLength_;
+    return this->view.getSize();
 }
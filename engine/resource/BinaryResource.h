@@ -6,14 +6,23 @@ namespace chira {
 
 class BinaryResource : public Resource {
 public:
-    explicit BinaryResource(std::string identifier_) : Resource(std::move(identifier_)) {}
+    explicit BinaryResource(ResourceID identifier_) : Resource(identifier_) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
-    ~BinaryResource() override;
+    /// Keeps the view instead of copying it, so memory-mapped files stay mapped for the lifetime of the resource.
+    void compileView(const ResourceView& view) override;
+    [[nodiscard]] bool isThreadSafeToCompile() const override {
+        return true;
+    }
+    /// Memory-mapped views are counted too, they still take up address space and page cache.
+    [[nodiscard]] std::size_t getCPUMemoryUsage() const override {
+        return this->view.getSize();
+    }
     [[nodiscard]] const byte* getBuffer() const;
     [[nodiscard]] std::size_t getBufferLength() const;
 protected:
-    byte* buffer_ = nullptr;
-    std::size_t bufferLength_ = 0;
+    ResourceView view;
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(BinaryResource);
 };
 
 } // namespace chira
@@ -1,14 +1,55 @@
 #include "Resource.h"
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <optional>
+#include <config/ConEntry.h>
 #include <core/Logger.h>
 #include <i18n/TranslationManager.h>
+#include <utility/DependencyGraph.h>
+#include <utility/ThreadPool.h>
 
 using namespace chira;
 
 CHIRA_CREATE_LOG(RESOURCE);
 
-Resource::~Resource() {
-    Resource::removeResource(this->identifier);
+[[maybe_unused]]
+ConVar res_memory_budget{"res_memory_budget", 512, "The amount of memory in megabytes cached resources can use before unused ones are freed.", CON_FLAG_CACHE};
+
+ConVar res_keep_cpu_copies{"res_keep_cpu_copies", true, "Keep the CPU-side copy of meshes and textures after they are uploaded to the GPU.", CON_FLAG_CACHE};
+
+[[maybe_unused]]
+ConCommand res_refresh_providers{"res_refresh_providers", "Makes resource providers pick up resources that were added or removed since they were mounted.", [] {
+    Resource::refreshResourceProviders();
+}};
+
+[[maybe_unused]]
+ConCommand res_export_stats{"res_export_stats", "Writes load times and memory usage of every cached resource to a JSON file (default resource_stats.json).", [](ConCommand::CallbackArgs args) {
+    const std::string path = args.empty() ? "resource_stats.json" : args[0];
+    if (Resource::exportCachedResourceInfo(path))
+        LOG_RESOURCE.infoImportant(TRF("debug.resource.exported_stats", path));
+    else
+        LOG_RESOURCE.error(TRF("error.resource.cannot_export_stats", path));
+}};
+
+/// How often to look for freed resources that were released from the cache while something was still using them.
+static constexpr auto EXPIRED_RESOURCE_SWEEP_INTERVAL = std::chrono::seconds{1};
+
+static double getMillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Resource::compileView(const ResourceView& view) {
+    if (view.isNullTerminated()) {
+        this->compile(view.getData(), view.getSize() + 1);
+        return;
+    }
+    std::vector<byte> buffer(view.getSize() + 1);
+    std::copy_n(view.getData(), view.getSize(), buffer.begin());
+    buffer[view.getSize()] = '\0';
+    this->compile(buffer.data(), buffer.size());
 }
 
 //
@@ -16,86 +57,404 @@ Resource::~Resource() {
 //
 
 void Resource::addResourceProvider(IResourceProvider* provider) {
-    std::string providerName{provider->getName().data()};
-    if (Resource::providers.find(providerName) == Resource::providers.end()) {
-        Resource::providers[providerName] = std::vector<std::unique_ptr<IResourceProvider>>{};
-    }
-    Resource::providers[providerName].emplace_back(provider);
+    std::unique_lock lock{Resource::providersMutex};
+    Resource::providers[hashFNV1a(provider->getName())].emplace_back(provider);
 }
 
-IResourceProvider* Resource::getLatestResourceProvider(const std::string& provider) {
-    return Resource::providers[provider][Resource::providers[provider].size() - 1].get();
+IResourceProvider* Resource::getLatestResourceProvider(std::string_view providerName) {
+    std::shared_lock lock{Resource::providersMutex};
+    const auto& providerList = Resource::getProviders(hashFNV1a(providerName));
+    if (providerList.empty())
+        return nullptr;
+    return providerList.back().get();
 }
 
-IResourceProvider* Resource::getResourceProviderWithResource(const std::string& identifier) {
-    auto id = Resource::splitResourceIdentifier(identifier);
-    const std::string& provider = id.first, name = id.second;
-    for (auto i = Resource::providers[provider].rbegin(); i < Resource::providers[provider].rend(); i++) {
-        if (i->get()->hasResource(name))
-            return i->get();
-    }
-    LOG_RESOURCE.error(TRF("error.resource.resource_not_found", identifier));
+IResourceProvider* Resource::getResourceProviderWithResource(const ResourceID& identifier) {
+    if (auto* provider = Resource::findResourceProvider(identifier))
+        return provider;
+    LOG_RESOURCE.error(TRF("error.resource.resource_not_found", identifier.getIdentifier()));
     return nullptr;
 }
 
-std::pair<std::string, std::string> Resource::splitResourceIdentifier(const std::string& identifier) {
-    std::pair<std::string, std::string> out;
-    size_t pos = identifier.find(RESOURCE_ID_SEPARATOR);
-    if (pos != std::string::npos) {
-        out.first = identifier.substr(0, pos);
-        out.second = identifier.substr(pos + RESOURCE_ID_SEPARATOR.length());
-    } else {
-        LOG_RESOURCE.error(TRF("error.resource.cannot_split_identifier", identifier));
+IResourceProvider* Resource::findResourceProvider(const ResourceID& identifier, double* lookupTime /*= nullptr*/) {
+    const auto start = std::chrono::steady_clock::now();
+    IResourceProvider* found = nullptr;
+    {
+        std::shared_lock lock{Resource::providersMutex};
+        const auto& providerList = Resource::getProviders(identifier.getProviderHash());
+        for (auto i = providerList.rbegin(); i != providerList.rend(); i++) {
+            if (i->get()->hasResource(identifier.getName())) {
+                found = i->get();
+                break;
+            }
+        }
     }
-    return out;
+    if (lookupTime)
+        *lookupTime = getMillisecondsSince(start);
+    return found;
 }
 
-const std::vector<std::unique_ptr<IResourceProvider>>& Resource::getResourceProviders(const std::string& providerName) {
-    return Resource::providers.at(providerName);
+void Resource::compileFromProvider(Resource* resource, const IResourceProvider* provider, double providerLookupTime) {
+    resource->loadStats.providerLookupTime = providerLookupTime;
+    auto start = std::chrono::steady_clock::now();
+    const auto view = provider->readResource(resource->identifier.getName());
+    resource->loadStats.ioTime = getMillisecondsSince(start);
+    resource->loadStats.ioBytes = view.getSize();
+
+    start = std::chrono::steady_clock::now();
+    resource->compileView(view);
+    resource->loadStats.compileTime = getMillisecondsSince(start);
 }
 
-bool Resource::hasResource(const std::string& identifier) {
-    auto id = Resource::splitResourceIdentifier(identifier);
-    const std::string& provider = id.first, name = id.second;
-    for (auto i = Resource::providers[provider].rbegin(); i != Resource::providers[provider].rend(); i++) {
-        if (i->get()->hasResource(name))
-            return true;
+void Resource::refreshResourceProviders() {
+    std::shared_lock lock{Resource::providersMutex};
+    for (const auto& providerList : Resource::providers) {
+        for (const auto& provider : providerList.second) {
+            provider->refresh();
+        }
     }
-    return false;
 }
 
-void Resource::removeResource(const std::string& identifier) {
-    auto id = Resource::splitResourceIdentifier(identifier);
-    const std::string& provider = id.first, name = id.second;
-    // If the count is 2, then it's being held by the resource manager and the object requesting its removal.
-    // Anything below 2 means it should be already deleted everywhere except the resource manager.
-    if (Resource::resources[provider].contains(name) && Resource::resources[provider][name].useCount() <= 2)
-        Resource::garbageResources.push_back(identifier);
+ThreadPool& Resource::getLoadingPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+const std::vector<std::unique_ptr<IResourceProvider>>& Resource::getResourceProviders(std::string_view providerName) {
+    std::shared_lock lock{Resource::providersMutex};
+    return Resource::getProviders(hashFNV1a(providerName));
+}
+
+const std::vector<std::unique_ptr<IResourceProvider>>& Resource::getProviders(std::uint64_t providerHash) {
+    static const std::vector<std::unique_ptr<IResourceProvider>> noProviders;
+    if (auto providerList = Resource::providers.find(providerHash); providerList != Resource::providers.end())
+        return providerList->second;
+    return noProviders;
+}
+
+bool Resource::hasResource(const ResourceID& identifier) {
+    return Resource::findResourceProvider(identifier) != nullptr;
+}
+
+void Resource::removeResource(const ResourceID& identifier) {
+    std::scoped_lock lock{Resource::garbageResourcesMutex};
+    Resource::garbageResources.push_back(identifier);
 }
 
 void Resource::cleanup() {
-    for (const auto& name : Resource::garbageResources) {
-        auto id = Resource::splitResourceIdentifier(name);
-        Resource::resources[id.first].erase(id.second);
+    std::vector<ResourceID> garbageIdentifiers;
+    {
+        std::scoped_lock lock{Resource::garbageResourcesMutex};
+        if (Resource::garbageResources.empty())
+            return;
+        garbageIdentifiers.swap(Resource::garbageResources);
+    }
+    for (const auto& identifier : garbageIdentifiers) {
+        // The cache hands its reference back, so the resource is freed here and not under the cache's lock
+        Resource::resources.release(identifier);
     }
-    Resource::garbageResources.clear();
 }
 
-void Resource::discardAll() {
-    Resource::defaultResources.clear();
+void Resource::updateCachedMemoryUsage() const {
+    Resource::resources.updateMemoryUsage(this->identifier, this);
+}
+
+std::size_t Resource::getCachedMemoryUsage() {
+    return Resource::resources.getMemoryUsage();
+}
+
+std::vector<CachedResourceInfo> Resource::getCachedResourceInfo() {
+    std::vector<CachedResourceInfo> info;
+    info.reserve(Resource::resources.size());
+    Resource::resources.forEach([&info](const ResourceID& identifier, const SharedPointer<Resource>& resource) {
+        info.push_back({identifier, resource.useCount(), resource->getLoadStats(), resource->getCPUMemoryUsage(), resource->getGPUMemoryUsage()});
+    });
+    return info;
+}
+
+bool Resource::exportCachedResourceInfo(const std::string& path) {
+    nlohmann::json resourcesJSON = nlohmann::json::array();
+    for (const auto& info : Resource::getCachedResourceInfo()) {
+        resourcesJSON.push_back({
+            {"identifier", info.identifier.getIdentifier()},
+            {"useCount", info.useCount},
+            {"providerLookupTime", info.loadStats.providerLookupTime},
+            {"ioTime", info.loadStats.ioTime},
+            {"ioBytes", info.loadStats.ioBytes},
+            {"compileTime", info.loadStats.compileTime},
+            {"cpuMemoryUsage", info.cpuMemoryUsage},
+            {"gpuMemoryUsage", info.gpuMemoryUsage},
+        });
+    }
+    std::ofstream output{path};
+    if (!output)
+        return false;
+    output << nlohmann::json{{"resources", resourcesJSON}}.dump(4);
+    return output.good();
+}
+
+void Resource::evictUnusedResources(std::size_t memoryBudget) {
+    if (Resource::resources.getMemoryUsage() <= memoryBudget)
+        return;
+    for (const auto& identifier : Resource::resources.getUnusedResources()) {
+        if (Resource::resources.getMemoryUsage() <= memoryBudget)
+            break;
+        // Something may have picked it up again since the list was made, then this does nothing
+        Resource::resources.eraseIfUnused(identifier);
+    }
+    // Evicting a resource can leave the resources it was holding unused, those go next frame
+}
+
+bool Resource::shouldKeepCPUCopies() {
+    return res_keep_cpu_copies.getValue<bool>();
+}
+
+void Resource::update() {
+    ResourceTrace::nextFrame();
     Resource::cleanup();
-    for (const auto& [providerName, resourceMap] : Resource::resources) {
-        for (const auto& [name, resource] : resourceMap) {
-            // This really shouldn't happen, but it should work out if it does, hence the warning
-            LOG_RESOURCE.warning() << TRF("warn.resource.deleting_resource_at_exit",
-                                          Resource::resources[providerName].at(name)->getIdentifier(),
-                                          Resource::resources[providerName].at(name).useCount());
+    std::vector<std::shared_ptr<PendingResourceLoad>> finished;
+    {
+        std::scoped_lock lock{Resource::pendingResourcesMutex};
+        for (auto i = Resource::pendingResources.begin(); i != Resource::pendingResources.end();) {
+            if (i->second->work.wait_for(std::chrono::seconds{0}) != std::future_status::ready) {
+                i++;
+                continue;
+            }
+            finished.push_back(std::move(i->second));
+            i = Resource::pendingResources.erase(i);
+        }
+    }
+    // Compiling can request more resources, so don't hold the lock
+    for (auto& load : finished) {
+        Resource::publishPendingResource(std::move(load));
+    }
+    Resource::evictUnusedResources(static_cast<std::size_t>(std::max(res_memory_budget.getValue<int>(), 0)) * 1024 * 1024);
+    // Released resources are freed whenever their last user lets go, so check right after a release and then every so often
+    static auto lastSweep = std::chrono::steady_clock::now();
+    if (const auto now = std::chrono::steady_clock::now(); Resource::resources.takeReleased() || now - lastSweep >= EXPIRED_RESOURCE_SWEEP_INTERVAL) {
+        Resource::resources.eraseExpired();
+        lastSweep = now;
+    }
+}
+
+void Resource::finishPendingResource(const ResourceID& identifier) {
+    std::shared_ptr<PendingResourceLoad> load;
+    {
+        std::scoped_lock lock{Resource::pendingResourcesMutex};
+        auto pending = Resource::pendingResources.find(identifier);
+        if (pending == Resource::pendingResources.end())
+            return;
+        load = std::move(pending->second);
+        Resource::pendingResources.erase(pending);
+    }
+    Resource::publishPendingResource(std::move(load));
+}
+
+void Resource::startPendingResource(const std::shared_ptr<PendingResourceLoad>& load, const IResourceProvider* provider) {
+    load->compileOnWorker = load->resource->isThreadSafeToCompile();
+    std::optional<double> prereadTime;
+    if (auto preread = Resource::prereadViews.find(load->identifier); preread != Resource::prereadViews.end()) {
+        load->view = std::move(preread->second.view);
+        prereadTime = preread->second.ioTime;
+        Resource::prereadViews.erase(preread);
+    }
+    // The worker only sees the raw pointer, the main thread decides when the resource is published
+    Resource* target = load->resource.get();
+    PendingResourceLoad* state = load.get();
+    load->work = Resource::getLoadingPool().submit([state, target, provider, prereadTime] {
+        // The main thread doesn't look at the stats until the work is done
+        auto start = std::chrono::steady_clock::now();
+        if (prereadTime) {
+            target->loadStats.ioTime = *prereadTime;
+        } else {
+            state->view = provider->readResource(state->identifier.getName());
+            target->loadStats.ioTime = getMillisecondsSince(start);
+        }
+        target->loadStats.ioBytes = state->view.getSize();
+        if (state->compileOnWorker) {
+            start = std::chrono::steady_clock::now();
+            target->compileView(state->view);
+            target->loadStats.compileTime = getMillisecondsSince(start);
+            state->view = {};
+        }
+    });
+    Resource::pendingResources[load->identifier] = load;
+}
+
+void Resource::publishPendingResource(std::shared_ptr<PendingResourceLoad> load) {
+    auto resource = std::move(load->resource);
+    try {
+        load->work.get();
+        if (!load->compileOnWorker) {
+            const auto start = std::chrono::steady_clock::now();
+            resource->compileView(load->view);
+            resource->loadStats.compileTime = getMillisecondsSince(start);
+            load->view = {};
+        }
+        // Keep whatever got into the cache first if the resource was also loaded synchronously
+        load->resource = Resource::resources.insert(load->identifier, std::move(resource));
+    } catch (const std::exception& e) {
+        LOG_RESOURCE.error(TRF("error.resource.async_load_failed", load->identifier.getIdentifier(), e.what()));
+        std::shared_lock lock{Resource::defaultResourcesMutex};
+        if (auto defaultResource = Resource::defaultResources.find(load->type); defaultResource != Resource::defaultResources.end())
+            load->resource = defaultResource->second;
+    }
+    load->published = true;
+}
+
+void Resource::prereadResources(const std::vector<ResourceID>& identifiers) {
+    std::unordered_map<const IResourceProvider*, std::vector<const ResourceID*>> providerIdentifiers;
+    for (const auto& identifier : identifiers) {
+        if (Resource::resources.contains(identifier))
+            continue;
+        if (const auto* provider = Resource::findResourceProvider(identifier); provider && provider->hasBatchedReads())
+            providerIdentifiers[provider].push_back(&identifier);
+    }
+    for (const auto& [provider, batch] : providerIdentifiers) {
+        std::vector<std::string_view> names;
+        names.reserve(batch.size());
+        for (const auto* identifier : batch) {
+            names.push_back(identifier->getName());
+        }
+        const auto start = std::chrono::steady_clock::now();
+        auto views = provider->readResources(names);
+        const double ioTime = getMillisecondsSince(start) / static_cast<double>(batch.size());
+        std::scoped_lock lock{Resource::pendingResourcesMutex};
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            if (!views[i].isEmpty())
+                Resource::prereadViews[*batch[i]] = {std::move(views[i]), ioTime};
+        }
+    }
+}
+
+bool Resource::precacheManifest(const ResourceID& manifest, const std::function<void(std::size_t, std::size_t)>& onProgress) {
+    auto* provider = Resource::getResourceProviderWithResource(manifest);
+    if (!provider)
+        return false;
+    const auto view = provider->readResource(manifest.getName());
+    const auto* data = reinterpret_cast<const char*>(view.getData());
+    auto manifestJSON = nlohmann::json::parse(data, data + view.getSize(), nullptr, false);
+    if (manifestJSON.is_discarded()) {
+        LOG_RESOURCE.error(TRF("error.resource.invalid_manifest", manifest.getIdentifier()));
+        return false;
+    }
+    return Resource::precacheManifestFromJSON(manifestJSON, onProgress);
+}
+
+bool Resource::precacheManifestFromJSON(const nlohmann::json& manifest, const std::function<void(std::size_t, std::size_t)>& onProgress) {
+    if (!manifest.contains("resources") || !manifest["resources"].is_array()) {
+        LOG_RESOURCE.error(TR("error.resource.manifest_missing_resources"));
+        return false;
+    }
+
+    struct ManifestEntry {
+        ResourceID identifier;
+        const std::function<void(const ResourceID&)>* startLoad;
+        std::vector<std::string> dependencies;
+        std::size_t wave = 0;
+    };
+    std::vector<ManifestEntry> entries;
+    DependencyGraph graph;
+    std::unordered_map<std::string_view, UnweightedDirectedGraph::Node*> nodes;
+    std::unordered_map<const UnweightedDirectedGraph::Node*, std::size_t> nodeEntries;
+    const auto& loaders = Resource::getResourceTypeLoaders();
+
+    for (const auto& resource : manifest["resources"]) {
+        const auto type = resource.value("type", std::string{});
+        const ResourceID identifier{resource.value("identifier", std::string{})};
+        auto loader = loaders.find(type);
+        if (loader == loaders.end()) {
+            LOG_RESOURCE.error(TRF("error.resource.unknown_manifest_type", type, identifier.getIdentifier()));
+            continue;
+        }
+        if (!identifier.isValid() || nodes.contains(identifier.getIdentifier()))
+            continue;
+        auto* node = graph.addNode(std::string{identifier.getIdentifier()});
+        nodes[identifier.getIdentifier()] = node;
+        nodeEntries[node] = entries.size();
+        entries.push_back({identifier, &loader->second, resource.value("dependencies", std::vector<std::string>{})});
+    }
+    for (const auto& entry : entries) {
+        auto* node = nodes[entry.identifier.getIdentifier()];
+        for (const auto& dependency : entry.dependencies) {
+            if (auto dependencyNode = nodes.find(dependency); dependencyNode != nodes.end())
+                node->addEdge(dependencyNode->second);
+        }
+    }
+
+    const auto order = graph.resolveDependencyOrder();
+    if (!order) {
+        LOG_RESOURCE.error(TR("error.resource.manifest_dependency_cycle"));
+        return false;
+    }
+    // Resources in the same wave don't depend on each other, so a whole wave can load at once
+    std::size_t waveCount = 0;
+    for (const auto* node : *order) {
+        auto& entry = entries[nodeEntries[node]];
+        for (const auto* dependency : node->edges) {
+            entry.wave = std::max(entry.wave, entries[nodeEntries[dependency]].wave + 1);
+        }
+        waveCount = std::max(waveCount, entry.wave + 1);
+    }
+    std::vector<std::vector<const ManifestEntry*>> waves(waveCount);
+    for (const auto& entry : entries) {
+        waves[entry.wave].push_back(&entry);
+    }
+
+    std::size_t loaded = 0;
+    for (const auto& wave : waves) {
+        std::vector<ResourceID> waveIdentifiers;
+        waveIdentifiers.reserve(wave.size());
+        for (const auto* entry : wave) {
+            waveIdentifiers.push_back(entry->identifier);
         }
+        Resource::prereadResources(waveIdentifiers);
+        for (const auto* entry : wave) {
+            (*entry->startLoad)(entry->identifier);
+        }
+        {
+            // Resources that were already loading don't need what was read for them
+            std::scoped_lock lock{Resource::pendingResourcesMutex};
+            Resource::prereadViews.clear();
+        }
+        for (const auto* entry : wave) {
+            Resource::finishPendingResource(entry->identifier);
+            if (onProgress)
+                onProgress(++loaded, entries.size());
+        }
+    }
+    return true;
+}
+
+void Resource::discardAll() {
+    // The prefetcher reads from the providers
+    ResourceTrace::stopPrefetching();
+    {
+        // Loads in flight still reference their providers
+        std::scoped_lock lock{Resource::pendingResourcesMutex};
+        for (const auto& pending : Resource::pendingResources) {
+            pending.second->work.wait();
+        }
+        Resource::pendingResources.clear();
+        Resource::prereadViews.clear();
+    }
+    {
+        std::unique_lock lock{Resource::defaultResourcesMutex};
+        Resource::defaultResources.clear();
+    }
+    Resource::cleanup();
+    auto cached = Resource::resources.takeAll();
+    for (const auto& [identifier, resource] : cached) {
+        // Unused resources are kept in the cache on purpose, anything else really shouldn't happen,
+        // but it should work out if it does, hence the warning
+        if (resource.useCount() > 1)
+            LOG_RESOURCE.warning() << TRF("warn.resource.deleting_resource_at_exit", identifier.getIdentifier(), resource.useCount());
     }
-    Resource::resources.clear();
+    cached.clear();
+    std::unique_lock lock{Resource::providersMutex};
     Resource::providers.clear();
 }
 
-void Resource::logResourceError(const std::string& identifier, const std::string& resourceName) {
-    LOG_RESOURCE.error(TRF(identifier, resourceName));
+void Resource::logResourceError(const std::string& translationKey, std::string_view resourceName) {
+    LOG_RESOURCE.error(TRF(translationKey, resourceName));
 }
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <typeindex>
 #include <unordered_map>
 #include <vector>
 #include <nlohmann/json.hpp>
@@ -10,29 +17,113 @@
 #include <utility/SharedPointer.h>
 #include <utility/Types.h>
 #include "provider/IResourceProvider.h"
+#include "ResourceCache.h"
+#include "ResourceID.h"
+#include "ResourceTrace.h"
 
 namespace chira {
 
-constexpr std::string_view RESOURCE_ID_SEPARATOR = "://";
+class Resource;
+class ThreadPool;
+template<typename ResourceType> class PendingResource;
+
+/// Bookkeeping for a resource being read (and possibly compiled) on a worker thread.
+/// Everything except the view and the raw target is only touched on the main thread.
+struct PendingResourceLoad {
+    ResourceID identifier;
+    /// Used to fall back to the default resource if the load fails
+    std::type_index type = typeid(void);
+    SharedPointer<Resource> resource;
+    ResourceView view;
+    std::future<void> work;
+    bool compileOnWorker = false;
+    bool published = false;
+};
+
+/// Contents of a resource read ahead of time in a batch.
+struct PrereadResource {
+    ResourceView view;
+    /// This resource's share of the time it took to read the batch
+    double ioTime = 0.0;
+};
+
+/// Where the time went when a resource was loaded. Times are in milliseconds.
+struct ResourceLoadStats {
+    double providerLookupTime = 0.0;
+    double ioTime = 0.0;
+    std::size_t ioBytes = 0;
+    /// Includes loading any resources it depends on that weren't cached yet
+    double compileTime = 0.0;
+};
+
+/// A snapshot of a cached resource, for debugging tools.
+struct CachedResourceInfo {
+    ResourceID identifier;
+    unsigned int useCount;
+    ResourceLoadStats loadStats;
+    std::size_t cpuMemoryUsage;
+    std::size_t gpuMemoryUsage;
+};
 
 /// A chunk of data, usually a file. Is typically cached and shared.
 class Resource {
     // To view resource data
     friend class ResourceUsageTrackerPanel;
+    // To read resources ahead of time
+    friend class ResourceTrace;
 public:
-    explicit Resource(std::string identifier_)
-            : identifier(std::move(identifier_)) {}
+    explicit Resource(ResourceID identifier_)
+            : identifier(identifier_) {}
 
-    virtual ~Resource();
+    virtual ~Resource() = default;
 
     virtual void compile(const byte /*buffer*/[], std::size_t /*bufferLength*/) = 0;
 
+    /// Called by providers with the contents of the resource. The default implementation calls compile()
+    /// with a null-terminated buffer, copying the view if it has no terminator (i.e. it is memory-mapped).
+    /// Override this to keep the view around instead of copying it.
+    virtual void compileView(const ResourceView& view);
+
+    /// Override and return true if compile() does not touch the renderer or any other global state.
+    /// Resources that return true are compiled on a worker thread when loaded asynchronously.
+    [[nodiscard]] virtual bool isThreadSafeToCompile() const {
+        return false;
+    }
+
     [[nodiscard]] std::string_view getIdentifier() const {
+        return this->identifier.getIdentifier();
+    }
+
+    [[nodiscard]] const ResourceID& getResourceID() const {
         return this->identifier;
     }
 
+    [[nodiscard]] const ResourceLoadStats& getLoadStats() const {
+        return this->loadStats;
+    }
+
+    /// The amount of memory in bytes owned by this resource in main memory.
+    /// Memory held through other resources is reported by those resources, so don't count it twice.
+    [[nodiscard]] virtual std::size_t getCPUMemoryUsage() const {
+        return 0;
+    }
+
+    /// The amount of memory in bytes this resource allocated on the GPU.
+    [[nodiscard]] virtual std::size_t getGPUMemoryUsage() const {
+        return 0;
+    }
+
+    /// Used to decide when unused resources should be freed (see res_memory_budget).
+    [[nodiscard]] std::size_t getMemoryUsage() const {
+        return this->getCPUMemoryUsage() + this->getGPUMemoryUsage();
+    }
+
 protected:
-    std::string identifier;
+    ResourceID identifier;
+    ResourceLoadStats loadStats;
+
+    /// Call when getMemoryUsage() changes after the resource was cached, the cache keeps a running total.
+    void updateCachedMemoryUsage() const;
 
 //
 // Static caching functions
@@ -40,66 +131,125 @@ protected:
 public:
     static void addResourceProvider(IResourceProvider* provider);
 
-    static IResourceProvider* getLatestResourceProvider(const std::string& provider);
+    static IResourceProvider* getLatestResourceProvider(std::string_view providerName);
+
+    static IResourceProvider* getResourceProviderWithResource(const ResourceID& identifier);
 
-    static IResourceProvider* getResourceProviderWithResource(const std::string& identifier);
+    /// Tells every provider its contents may have changed, e.g. after files were added on disk.
+    static void refreshResourceProviders();
 
+    /// The workers asynchronous loads run on. Loaders can split their own work onto it with ThreadPool::parallelFor().
+    static ThreadPool& getLoadingPool();
+
+    /// The cache can be used from any thread, but most resource types still have to be compiled on the main thread.
     template<typename ResourceType, typename... Params>
-    static SharedPointer<ResourceType> getResource(const std::string& identifier, Params... params) {
+    static SharedPointer<ResourceType> getResource(const ResourceID& identifier, Params... params) {
+        ResourceTrace::recordRequest(identifier);
         Resource::cleanup();
-        auto id = Resource::splitResourceIdentifier(identifier);
-        const std::string& provider = id.first, name = id.second;
-        if (Resource::resources[provider].count(name) > 0) {
-            return Resource::resources[provider][name].template cast<ResourceType>();
+        Resource::finishPendingResource(identifier);
+        if (auto cached = Resource::resources.find(identifier)) {
+            return cached.template cast<ResourceType>();
+        }
+        if (auto resource = Resource::loadResource<ResourceType>(identifier, std::forward<Params>(params)...)) {
+            // Another thread might have loaded it in the meantime
+            return Resource::resources.insert(identifier, std::move(resource)).template cast<ResourceType>();
         }
-        return Resource::getUniqueResource<ResourceType>(identifier, std::forward<Params>(params)...);
+        Resource::logResourceError("error.resource.resource_not_found", identifier.getIdentifier());
+        if (Resource::hasDefaultResource<ResourceType>())
+            return Resource::getDefaultResource<ResourceType>();
+        return SharedPointer<ResourceType>{};
     }
 
+    /// Starts loading the resource on a worker thread and returns immediately.
+    /// Requests for a resource that is already loading share the same load.
+    /// The finished resource is put in the cache by Resource::update() on the main thread.
     template<typename ResourceType, typename... Params>
-    static void precacheResource(const std::string& identifier, Params... params) {
+    static PendingResource<ResourceType> getResourceAsync(const ResourceID& identifier, Params... params) {
+        ResourceTrace::recordRequest(identifier);
         Resource::cleanup();
-        auto id = Resource::splitResourceIdentifier(identifier);
-        const std::string& provider = id.first, name = id.second;
-        if (Resource::resources[provider].count(name) > 0) {
-            return; // Already in cache
+        std::scoped_lock lock{Resource::pendingResourcesMutex};
+        if (auto pending = Resource::pendingResources.find(identifier); pending != Resource::pendingResources.end()) {
+            return PendingResource<ResourceType>{pending->second};
         }
 
-        for (auto i = Resource::providers[provider].rbegin(); i != Resource::providers[provider].rend(); i++) {
-            if ((*i)->hasResource(name)) {
-                Resource::resources[provider][name] = SharedPointer<Resource>(new ResourceType{identifier, std::forward<Params>(params)...});
-                (*i)->compileResource(name, Resource::resources[provider][name].get());
-                return; // Precached!
-            }
+        auto load = std::make_shared<PendingResourceLoad>();
+        load->identifier = identifier;
+        load->type = typeHash<ResourceType>();
+
+        if (auto cached = Resource::resources.find(identifier)) {
+            load->resource = std::move(cached);
+            load->published = true;
+            return PendingResource<ResourceType>{load};
+        }
+
+        double lookupTime;
+        if (auto* provider = Resource::findResourceProvider(identifier, &lookupTime)) {
+            load->resource = SharedPointer<ResourceType>::make(identifier, std::forward<Params>(params)...);
+            load->resource->loadStats.providerLookupTime = lookupTime;
+            Resource::startPendingResource(load, provider);
+            return PendingResource<ResourceType>{load};
+        }
+        Resource::logResourceError("error.resource.resource_not_found", identifier.getIdentifier());
+        if (Resource::hasDefaultResource<ResourceType>())
+            load->resource = Resource::getDefaultResource<ResourceType>().template cast<Resource>();
+        load->published = true;
+        return PendingResource<ResourceType>{load};
+    }
+
+    template<typename ResourceType, typename... Params>
+    static void precacheResource(const ResourceID& identifier, Params... params) {
+        ResourceTrace::recordRequest(identifier);
+        Resource::cleanup();
+        Resource::finishPendingResource(identifier);
+        if (Resource::resources.contains(identifier)) {
+            return; // Already in cache
         }
-        Resource::logResourceError("error.resource.resource_not_found", identifier);
+        if (auto resource = Resource::loadResource<ResourceType>(identifier, std::forward<Params>(params)...)) {
+            Resource::resources.insert(identifier, std::move(resource));
+            return; // Precached!
+        }
+        Resource::logResourceError("error.resource.resource_not_found", identifier.getIdentifier());
     }
 
     template<typename ResourceType>
-    static SharedPointer<ResourceType> getCachedResource(const std::string& identifier) {
+    static SharedPointer<ResourceType> getCachedResource(const ResourceID& identifier) {
         Resource::cleanup();
-        auto id = Resource::splitResourceIdentifier(identifier);
-        const std::string& provider = id.first, name = id.second;
-        if (Resource::resources[provider].count(name) > 0) {
-            return Resource::resources[provider][name].cast<ResourceType>();
+        Resource::finishPendingResource(identifier);
+        if (auto cached = Resource::resources.find(identifier)) {
+            return cached.template cast<ResourceType>();
         }
-        Resource::logResourceError("error.resource.cached_resource_not_found", identifier);
+        Resource::logResourceError("error.resource.cached_resource_not_found", identifier.getIdentifier());
         if (Resource::hasDefaultResource<ResourceType>())
             return Resource::getDefaultResource<ResourceType>();
         return SharedPointer<ResourceType>{};
     }
 
+    /// Loads every resource listed in a manifest into the cache, as many at once as their dependencies allow.
+    /// A manifest is a JSON file like {"resources": [{"type": "Texture", "identifier": "file://...", "dependencies": ["file://..."]}]}.
+    /// Types are the names given to CHIRA_REGISTER_RESOURCE_TYPE. Dependencies must be listed in the same manifest,
+    /// anything else is loaded when the resource that needs it is compiled, like usual.
+    /// onProgress is called on this thread with the number of resources loaded so far and the total.
+    /// Returns false if the manifest could not be read or its dependencies form a cycle.
+    static bool precacheManifest(const ResourceID& manifest, const std::function<void(std::size_t, std::size_t)>& onProgress = {});
+    static bool precacheManifestFromJSON(const nlohmann::json& manifest, const std::function<void(std::size_t, std::size_t)>& onProgress = {});
+
+    /// Lets manifests refer to the type by name.
+    template<typename ResourceType>
+    static bool registerResourceType(const std::string& typeName) {
+        Resource::getResourceTypeLoaders()[typeName] = [](const ResourceID& identifier) {
+            std::ignore = Resource::getResourceAsync<ResourceType>(identifier);
+        };
+        return true;
+    }
+
+    /// Loads the resource again, replacing the cached copy if there is one.
     template<typename ResourceType, typename... Params>
-    static SharedPointer<ResourceType> getUniqueResource(const std::string& identifier, Params... params) {
-        auto id = Resource::splitResourceIdentifier(identifier);
-        const std::string& provider = id.first, name = id.second;
-        for (auto i = Resource::providers[provider].rbegin(); i != Resource::providers[provider].rend(); i++) {
-            if ((*i)->hasResource(name)) {
-                Resource::resources[provider][name] = SharedPointer<Resource>(new ResourceType{identifier, std::forward<Params>(params)...});
-                (*i)->compileResource(name, Resource::resources[provider][name].get());
-                return Resource::resources[provider][name].template cast<ResourceType>();
-            }
+    static SharedPointer<ResourceType> getUniqueResource(const ResourceID& identifier, Params... params) {
+        if (auto resource = Resource::loadResource<ResourceType>(identifier, std::forward<Params>(params)...)) {
+            Resource::resources.insertOrAssign(identifier, resource);
+            return resource.template cast<ResourceType>();
         }
-        Resource::logResourceError("error.resource.resource_not_found", identifier);
+        Resource::logResourceError("error.resource.resource_not_found", identifier.getIdentifier());
         if (Resource::hasDefaultResource<ResourceType>())
             return Resource::getDefaultResource<ResourceType>();
         return SharedPointer<ResourceType>{};
@@ -107,19 +257,14 @@ public:
 
     /// You might want to use this sparingly as it defeats the entire point of a cached, shared resource system.
     template<typename ResourceType, typename... Params>
-    static SharedPointer<ResourceType> getUniqueUncachedResource(const std::string& identifier, Params... params) {
-        auto id = Resource::splitResourceIdentifier(identifier);
-        const std::string& provider = id.first, name = id.second;
-        for (auto i = Resource::providers[provider].rbegin(); i != Resource::providers[provider].rend(); i++) {
-            if ((*i)->hasResource(name)) {
-                auto resource = SharedPointer<ResourceType>(new ResourceType{identifier, std::forward<Params>(params)...});
-                (*i)->compileResource(name, resource.get());
-                // We're not holding onto this
-                resource.setHolderAmountForDelete(0);
-                return resource;
-            }
+    static SharedPointer<ResourceType> getUniqueUncachedResource(const ResourceID& identifier, Params... params) {
+        double lookupTime;
+        if (auto* provider = Resource::findResourceProvider(identifier, &lookupTime)) {
+            auto resource = SharedPointer<ResourceType>::make(identifier, std::forward<Params>(params)...);
+            Resource::compileFromProvider(resource.get(), provider, lookupTime);
+            return resource;
         }
-        Resource::logResourceError("error.resource.resource_not_found", identifier);
+        Resource::logResourceError("error.resource.resource_not_found", identifier.getIdentifier());
         return SharedPointer<ResourceType>{};
     }
 
@@ -132,37 +277,65 @@ public:
         return resource;
     }
 
-    static std::pair<std::string, std::string> splitResourceIdentifier(const std::string& identifier);
-
-    static const std::vector<std::unique_ptr<IResourceProvider>>& getResourceProviders(const std::string& providerName);
+    static const std::vector<std::unique_ptr<IResourceProvider>>& getResourceProviders(std::string_view providerName);
 
-    static bool hasResource(const std::string& identifier);
+    static bool hasResource(const ResourceID& identifier);
 
-    /// If resource is present in the cache and has a reference count less than or equal to 2, mark it for removal.
-    static void removeResource(const std::string& identifier);
+    /// Marks the resource for removal. The cache stops keeping it alive, so it is freed along with its last user.
+    /// Until then it is still shared with anything that requests it.
+    static void removeResource(const ResourceID& identifier);
 
-    /// Delete all resources marked for removal.
+    /// Releases all resources marked for removal.
     static void cleanup();
 
+    /// The sum of getMemoryUsage() over every cached resource. Released resources count until update() finds they were freed.
+    [[nodiscard]] static std::size_t getCachedMemoryUsage();
+
+    [[nodiscard]] static std::vector<CachedResourceInfo> getCachedResourceInfo();
+
+    /// Writes getCachedResourceInfo() to a JSON file. Returns false if the file could not be written.
+    static bool exportCachedResourceInfo(const std::string& path);
+
+    /// Frees cached resources nothing else holds onto, least recently used first, until the cache fits in the budget.
+    /// Resources that are still in use are never freed, so the cache can stay over budget.
+    static void evictUnusedResources(std::size_t memoryBudget);
+
+    /// If false (see res_keep_cpu_copies), assets free their CPU-side data once it is uploaded to the GPU.
+    [[nodiscard]] static bool shouldKeepCPUCopies();
+
+    /// Moves asynchronously loaded resources that have finished into the cache, then evicts unused
+    /// resources if the cache is over res_memory_budget. Called once per frame.
+    static void update();
+
+    /// Blocks until the given resource is done loading asynchronously, then moves it into the cache.
+    /// Does nothing if the resource is not being loaded asynchronously.
+    static void finishPendingResource(const ResourceID& identifier);
+
     /// Deletes ALL resources and providers. Should only ever be called once, when the program closes.
     static void discardAll();
 
     template<typename ResourceType>
-    static bool registerDefaultResource(const std::string& identifier) {
+    static bool registerDefaultResource(const ResourceID& identifier) {
         Resource::getDefaultResourceConstructors()[typeHash<ResourceType>()] = [identifier] {
-            Resource::defaultResources[typeHash<ResourceType>()] = Resource::getUniqueResource<ResourceType>(identifier).template cast<Resource>();
+            auto resource = Resource::getUniqueResource<ResourceType>(identifier).template cast<Resource>();
+            std::unique_lock lock{Resource::defaultResourcesMutex};
+            Resource::defaultResources[typeHash<ResourceType>()] = std::move(resource);
         };
         return true;
     }
 
     template<typename ResourceType>
     static bool hasDefaultResource() {
+        std::shared_lock lock{Resource::defaultResourcesMutex};
         return Resource::defaultResources.contains(typeHash<ResourceType>());
     }
 
     template<typename ResourceType>
     static SharedPointer<ResourceType> getDefaultResource() {
-        return Resource::defaultResources[typeHash<ResourceType>()].template cast<ResourceType>();
+        std::shared_lock lock{Resource::defaultResourcesMutex};
+        if (auto resource = Resource::defaultResources.find(typeHash<ResourceType>()); resource != Resource::defaultResources.end())
+            return resource->second.template cast<ResourceType>();
+        return SharedPointer<ResourceType>{};
     }
 
     static void createDefaultResources() {
@@ -172,18 +345,86 @@ public:
     }
 
 protected:
-    static inline std::unordered_map<std::string, std::vector<std::unique_ptr<IResourceProvider>>> providers;
-    static inline std::unordered_map<std::string, std::unordered_map<std::string, SharedPointer<Resource>>> resources;
+    /// Keyed by the hash of the provider name. Providers are only ever added, so pointers to them stay valid.
+    static inline std::unordered_map<std::uint64_t, std::vector<std::unique_ptr<IResourceProvider>>> providers;
+    static inline std::shared_mutex providersMutex;
+    static inline ResourceCache resources;
     static inline std::unordered_map<std::type_index, SharedPointer<Resource>> defaultResources;
-    static inline std::vector<std::string> garbageResources;
+    static inline std::shared_mutex defaultResourcesMutex;
+    static inline std::vector<ResourceID> garbageResources;
+    static inline std::mutex garbageResourcesMutex;
+    static inline std::unordered_map<ResourceID, std::shared_ptr<PendingResourceLoad>, ResourceID::Hasher> pendingResources;
+    static inline std::mutex pendingResourcesMutex;
+    /// Contents read ahead of time in a batch, taken when the resource starts loading. Guarded by pendingResourcesMutex.
+    static inline std::unordered_map<ResourceID, PrereadResource, ResourceID::Hasher> prereadViews;
+
+    static const std::vector<std::unique_ptr<IResourceProvider>>& getProviders(std::uint64_t providerHash);
+
+    /// The newest provider that has the resource, or nullptr. Doesn't log anything.
+    /// If lookupTime is given, it is set to how long the search took in milliseconds.
+    static IResourceProvider* findResourceProvider(const ResourceID& identifier, double* lookupTime = nullptr);
+
+    /// Reads the resource from the provider and compiles it, recording how long each step took.
+    static void compileFromProvider(Resource* resource, const IResourceProvider* provider, double providerLookupTime);
+
+    /// Makes and compiles the resource without touching the cache. Returns an empty pointer if no provider has it.
+    template<typename ResourceType, typename... Params>
+    static SharedPointer<Resource> loadResource(const ResourceID& identifier, Params... params) {
+        double lookupTime;
+        auto* provider = Resource::findResourceProvider(identifier, &lookupTime);
+        if (!provider)
+            return SharedPointer<Resource>{};
+        auto resource = SharedPointer<ResourceType>::make(identifier, std::forward<Params>(params)...);
+        Resource::compileFromProvider(resource.get(), provider, lookupTime);
+        return resource;
+    }
+
+    /// Must be called with pendingResourcesMutex held.
+    static void startPendingResource(const std::shared_ptr<PendingResourceLoad>& load, const IResourceProvider* provider);
+    static void publishPendingResource(std::shared_ptr<PendingResourceLoad> load);
+    /// Reads uncached resources together, one batch per provider, so they don't have to be read one at a time when they start loading.
+    /// Providers without batched reads are skipped, their resources are read on the loading pool as usual.
+    static void prereadResources(const std::vector<ResourceID>& identifiers);
 
     static auto getDefaultResourceConstructors() -> std::unordered_map<std::type_index, std::function<void()>>& {
         static std::unordered_map<std::type_index, std::function<void()>> defaultResourceConstructors;
         return defaultResourceConstructors;
     }
 
+    /// Each function starts loading a resource of the type asynchronously
+    static auto getResourceTypeLoaders() -> std::unordered_map<std::string, std::function<void(const ResourceID&)>>& {
+        static std::unordered_map<std::string, std::function<void(const ResourceID&)>> resourceTypeLoaders;
+        return resourceTypeLoaders;
+    }
+
     /// We do a few predeclaration workarounds
-    static void logResourceError(const std::string& identifier, const std::string& resourceName);
+    static void logResourceError(const std::string& translationKey, std::string_view resourceName);
+};
+
+/// A handle to a resource that may still be loading. Only use this on the main thread.
+template<typename ResourceType>
+class PendingResource {
+public:
+    explicit PendingResource(std::shared_ptr<PendingResourceLoad> load_) : load(std::move(load_)) {}
+
+    /// True once the resource has been compiled and put in the cache.
+    [[nodiscard]] bool isReady() const {
+        return this->load->published;
+    }
+
+    /// Returns the resource, finishing the load on this thread if it is not ready yet.
+    [[nodiscard]] SharedPointer<ResourceType> get() const {
+        if (!this->load->published) {
+            Resource::finishPendingResource(this->load->identifier);
+        }
+        return this->load->resource.template cast<ResourceType>();
+    }
+
+    [[nodiscard]] std::string_view getIdentifier() const {
+        return this->load->identifier.getIdentifier();
+    }
+private:
+    std::shared_ptr<PendingResourceLoad> load;
 };
 
 } // namespace chira
@@ -191,3 +432,7 @@ protected:
 #define CHIRA_REGISTER_DEFAULT_RESOURCE(type, identifier) \
     static inline const auto type##DefaultResourceRegistryHelper = \
         chira::Resource::registerDefaultResource<type>(identifier)
+
+#define CHIRA_REGISTER_RESOURCE_TYPE(type) \
+    static inline const auto type##ResourceTypeRegistryHelper = \
+        chira::Resource::registerResourceType<type>(#type)
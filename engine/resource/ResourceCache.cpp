@@ -0,0 +1,201 @@
+#include "ResourceCache.h"
+
+#include <algorithm>
+#include <mutex>
+#include "Resource.h"
+
+using namespace chira;
+
+ResourceCache::ResourceCache() = default;
+
+ResourceCache::~ResourceCache() = default;
+
+SharedPointer<Resource> ResourceCache::find(const ResourceID& identifier) {
+    SharedPointer<Resource> resource;
+    {
+        auto& shard = this->getShard(identifier);
+        std::shared_lock lock{shard.mutex};
+        auto cached = shard.entries.find(identifier);
+        if (cached == shard.entries.end())
+            return resource;
+        resource = cached->second.resource.lock();
+        if (resource)
+            cached->second.lastUsed.store(++this->useCounter, std::memory_order_relaxed);
+    }
+    return resource;
+}
+
+bool ResourceCache::contains(const ResourceID& identifier) const {
+    const auto& shard = this->getShard(identifier);
+    std::shared_lock lock{shard.mutex};
+    auto cached = shard.entries.find(identifier);
+    return cached != shard.entries.end() && !cached->second.resource.expired();
+}
+
+SharedPointer<Resource> ResourceCache::insert(const ResourceID& identifier, SharedPointer<Resource> resource) {
+    auto& shard = this->getShard(identifier);
+    const auto memoryUsage_ = resource->getMemoryUsage();
+    SharedPointer<Resource> existing;
+    {
+        std::unique_lock lock{shard.mutex};
+        auto [cached, inserted] = shard.entries.try_emplace(identifier, resource, ++this->useCounter, memoryUsage_);
+        if (inserted) {
+            this->memoryUsage.fetch_add(memoryUsage_, std::memory_order_relaxed);
+            return resource;
+        }
+        existing = cached->second.resource.lock();
+        if (!existing) {
+            // The old resource was released and freed, its entry just hasn't been cleaned up yet
+            this->releasedCount.fetch_sub(1, std::memory_order_relaxed);
+            cached->second.resource = resource;
+            cached->second.retained = resource;
+            cached->second.lastUsed.store(++this->useCounter, std::memory_order_relaxed);
+            this->recount(cached->second, memoryUsage_);
+        }
+    }
+    return existing ? existing : resource;
+}
+
+void ResourceCache::insertOrAssign(const ResourceID& identifier, SharedPointer<Resource> resource) {
+    auto& shard = this->getShard(identifier);
+    const auto memoryUsage_ = resource->getMemoryUsage();
+    std::unique_lock lock{shard.mutex};
+    if (auto cached = shard.entries.find(identifier); cached != shard.entries.end()) {
+        if (!cached->second.retained)
+            this->releasedCount.fetch_sub(1, std::memory_order_relaxed);
+        cached->second.resource = resource;
+        // Swap so the old resource is destroyed after the lock is released
+        std::swap(cached->second.retained, resource);
+        cached->second.lastUsed.store(++this->useCounter, std::memory_order_relaxed);
+        this->recount(cached->second, memoryUsage_);
+        lock.unlock();
+        return;
+    }
+    shard.entries.try_emplace(identifier, std::move(resource), ++this->useCounter, memoryUsage_);
+    this->memoryUsage.fetch_add(memoryUsage_, std::memory_order_relaxed);
+}
+
+SharedPointer<Resource> ResourceCache::erase(const ResourceID& identifier) {
+    auto& shard = this->getShard(identifier);
+    std::unique_lock lock{shard.mutex};
+    auto cached = shard.entries.find(identifier);
+    if (cached == shard.entries.end())
+        return SharedPointer<Resource>{};
+    if (!cached->second.retained)
+        this->releasedCount.fetch_sub(1, std::memory_order_relaxed);
+    auto resource = cached->second.retained ? std::move(cached->second.retained) : cached->second.resource.lock();
+    this->memoryUsage.fetch_sub(cached->second.memoryUsage, std::memory_order_relaxed);
+    shard.entries.erase(cached);
+    return resource;
+}
+
+SharedPointer<Resource> ResourceCache::eraseIfUnused(const ResourceID& identifier) {
+    auto& shard = this->getShard(identifier);
+    std::unique_lock lock{shard.mutex};
+    auto cached = shard.entries.find(identifier);
+    // Nobody can copy the pointer out of the cache while the shard is locked
+    if (cached == shard.entries.end() || !cached->second.retained || cached->second.retained.useCount() != 1)
+        return SharedPointer<Resource>{};
+    auto resource = std::move(cached->second.retained);
+    this->memoryUsage.fetch_sub(cached->second.memoryUsage, std::memory_order_relaxed);
+    shard.entries.erase(cached);
+    return resource;
+}
+
+SharedPointer<Resource> ResourceCache::release(const ResourceID& identifier) {
+    auto& shard = this->getShard(identifier);
+    std::unique_lock lock{shard.mutex};
+    auto cached = shard.entries.find(identifier);
+    if (cached == shard.entries.end() || !cached->second.retained)
+        return SharedPointer<Resource>{};
+    this->onReleased();
+    return std::move(cached->second.retained);
+}
+
+void ResourceCache::updateMemoryUsage(const ResourceID& identifier, const Resource* resource) {
+    auto& shard = this->getShard(identifier);
+    const auto memoryUsage_ = resource->getMemoryUsage();
+    SharedPointer<Resource> cachedResource;
+    {
+        std::unique_lock lock{shard.mutex};
+        auto cached = shard.entries.find(identifier);
+        if (cached == shard.entries.end())
+            return;
+        // Might be the last reference if the resource was released, so it's dropped after unlocking
+        cachedResource = cached->second.resource.lock();
+        if (cachedResource.get() == resource)
+            this->recount(cached->second, memoryUsage_);
+    }
+}
+
+void ResourceCache::eraseExpired() {
+    if (this->releasedCount.load(std::memory_order_relaxed) == 0)
+        return;
+    for (auto& shard : this->shards) {
+        std::unique_lock lock{shard.mutex};
+        std::erase_if(shard.entries, [this](const auto& entry) {
+            if (!entry.second.resource.expired())
+                return false;
+            this->releasedCount.fetch_sub(1, std::memory_order_relaxed);
+            this->memoryUsage.fetch_sub(entry.second.memoryUsage, std::memory_order_relaxed);
+            return true;
+        });
+    }
+}
+
+std::vector<std::pair<ResourceID, SharedPointer<Resource>>> ResourceCache::takeAll() {
+    std::vector<std::pair<ResourceID, SharedPointer<Resource>>> all;
+    for (auto& shard : this->shards) {
+        std::unique_lock lock{shard.mutex};
+        for (auto& [identifier, entry] : shard.entries) {
+            if (!entry.retained)
+                this->releasedCount.fetch_sub(1, std::memory_order_relaxed);
+            this->memoryUsage.fetch_sub(entry.memoryUsage, std::memory_order_relaxed);
+            if (auto resource = entry.retained ? std::move(entry.retained) : entry.resource.lock())
+                all.emplace_back(identifier, std::move(resource));
+        }
+        shard.entries.clear();
+    }
+    return all;
+}
+
+std::vector<ResourceID> ResourceCache::getUnusedResources() const {
+    std::vector<std::pair<std::uint64_t, ResourceID>> unused;
+    for (const auto& shard : this->shards) {
+        std::shared_lock lock{shard.mutex};
+        for (const auto& [identifier, entry] : shard.entries) {
+            if (entry.retained && entry.retained.useCount() == 1)
+                unused.emplace_back(entry.lastUsed.load(std::memory_order_relaxed), identifier);
+        }
+    }
+    std::sort(unused.begin(), unused.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+    std::vector<ResourceID> identifiers;
+    identifiers.reserve(unused.size());
+    for (const auto& candidate : unused) {
+        identifiers.push_back(candidate.second);
+    }
+    return identifiers;
+}
+
+std::size_t ResourceCache::size() const {
+    std::size_t total = 0;
+    for (const auto& shard : this->shards) {
+        std::shared_lock lock{shard.mutex};
+        total += shard.entries.size();
+    }
+    return total;
+}
+
+void ResourceCache::recount(Entry& entry, std::size_t newMemoryUsage) {
+    // Add first so the total doesn't wrap around in between
+    this->memoryUsage.fetch_add(newMemoryUsage, std::memory_order_relaxed);
+    this->memoryUsage.fetch_sub(entry.memoryUsage, std::memory_order_relaxed);
+    entry.memoryUsage = newMemoryUsage;
+}
+
+void ResourceCache::onReleased() {
+    this->releasedCount.fetch_add(1, std::memory_order_relaxed);
+    this->releasedSinceCheck.store(true, std::memory_order_relaxed);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include <utility/NoCopyOrMove.h>
+#include <utility/SharedPointer.h>
+#include "ResourceID.h"
+
+namespace chira {
+
+class Resource;
+
+/// The map of every cached resource, safe to use from any thread.
+/// Split into shards by identifier hash, each behind its own reader-writer lock,
+/// so lookups only contend with insertions into the same shard.
+/// Entries only hold weak references. The cache also keeps a strong reference to each resource, which is
+/// dropped when the resource is released or evicted, after which it lives exactly as long as its last user.
+/// Resources are never destroyed while a shard is locked, their destructors are free to use the cache.
+class ResourceCache : public NoCopyOrMove {
+public:
+    static constexpr std::size_t SHARD_COUNT = 16;
+    static_assert((SHARD_COUNT & (SHARD_COUNT - 1)) == 0, "Shard count must be a power of two!");
+
+    ResourceCache();
+    ~ResourceCache();
+
+    /// Returns the cached resource and marks it as recently used, or an empty pointer.
+    /// Released resources are still found as long as something else keeps them alive.
+    [[nodiscard]] SharedPointer<Resource> find(const ResourceID& identifier);
+    [[nodiscard]] bool contains(const ResourceID& identifier) const;
+    /// If another thread cached a live resource with the same identifier first, that one is kept and returned.
+    SharedPointer<Resource> insert(const ResourceID& identifier, SharedPointer<Resource> resource);
+    /// Replaces any resource already cached with the same identifier.
+    void insertOrAssign(const ResourceID& identifier, SharedPointer<Resource> resource);
+    /// Returns the removed resource, if it was cached.
+    SharedPointer<Resource> erase(const ResourceID& identifier);
+    /// Removes the resource only if the cache is its last holder. Returns the removed resource, if any.
+    SharedPointer<Resource> eraseIfUnused(const ResourceID& identifier);
+    /// Drops the cache's strong reference, the resource is freed along with its last user.
+    /// Returns the dropped reference, if the cache was holding one.
+    SharedPointer<Resource> release(const ResourceID& identifier);
+    /// Records the resource's current memory usage, for when it changes after the resource was cached.
+    /// Does nothing if a different resource is cached under the identifier.
+    void updateMemoryUsage(const ResourceID& identifier, const Resource* resource);
+    /// Removes entries whose resources were already freed. Free if nothing was released.
+    void eraseExpired();
+    /// True if a resource was released since the last call. Released resources are freed by their last user,
+    /// so their entries only expire some time after this.
+    [[nodiscard]] bool takeReleased() {
+        return this->releasedSinceCheck.exchange(false, std::memory_order_relaxed);
+    }
+    /// Removes every resource and returns the live ones.
+    [[nodiscard]] std::vector<std::pair<ResourceID, SharedPointer<Resource>>> takeAll();
+
+    /// Identifiers of resources only held by the cache itself, least recently used first.
+    [[nodiscard]] std::vector<ResourceID> getUnusedResources() const;
+    /// The sum of Resource::getMemoryUsage() over every cached resource, kept up to date as resources come and go.
+    /// Released resources count until their entries are removed by eraseExpired().
+    [[nodiscard]] std::size_t getMemoryUsage() const {
+        return this->memoryUsage.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] std::size_t size() const;
+
+    /// Calls func(identifier, resource) for every live cached resource. Shards are locked one at a time,
+    /// so func must not insert or erase resources.
+    template<typename F>
+    void forEach(F&& func) const {
+        std::vector<SharedPointer<Resource>> released;
+        for (const auto& shard : this->shards) {
+            {
+                std::shared_lock lock{shard.mutex};
+                for (const auto& [identifier, entry] : shard.entries) {
+                    if (entry.retained) {
+                        func(identifier, entry.retained);
+                    } else if (auto resource = entry.resource.lock()) {
+                        func(identifier, resource);
+                        // This might be the last reference by now, free it after unlocking
+                        released.push_back(std::move(resource));
+                    }
+                }
+            }
+            released.clear();
+        }
+    }
+
+private:
+    struct Entry {
+        explicit Entry(SharedPointer<Resource> resource_, std::uint64_t lastUsed_, std::size_t memoryUsage_)
+                : resource(resource_)
+                , retained(std::move(resource_))
+                , lastUsed(lastUsed_)
+                , memoryUsage(memoryUsage_) {}
+        WeakPointer<Resource> resource;
+        /// Empty once the resource is released or evicted
+        SharedPointer<Resource> retained;
+        /// Bumped under a shared lock, so it needs to be atomic
+        std::atomic<std::uint64_t> lastUsed;
+        /// What the resource reported when it was cached or last updated, counted in the cache's total
+        std::size_t memoryUsage;
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<ResourceID, Entry, ResourceID::Hasher> entries;
+    };
+
+    [[nodiscard]] Shard& getShard(const ResourceID& identifier) {
+        // The low bits pick the bucket inside the shard, use the high bits here
+        return this->shards[(identifier.getHash() >> 32) & (SHARD_COUNT - 1)];
+    }
+    [[nodiscard]] const Shard& getShard(const ResourceID& identifier) const {
+        return this->shards[(identifier.getHash() >> 32) & (SHARD_COUNT - 1)];
+    }
+
+    /// Adds the size of the resource now in the entry to the total, and takes away what was counted before.
+    void recount(Entry& entry, std::size_t newMemoryUsage);
+    /// The entry lost its strong reference.
+    void onReleased();
+
+    std::atomic<std::uint64_t> useCounter = 0;
+    std::atomic<std::size_t> memoryUsage = 0;
+    /// Entries that only hold weak references
+    std::atomic<std::size_t> releasedCount = 0;
+    std::atomic<bool> releasedSinceCheck = false;
+    std::array<Shard, SHARD_COUNT> shards;
+};
+
+} // namespace chira
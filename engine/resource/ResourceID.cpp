@@ -0,0 +1,37 @@
+#include "ResourceID.h"
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+#include <core/Logger.h>
+#include <i18n/TranslationManager.h>
+
+using namespace chira;
+
+CHIRA_CREATE_LOG(RESOURCEID);
+
+namespace {
+
+/// Interned strings are never freed, there's only so many resources a program can name.
+/// Elements of an unordered_set never move, so views into them stay valid.
+std::string_view intern(std::string_view identifier) {
+    static std::unordered_set<std::string, TransparentStringHash, std::equal_to<>> internedIdentifiers;
+    static std::shared_mutex internedIdentifiersMutex;
+    {
+        std::shared_lock lock{internedIdentifiersMutex};
+        if (auto interned = internedIdentifiers.find(identifier); interned != internedIdentifiers.end()) {
+            return *interned;
+        }
+    }
+    std::unique_lock lock{internedIdentifiersMutex};
+    return *internedIdentifiers.emplace(identifier).first;
+}
+
+} // namespace
+
+ResourceID::ResourceID(std::string_view identifier_) {
+    this->assign(intern(identifier_));
+    if (!this->isValid()) {
+        LOG_RESOURCEID.error(TRF("error.resource.cannot_split_identifier", identifier_));
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility/Hash.h>
+
+namespace chira {
+
+constexpr std::string_view RESOURCE_ID_SEPARATOR = "://";
+
+/// Identifies a resource as "provider://name". The identifier is split and hashed once, when the ID is made.
+/// IDs made from string literals are built at compile time and point at the literal.
+/// Any other ID interns its string, so copying and comparing IDs never allocates.
+class ResourceID {
+public:
+    constexpr ResourceID() = default;
+
+    template<std::size_t N>
+    consteval ResourceID(const char (&identifier_)[N]) { // NOLINT(google-explicit-constructor)
+        this->assign(std::string_view{identifier_, N - 1});
+    }
+
+    template<typename T>
+    requires std::same_as<T, const char*> || std::same_as<T, char*>
+    ResourceID(T identifier_) : ResourceID(std::string_view{identifier_}) {} // NOLINT(google-explicit-constructor)
+
+    ResourceID(const std::string& identifier_) : ResourceID(std::string_view{identifier_}) {} // NOLINT(google-explicit-constructor)
+
+    /// Interns the identifier, the string passed in does not need to outlive the ID.
+    ResourceID(std::string_view identifier_); // NOLINT(google-explicit-constructor)
+
+    [[nodiscard]] constexpr std::string_view getIdentifier() const {
+        return this->identifier;
+    }
+    [[nodiscard]] constexpr std::string_view getProvider() const {
+        return this->isValid() ? this->identifier.substr(0, this->separator) : std::string_view{};
+    }
+    [[nodiscard]] constexpr std::string_view getName() const {
+        return this->isValid() ? this->identifier.substr(this->separator + RESOURCE_ID_SEPARATOR.length()) : std::string_view{};
+    }
+    [[nodiscard]] constexpr std::uint64_t getHash() const {
+        return this->hash;
+    }
+    [[nodiscard]] constexpr std::uint64_t getProviderHash() const {
+        return this->providerHash;
+    }
+    /// False if the identifier has no provider separator.
+    [[nodiscard]] constexpr bool isValid() const {
+        return this->separator != std::string_view::npos;
+    }
+
+    [[nodiscard]] constexpr bool operator==(const ResourceID& other) const {
+        return this->hash == other.hash && this->identifier == other.identifier;
+    }
+
+    struct Hasher {
+        std::size_t operator()(const ResourceID& id) const {
+            return static_cast<std::size_t>(id.getHash());
+        }
+    };
+
+private:
+    constexpr void assign(std::string_view identifier_) {
+        this->identifier = identifier_;
+        this->hash = hashFNV1a(identifier_);
+        this->separator = identifier_.find(RESOURCE_ID_SEPARATOR);
+        this->providerHash = hashFNV1a(this->getProvider());
+    }
+
+    std::string_view identifier;
+    std::uint64_t hash = hashFNV1a("");
+    std::uint64_t providerHash = hashFNV1a("");
+    std::size_t separator = std::string_view::npos;
+};
+
+} // namespace chira
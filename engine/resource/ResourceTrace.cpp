@@ -0,0 +1,152 @@
+#include "ResourceTrace.h"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <config/Config.h>
+#include <config/ConEntry.h>
+#include <core/Logger.h>
+#include <i18n/TranslationManager.h>
+#include "Resource.h"
+
+using namespace chira;
+
+CHIRA_CREATE_LOG(RESOURCETRACE);
+
+[[maybe_unused]]
+ConVar res_trace_record{"res_trace_record", false, "Record which resources are requested this session, so the next session can prefetch them.", CON_FLAG_CACHE, [](ConVar::CallbackArg newValue) {
+    ResourceTrace::setRecording(std::stoi(newValue.data()));
+}};
+
+[[maybe_unused]]
+ConVar res_trace_prefetch{"res_trace_prefetch", true, "Read the resources the last recorded session requested in the background at startup.", CON_FLAG_CACHE};
+
+namespace {
+
+struct TraceEntry {
+    ResourceID identifier;
+    std::uint64_t frame;
+};
+
+std::atomic<bool> recording = false;
+std::atomic<std::uint64_t> currentFrame = 0;
+std::mutex traceMutex;
+std::vector<TraceEntry> trace;
+std::unordered_set<ResourceID, ResourceID::Hasher> traced;
+
+std::thread prefetcher;
+std::atomic<bool> stopPrefetcher = false;
+
+/// Bringing a memory-mapped file into memory one page at a time is what actually reads it from disk
+void touchPages(const ResourceView& view) {
+    constexpr std::size_t pageSize = 4096;
+    volatile byte sink = 0;
+    for (std::size_t i = 0; i < view.getSize(); i += pageSize) {
+        sink = sink + view.getData()[i];
+    }
+}
+
+} // namespace
+
+void ResourceTrace::begin() {
+    ResourceTrace::setRecording(res_trace_record.getValue<bool>());
+    if (res_trace_prefetch.getValue<bool>())
+        ResourceTrace::prefetch(ResourceTrace::getDefaultPath());
+}
+
+void ResourceTrace::end() {
+    ResourceTrace::stopPrefetching();
+    if (ResourceTrace::isRecording()) {
+        ResourceTrace::setRecording(false);
+        ResourceTrace::save(ResourceTrace::getDefaultPath());
+    }
+}
+
+bool ResourceTrace::isRecording() {
+    return recording.load(std::memory_order_relaxed);
+}
+
+void ResourceTrace::setRecording(bool record) {
+    recording.store(record, std::memory_order_relaxed);
+}
+
+void ResourceTrace::recordRequest(const ResourceID& identifier) {
+    if (!ResourceTrace::isRecording())
+        return;
+    std::scoped_lock lock{traceMutex};
+    if (traced.insert(identifier).second)
+        trace.push_back({identifier, currentFrame.load(std::memory_order_relaxed)});
+}
+
+void ResourceTrace::nextFrame() {
+    currentFrame.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool ResourceTrace::save(const std::string& path) {
+    nlohmann::json requests = nlohmann::json::array();
+    {
+        std::scoped_lock lock{traceMutex};
+        for (const auto& entry : trace) {
+            requests.push_back({
+                {"identifier", entry.identifier.getIdentifier()},
+                {"frame", entry.frame},
+            });
+        }
+    }
+    std::ofstream output{path};
+    if (output)
+        output << nlohmann::json{{"requests", requests}}.dump(4);
+    if (!output.good()) {
+        LOG_RESOURCETRACE.error(TRF("error.resource_trace.cannot_write", path));
+        return false;
+    }
+    return true;
+}
+
+bool ResourceTrace::prefetch(const std::string& path) {
+    ResourceTrace::stopPrefetching();
+
+    std::ifstream input{path};
+    if (!input)
+        return false; // Nothing was recorded yet
+    const auto traceJSON = nlohmann::json::parse(input, nullptr, false);
+    if (traceJSON.is_discarded() || !traceJSON.contains("requests") || !traceJSON["requests"].is_array()) {
+        LOG_RESOURCETRACE.error(TRF("error.resource_trace.invalid", path));
+        return false;
+    }
+    std::vector<ResourceID> identifiers;
+    for (const auto& request : traceJSON["requests"]) {
+        if (request.contains("identifier") && request["identifier"].is_string())
+            identifiers.emplace_back(request["identifier"].get<std::string>());
+    }
+    LOG_RESOURCETRACE.info(TRF("debug.resource_trace.prefetching", identifiers.size()));
+
+    stopPrefetcher = false;
+    prefetcher = std::thread{[identifiers = std::move(identifiers)] {
+        for (const auto& identifier : identifiers) {
+            if (stopPrefetcher)
+                return;
+            // Resources the main thread got to first are already in memory
+            if (Resource::resources.contains(identifier))
+                continue;
+            if (const auto* provider = Resource::findResourceProvider(identifier))
+                touchPages(provider->readResource(identifier.getName()));
+        }
+    }};
+    return true;
+}
+
+void ResourceTrace::stopPrefetching() {
+    stopPrefetcher = true;
+    if (prefetcher.joinable())
+        prefetcher.join();
+}
+
+std::string ResourceTrace::getDefaultPath() {
+    return Config::getConfigFile("resource_trace.json");
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include "ResourceID.h"
+
+namespace chira {
+
+/// Records which resources a session requests, in order and at which frame, so the next session
+/// can read them ahead of time on a background thread. Controlled by res_trace_record and res_trace_prefetch.
+class ResourceTrace {
+public:
+    ResourceTrace() = delete;
+
+    /// Starts recording and prefetching as configured. Call once the resource providers are mounted.
+    static void begin();
+    /// Stops prefetching and writes the trace if one was being recorded. Call before the providers are discarded.
+    static void end();
+
+    [[nodiscard]] static bool isRecording();
+    static void setRecording(bool recording);
+
+    /// Called by Resource whenever a resource is requested. Only the first request for each resource is kept.
+    static void recordRequest(const ResourceID& identifier);
+    /// Called by Resource::update() once per frame.
+    static void nextFrame();
+
+    /// Writes what was recorded so far to a JSON file. Returns false if it could not be written.
+    static bool save(const std::string& path);
+    /// Starts reading every resource in the trace in order on a background thread, so the OS has them cached
+    /// by the time they are requested. Nothing is compiled. Returns false if the trace could not be read.
+    static bool prefetch(const std::string& path);
+    /// Stops prefetching and waits for the background thread to finish.
+    static void stopPrefetching();
+
+    /// The trace lives in the config directory.
+    [[nodiscard]] static std::string getDefaultPath();
+};
+
+} // namespace chira
@@ -5,7 +5,14 @@
 using namespace chira;
 
 void StringResource::compile(const byte buffer[], std::size_t bufferLength) {
-    this->data = {reinterpret_cast<const char*>(buffer), bufferLength};
+    // Don't include the null terminator, an empty buffer doesn't even have one
+    this->data = {reinterpret_cast<const char*>(buffer), bufferLength ? bufferLength - 1 : 0};
+    String::replace(this->data, "\r\n", "\n");
+}
+
+void StringResource::compileView(const ResourceView& view) {
+    // The string gets its own null terminator, so there's no need for a terminated copy
+    this->data = {reinterpret_cast<const char*>(view.getData()), view.getSize()};
     String::replace(this->data, "\r\n", "\n");
 }
 
@@ -6,11 +6,20 @@ namespace chira {
 
 class StringResource : public Resource {
 public:
-    explicit StringResource(std::string identifier_) : Resource(std::move(identifier_)) {}
+    explicit StringResource(ResourceID identifier_) : Resource(identifier_) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
+    void compileView(const ResourceView& view) override;
+    [[nodiscard]] bool isThreadSafeToCompile() const override {
+        return true;
+    }
+    [[nodiscard]] std::size_t getCPUMemoryUsage() const override {
+        return this->data.capacity();
+    }
     [[nodiscard]] const std::string& getString() const;
 protected:
     std::string data;
+private:
+    CHIRA_REGISTER_RESOURCE_TYPE(StringResource);
 };
 
 } // namespace chira
@@ -0,0 +1,35 @@
+# Run in script mode at build time to turn resource folders into a source file for EmbeddedResourceProvider
+#   EMBED_ROOT:    the folder resource names are relative to
+#   EMBED_FOLDERS: comma-separated folders inside EMBED_ROOT to embed
+#   EMBED_OUTPUT:  the source file to write
+
+string(REPLACE "," ";" EMBED_FOLDERS "${EMBED_FOLDERS}")
+
+set(EMBED_DATA "")
+set(EMBED_ENTRIES "")
+set(EMBED_COUNT 0)
+foreach(EMBED_FOLDER ${EMBED_FOLDERS})
+    file(GLOB_RECURSE EMBED_FILES RELATIVE ${EMBED_ROOT} ${EMBED_ROOT}/${EMBED_FOLDER}/*)
+    list(SORT EMBED_FILES)
+    foreach(EMBED_FILE ${EMBED_FILES})
+        file(READ ${EMBED_ROOT}/${EMBED_FILE} EMBED_HEX HEX)
+        file(SIZE ${EMBED_ROOT}/${EMBED_FILE} EMBED_SIZE)
+        string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," EMBED_BYTES "${EMBED_HEX}")
+        string(REGEX REPLACE "((0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],)(0x[0-9a-f][0-9a-f],))" "\\1\n        " EMBED_BYTES "${EMBED_BYTES}")
+        # Null-terminated so text resources can be compiled straight out of the array
+        string(APPEND EMBED_DATA "alignas(16) constexpr byte RESOURCE_${EMBED_COUNT}[] = {\n        ${EMBED_BYTES}0x00};\n")
+        string(APPEND EMBED_ENTRIES "        {\"${EMBED_FILE}\", RESOURCE_${EMBED_COUNT}, ${EMBED_SIZE}},\n")
+        math(EXPR EMBED_COUNT "${EMBED_COUNT} + 1")
+    endforeach()
+endforeach()
+
+if(EMBED_COUNT GREATER 0)
+    set(EMBED_TABLE "constexpr EmbeddedResource RESOURCES[] = {\n${EMBED_ENTRIES}};\n\n} // namespace\n\nstd::span<const EmbeddedResource> chira::getEmbeddedEngineResources() {\n    return RESOURCES;\n}\n")
+else()
+    set(EMBED_TABLE "} // namespace\n\nstd::span<const EmbeddedResource> chira::getEmbeddedEngineResources() {\n    return {};\n}\n")
+endif()
+
+file(WRITE ${EMBED_OUTPUT}.tmp "// Generated by EmbedResources.cmake, do not edit!\n\n#include <resource/provider/EmbeddedResourceProvider.h>\n\nusing namespace chira;\n\nnamespace {\n\n${EMBED_DATA}\n${EMBED_TABLE}")
+# Only touch the output if it changed, so the engine isn't rebuilt for nothing
+file(COPY_FILE ${EMBED_OUTPUT}.tmp ${EMBED_OUTPUT} ONLY_IF_DIFFERENT)
+file(REMOVE ${EMBED_OUTPUT}.tmp)
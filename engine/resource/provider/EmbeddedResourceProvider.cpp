@@ -0,0 +1,30 @@
+#include "EmbeddedResourceProvider.h"
+
+#include <core/Logger.h>
+#include <i18n/TranslationManager.h>
+
+using namespace chira;
+
+CHIRA_CREATE_LOG(EMBEDDED);
+
+EmbeddedResourceProvider::EmbeddedResourceProvider(std::span<const EmbeddedResource> resources_, const std::string& name_)
+    : IResourceProvider(name_) {
+    this->resources.reserve(resources_.size());
+    for (const auto& resource : resources_) {
+        this->resources[resource.name] = &resource;
+    }
+}
+
+bool EmbeddedResourceProvider::hasResource(std::string_view name) const {
+    return this->resources.contains(name);
+}
+
+ResourceView EmbeddedResourceProvider::readResource(std::string_view name) const {
+    const auto resource = this->resources.find(name);
+    if (resource == this->resources.end()) {
+        LOG_EMBEDDED.error(TRF("error.resource.resource_not_found", name));
+        return {};
+    }
+    // The data is static, so the view doesn't need to own anything
+    return {nullptr, resource->second->data, resource->second->size, true};
+}
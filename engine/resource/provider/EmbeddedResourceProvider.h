@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <math/Types.h>
+#include <utility/Hash.h>
+#include "FilesystemResourceProvider.h"
+
+namespace chira {
+
+/// A file compiled into the program. The data is followed by a null terminator that is not counted in the size.
+struct EmbeddedResource {
+    std::string_view name;
+    const byte* data;
+    std::size_t size;
+};
+
+/// The folders in CHIRA_EMBEDDED_RESOURCE_FOLDERS, relative to the engine resources folder.
+/// Defined in a source file generated at build time, and empty if CHIRA_EMBED_ENGINE_RESOURCES is off.
+[[nodiscard]] std::span<const EmbeddedResource> getEmbeddedEngineResources();
+
+/// Serves resources out of static memory, so reading one never touches the disk.
+class EmbeddedResourceProvider : public IResourceProvider {
+public:
+    explicit EmbeddedResourceProvider(std::span<const EmbeddedResource> resources_, const std::string& name_ = FILESYSTEM_PROVIDER_NAME);
+    [[nodiscard]] bool hasResource(std::string_view name) const override;
+    [[nodiscard]] ResourceView readResource(std::string_view name) const override;
+    [[nodiscard]] std::size_t getResourceCount() const {
+        return this->resources.size();
+    }
+private:
+    std::unordered_map<std::string_view, const EmbeddedResource*, TransparentStringHash> resources;
+};
+
+} // namespace chira
@@ -1,10 +1,13 @@
 #include "FilesystemResourceProvider.h"
 
+#include <algorithm>
 #include <fstream>
 #include <filesystem>
 #include <utility>
 #include <core/Platform.h>
 #include <resource/Resource.h>
+#include <utility/BatchFileReader.h>
+#include <utility/MemoryMappedFile.h>
 
 #ifdef CHIRA_PLATFORM_APPLE
     #include "CoreFoundation/CoreFoundation.h"
@@ -14,10 +17,11 @@ using namespace chira;
 
 CHIRA_CREATE_LOG(FILESYSTEM);
 
-FilesystemResourceProvider::FilesystemResourceProvider(std::string path_, bool isPathAbsolute, const std::string& name_)
+FilesystemResourceProvider::FilesystemResourceProvider(std::string path_, bool isPathAbsolute, const std::string& name_, bool memoryMap_)
     : IResourceProvider(name_)
     , path(std::move(path_))
-    , absolute(isPathAbsolute) {
+    , absolute(isPathAbsolute)
+    , memoryMap(memoryMap_) {
     FilesystemResourceProvider::nixifyPath(this->path);
     this->path = String::stripRight(this->path, '/');
     if (!this->absolute) {
@@ -67,41 +71,103 @@ FilesystemResourceProvider::FilesystemResourceProvider(std::string path_, bool i
     this->path = FILESYSTEM_ROOT_FOLDER + '/' + this->path;
 #endif
     }
+    this->refresh();
 }
 
-bool FilesystemResourceProvider::hasResource(std::string_view name) const {
+std::filesystem::path FilesystemResourceProvider::getRootPath() const {
     if (this->absolute)
-        return std::filesystem::exists(std::filesystem::path{this->path}.append(name));
+        return std::filesystem::path{this->path};
     else
-        return std::filesystem::exists(std::filesystem::current_path().append(this->path).append(name));
+        return std::filesystem::current_path().append(this->path);
 }
 
-void FilesystemResourceProvider::compileResource(std::string_view name, Resource* resource) const {
-    std::filesystem::path resourcePath;
-    if (this->absolute)
-        resourcePath = std::filesystem::path{this->path}.append(name);
-    else
-        resourcePath = std::filesystem::current_path().append(this->path).append(name);
+bool FilesystemResourceProvider::hasResource(std::string_view name) const {
+    {
+        std::shared_lock lock{this->indexMutex};
+        if (this->index.contains(name))
+            return true;
+        if (this->missing.contains(name))
+            return false;
+    }
+    // Not indexed, it could have been added after the index was built or be spelled differently
+    bool exists = std::filesystem::exists(this->getRootPath().append(name));
+    std::unique_lock lock{this->indexMutex};
+    (exists ? this->index : this->missing).emplace(name);
+    return exists;
+}
+
+void FilesystemResourceProvider::refresh() {
+    std::unordered_set<std::string, TransparentStringHash, std::equal_to<>> newIndex;
+    const auto root = this->getRootPath();
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator i{root, error}, end; !error && i != end; i.increment(error)) {
+        auto name = std::filesystem::relative(i->path(), root, error).string();
+        FilesystemResourceProvider::nixifyPath(name);
+        newIndex.emplace(std::move(name));
+    }
+    std::unique_lock lock{this->indexMutex};
+    this->index = std::move(newIndex);
+    this->missing.clear();
+}
+
+ResourceView FilesystemResourceProvider::readResource(std::string_view name) const {
+    std::filesystem::path resourcePath = this->getRootPath().append(name);
     std::uintmax_t fileSize = std::filesystem::file_size(resourcePath);
+    if (this->memoryMap && fileSize >= FILESYSTEM_MEMORY_MAP_MIN_SIZE) {
+        if (auto mapping = std::make_shared<const MemoryMappedFile>(resourcePath.string()); mapping->isOpen()) {
+            return {mapping, mapping->getData(), mapping->getSize(), false};
+        }
+        // Fall back to reading the file if it can't be mapped
+    }
     std::ifstream ifs(resourcePath.string().c_str(), std::ios::in | std::ios::binary);
     ifs.seekg(0, std::ios::beg);
-    auto* bytes = new byte[(std::size_t) fileSize + 1];
-    ifs.read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(fileSize));
+    std::vector<byte> bytes((std::size_t) fileSize + 1);
+    ifs.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(fileSize));
     bytes[fileSize] = '\0';
-    resource->compile(bytes, (std::size_t) fileSize + 1);
-    delete[] bytes;
+    return ResourceView::fromNullTerminatedBuffer(std::move(bytes));
+}
+
+std::vector<ResourceView> FilesystemResourceProvider::readResources(std::span<const std::string_view> names) const {
+    std::vector<ResourceView> views(names.size());
+    std::vector<std::string> paths;
+    std::vector<std::size_t> pathViews;
+    const auto root = this->getRootPath();
+    for (std::size_t i = 0; i < names.size(); i++) {
+        auto resourcePath = std::filesystem::path{root}.append(names[i]);
+        std::error_code error;
+        const auto fileSize = std::filesystem::file_size(resourcePath, error);
+        if (error)
+            continue;
+        if (this->memoryMap && fileSize >= FILESYSTEM_MEMORY_MAP_MIN_SIZE) {
+            // Mapping doesn't read anything yet
+            views[i] = this->readResource(names[i]);
+            continue;
+        }
+        paths.push_back(resourcePath.string());
+        pathViews.push_back(i);
+    }
+    auto buffers = BatchFileReader::readFiles(paths);
+    for (std::size_t i = 0; i < buffers.size(); i++) {
+        if (buffers[i])
+            views[pathViews[i]] = ResourceView::fromNullTerminatedBuffer(std::move(*buffers[i]));
+    }
+    return views;
+}
+
+bool FilesystemResourceProvider::hasBatchedReads() const {
+    return BatchFileReader::isBatched();
 }
 
 std::string FilesystemResourceProvider::getFolder() const {
     return String::stripLeft(std::string{this->getPath().data()}, FILESYSTEM_ROOT_FOLDER + '/');
 }
 
-std::string FilesystemResourceProvider::getLocalResourceAbsolutePath(const std::string& identifier) const {
+std::string FilesystemResourceProvider::getLocalResourceAbsolutePath(const ResourceID& identifier) const {
     // Make sure we've been passed a valid identifier
-    auto name = Resource::splitResourceIdentifier(identifier).second;
+    auto name = identifier.getName();
     if (!this->hasResource(name))
         return "";
-    auto absPath = (this->absolute ? std::filesystem::path{this->path} : std::filesystem::current_path().append(this->path)).append(name).string();
+    auto absPath = this->getRootPath().append(name).string();
     // Replace cringe Windows-style backslashes
     FilesystemResourceProvider::nixifyPath(absPath);
     return absPath;
@@ -140,8 +206,12 @@ std::string FilesystemResourceProvider::getResourceFolderPath(std::string_view a
     return path;
 }
 
-std::string FilesystemResourceProvider::getResourceAbsolutePath(const std::string& identifier) {
-    if (auto provider = Resource::getResourceProviderWithResource(identifier))
-        return assert_cast<FilesystemResourceProvider*>(provider)->getLocalResourceAbsolutePath(identifier);
+std::string FilesystemResourceProvider::getResourceAbsolutePath(const ResourceID& identifier) {
+    // Other kinds of providers can share our name, but only loose files have a path
+    const auto& providers = Resource::getResourceProviders(identifier.getProvider());
+    for (auto i = providers.rbegin(); i != providers.rend(); i++) {
+        if (auto* provider = dynamic_cast<FilesystemResourceProvider*>(i->get()); provider && provider->hasResource(identifier.getName()))
+            return provider->getLocalResourceAbsolutePath(identifier);
+    }
     return "";
 }
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <filesystem>
+#include <shared_mutex>
+#include <unordered_set>
+#include <resource/ResourceID.h>
+#include <utility/Hash.h>
 #include <utility/String.h>
 #include "IResourceProvider.h"
 
@@ -7,20 +12,34 @@ namespace chira {
 
 const std::string FILESYSTEM_ROOT_FOLDER = "resources";
 const std::string FILESYSTEM_PROVIDER_NAME = "file";
+/// Files smaller than this are read into memory even if the provider memory-maps files.
+constexpr std::size_t FILESYSTEM_MEMORY_MAP_MIN_SIZE = 64 * 1024;
 
 class FilesystemResourceProvider : public IResourceProvider {
 public:
-    explicit FilesystemResourceProvider(std::string path_, bool isPathAbsolute = false, const std::string& name_ = FILESYSTEM_PROVIDER_NAME);
+    explicit FilesystemResourceProvider(std::string path_, bool isPathAbsolute = false, const std::string& name_ = FILESYSTEM_PROVIDER_NAME, bool memoryMap_ = true);
+    /// Answered from an index of the folder built when the provider is made.
+    /// Names missing from the index are checked on disk once, and the answer is remembered until refresh().
     [[nodiscard]] bool hasResource(std::string_view name) const override;
-    void compileResource(std::string_view name, Resource* resource) const override;
+    [[nodiscard]] ResourceView readResource(std::string_view name) const override;
+    /// Files that aren't memory-mapped are read with BatchFileReader, so on Linux the reads go through io_uring together.
+    [[nodiscard]] std::vector<ResourceView> readResources(std::span<const std::string_view> names) const override;
+    /// Only when BatchFileReader can use io_uring, otherwise the files would be read one after another anyway.
+    [[nodiscard]] bool hasBatchedReads() const override;
+    /// Rebuilds the index and forgets every remembered miss.
+    void refresh() override;
     [[nodiscard]] std::string_view getPath() const {
         return this->path;
     }
     [[nodiscard]] bool isAbsolute() const {
         return this->absolute;
     }
+    /// If true, large files are memory-mapped instead of read, and resources get a view of the mapping.
+    [[nodiscard]] bool isMemoryMapped() const {
+        return this->memoryMap;
+    }
     [[nodiscard]] std::string getFolder() const;
-    [[nodiscard]] std::string getLocalResourceAbsolutePath(const std::string& identifier) const;
+    [[nodiscard]] std::string getLocalResourceAbsolutePath(const ResourceID& identifier) const;
 
     /// Converts all backslashes in a string to forward slashes.
     static void nixifyPath(std::string& path);
@@ -32,12 +51,18 @@ public:
     /// actually points to a valid resource.
     static std::string getResourceFolderPath(std::string_view absolutePath);
     /// Takes a resource identifier and returns the full absolute path, if it exists.
-    static std::string getResourceAbsolutePath(const std::string& identifier);
+    static std::string getResourceAbsolutePath(const ResourceID& identifier);
 
     static constexpr inline short FILEPATH_MAX_LENGTH = 1024;
 private:
+    [[nodiscard]] std::filesystem::path getRootPath() const;
+
     std::string path;
     bool absolute;
+    bool memoryMap;
+    mutable std::shared_mutex indexMutex;
+    mutable std::unordered_set<std::string, TransparentStringHash, std::equal_to<>> index;
+    mutable std::unordered_set<std::string, TransparentStringHash, std::equal_to<>> missing;
 };
 
 } // namespace chira
@@ -1,12 +1,14 @@
 #pragma once
 
+#include <exception>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
+#include "ResourceView.h"
 
 namespace chira {
 
-class Resource;
-
 class IResourceProvider {
 public:
     explicit IResourceProvider(std::string name) : providerName(std::move(name)) {}
@@ -15,7 +17,31 @@ public:
         return this->providerName;
     }
     [[nodiscard]] virtual bool hasResource(std::string_view name) const = 0;
-    virtual void compileResource(std::string_view name, Resource* resource) const = 0;
+    /// Returns a view of the contents of the resource, which may or may not be null-terminated.
+    /// This must be safe to call from any thread, because asynchronous loads read on worker threads.
+    [[nodiscard]] virtual ResourceView readResource(std::string_view name) const = 0;
+    /// Reads several resources together, in the same order as the names. A resource that couldn't be read gets an empty view.
+    /// Providers that can have many reads in flight at once should override this and hasBatchedReads(), by default they are read one at a time.
+    [[nodiscard]] virtual std::vector<ResourceView> readResources(std::span<const std::string_view> names) const {
+        std::vector<ResourceView> views;
+        views.reserve(names.size());
+        for (auto name : names) {
+            try {
+                views.push_back(this->readResource(name));
+            } catch (const std::exception&) {
+                // Reading it alone will report the error
+                views.emplace_back();
+            }
+        }
+        return views;
+    }
+    /// True if readResources() is faster than reading each resource alone, so reading a batch ahead of time is worth it.
+    /// A batch is read on the thread that asks for it, so this should only be true when the reads really overlap.
+    [[nodiscard]] virtual bool hasBatchedReads() const {
+        return false;
+    }
+    /// Called when the provider's contents may have changed outside of the program.
+    virtual void refresh() {}
 protected:
     std::string providerName;
 };
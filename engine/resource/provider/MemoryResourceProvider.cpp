@@ -0,0 +1,57 @@
+#include "MemoryResourceProvider.h"
+
+#include <mutex>
+#include <core/Logger.h>
+#include <i18n/TranslationManager.h>
+
+using namespace chira;
+
+CHIRA_CREATE_LOG(MEMORY);
+
+MemoryResourceProvider::MemoryResourceProvider(const std::string& name_)
+    : IResourceProvider(name_) {}
+
+bool MemoryResourceProvider::hasResource(std::string_view name) const {
+    std::shared_lock lock{this->resourcesMutex};
+    return this->resources.contains(name);
+}
+
+ResourceView MemoryResourceProvider::readResource(std::string_view name) const {
+    std::shared_lock lock{this->resourcesMutex};
+    if (auto resource = this->resources.find(name); resource != this->resources.end())
+        return resource->second;
+    LOG_MEMORY.error(TRF("error.resource.resource_not_found", name));
+    return {};
+}
+
+void MemoryResourceProvider::setResource(std::string_view name, std::vector<byte> buffer) {
+    buffer.push_back('\0');
+    this->setResource(name, ResourceView::fromNullTerminatedBuffer(std::move(buffer)));
+}
+
+void MemoryResourceProvider::setResource(std::string_view name, ResourceView view) {
+    std::unique_lock lock{this->resourcesMutex};
+    if (auto resource = this->resources.find(name); resource != this->resources.end())
+        resource->second = std::move(view);
+    else
+        this->resources.emplace(name, std::move(view));
+}
+
+bool MemoryResourceProvider::removeResource(std::string_view name) {
+    std::unique_lock lock{this->resourcesMutex};
+    if (auto resource = this->resources.find(name); resource != this->resources.end()) {
+        this->resources.erase(resource);
+        return true;
+    }
+    return false;
+}
+
+void MemoryResourceProvider::clear() {
+    std::unique_lock lock{this->resourcesMutex};
+    this->resources.clear();
+}
+
+std::size_t MemoryResourceProvider::getResourceCount() const {
+    std::shared_lock lock{this->resourcesMutex};
+    return this->resources.size();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <utility/Hash.h>
+#include "FilesystemResourceProvider.h"
+
+namespace chira {
+
+/// Serves resources out of buffers registered while the program runs, for generated or patched content.
+/// Add it after other providers with the same name so it takes priority over them.
+/// Replacing a resource doesn't touch the resource cache, reload it with Resource::getUniqueResource() to see the change.
+class MemoryResourceProvider : public IResourceProvider {
+public:
+    explicit MemoryResourceProvider(const std::string& name_ = FILESYSTEM_PROVIDER_NAME);
+    [[nodiscard]] bool hasResource(std::string_view name) const override;
+    [[nodiscard]] ResourceView readResource(std::string_view name) const override;
+
+    /// Takes the buffer without copying it, and replaces any resource with the same name.
+    /// A null terminator is added to the end, which only reallocates if the buffer is at capacity.
+    void setResource(std::string_view name, std::vector<byte> buffer);
+    /// Shares the memory the view points to, and replaces any resource with the same name.
+    void setResource(std::string_view name, ResourceView view);
+    /// Returns false if there was no resource with the name.
+    bool removeResource(std::string_view name);
+    void clear();
+    [[nodiscard]] std::size_t getResourceCount() const;
+private:
+    mutable std::shared_mutex resourcesMutex;
+    std::unordered_map<std::string, ResourceView, TransparentStringHash, std::equal_to<>> resources;
+};
+
+} // namespace chira
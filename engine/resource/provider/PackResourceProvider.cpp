@@ -0,0 +1,190 @@
+#include "PackResourceProvider.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <bit>
+#include <core/Logger.h>
+#include <i18n/TranslationManager.h>
+#include <utility/Compression.h>
+#include <utility/Hash.h>
+
+using namespace chira;
+
+CHIRA_CREATE_LOG(PACK);
+
+PackResourceProvider::PackResourceProvider(const std::string& packPath_, const std::string& name_)
+    : IResourceProvider(name_)
+    , packPath(packPath_)
+    , mapping(std::make_shared<const MemoryMappedFile>(packPath_)) {
+    if (!this->readDirectory()) {
+        LOG_PACK.error(TRF("error.pack_resource_provider.invalid_pack", this->packPath));
+        this->entries = nullptr;
+        this->mapping.reset();
+    }
+}
+
+bool PackResourceProvider::readDirectory() {
+    if (!this->mapping->isOpen() || this->mapping->getSize() < sizeof(PackHeader)) {
+        return false;
+    }
+    std::memcpy(&this->header, this->mapping->getData(), sizeof(PackHeader));
+    if (std::memcmp(this->header.signature, PackHeader{}.signature, sizeof(PackHeader::signature)) != 0 ||
+        this->header.version != PACK_VERSION ||
+        !std::has_single_bit(this->header.bucketCount) ||
+        this->header.bucketCount <= this->header.entryCount) {
+        return false;
+    }
+
+    const std::uint64_t entriesOffset = sizeof(PackHeader);
+    const std::uint64_t bucketsOffset = entriesOffset + static_cast<std::uint64_t>(this->header.entryCount) * sizeof(PackEntry);
+    const std::uint64_t namesOffset = bucketsOffset + static_cast<std::uint64_t>(this->header.bucketCount) * sizeof(std::uint32_t);
+    if (namesOffset + this->header.namesSize > this->mapping->getSize()) {
+        return false;
+    }
+    const byte* data = this->mapping->getData();
+    this->entries = reinterpret_cast<const PackEntry*>(data + entriesOffset);
+    this->buckets = reinterpret_cast<const std::uint32_t*>(data + bucketsOffset);
+    this->names = reinterpret_cast<const char*>(data + namesOffset);
+
+    // Check every entry up front so lookups and reads don't have to
+    for (std::uint32_t i = 0; i < this->header.entryCount; i++) {
+        const auto& entry = this->entries[i];
+        if (static_cast<std::uint64_t>(entry.nameOffset) + entry.nameLength > this->header.namesSize ||
+            entry.offset + entry.size > this->mapping->getSize() ||
+            (!(entry.flags & PACK_ENTRY_FLAG_COMPRESSED) && entry.size != entry.uncompressedSize)) {
+            return false;
+        }
+    }
+    for (std::uint32_t i = 0; i < this->header.bucketCount; i++) {
+        if (this->buckets[i] > this->header.entryCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const PackEntry* PackResourceProvider::findEntry(std::string_view name) const {
+    if (!this->isValid())
+        return nullptr;
+    const auto hash = hashFNV1a(name);
+    const auto mask = this->header.bucketCount - 1;
+    for (auto bucket = static_cast<std::uint32_t>(hash) & mask; ; bucket = (bucket + 1) & mask) {
+        const auto index = this->buckets[bucket];
+        if (index == 0)
+            return nullptr;
+        const auto& entry = this->entries[index - 1];
+        if (entry.nameHash == hash && name == std::string_view{this->names + entry.nameOffset, entry.nameLength})
+            return &entry;
+    }
+}
+
+bool PackResourceProvider::hasResource(std::string_view name) const {
+    return this->findEntry(name);
+}
+
+ResourceView PackResourceProvider::readResource(std::string_view name) const {
+    const auto* entry = this->findEntry(name);
+    if (!entry) {
+        LOG_PACK.error(TRF("error.resource.resource_not_found", name));
+        return {};
+    }
+    const byte* data = this->mapping->getData() + entry->offset;
+    if (!(entry->flags & PACK_ENTRY_FLAG_COMPRESSED)) {
+        return {this->mapping, data, static_cast<std::size_t>(entry->size), false};
+    }
+    std::vector<byte> buffer(static_cast<std::size_t>(entry->uncompressedSize) + 1);
+    if (!Compression::decompress(data, static_cast<std::size_t>(entry->size), buffer.data(), buffer.size() - 1)) {
+        LOG_PACK.error(TRF("error.pack_resource_provider.corrupt_entry", name, this->packPath));
+        return {};
+    }
+    buffer.back() = '\0';
+    return ResourceView::fromNullTerminatedBuffer(std::move(buffer));
+}
+
+bool PackResourceProvider::createPack(std::ostream& stream, const std::vector<std::pair<std::string, std::filesystem::path>>& files, bool compress) {
+    PackHeader packHeader;
+    packHeader.entryCount = static_cast<std::uint32_t>(files.size());
+    packHeader.bucketCount = std::max(std::bit_ceil(packHeader.entryCount * 2), 2u);
+
+    std::vector<PackEntry> packEntries(files.size());
+    std::string packNames;
+    for (std::size_t i = 0; i < files.size(); i++) {
+        packEntries[i].nameHash = hashFNV1a(files[i].first);
+        packEntries[i].nameOffset = static_cast<std::uint32_t>(packNames.size());
+        packEntries[i].nameLength = static_cast<std::uint32_t>(files[i].first.size());
+        packNames += files[i].first;
+    }
+    packHeader.namesSize = packNames.size();
+
+    // Sort the entries by hash so the directory doesn't depend on the order files were found in
+    std::vector<std::size_t> order(files.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&files, &packEntries](std::size_t lhs, std::size_t rhs) {
+        if (packEntries[lhs].nameHash != packEntries[rhs].nameHash)
+            return packEntries[lhs].nameHash < packEntries[rhs].nameHash;
+        return files[lhs].first < files[rhs].first;
+    });
+
+    std::vector<std::uint32_t> packBuckets(packHeader.bucketCount, 0);
+    for (std::size_t i = 0; i < order.size(); i++) {
+        const auto mask = packHeader.bucketCount - 1;
+        auto bucket = static_cast<std::uint32_t>(packEntries[order[i]].nameHash) & mask;
+        while (packBuckets[bucket] != 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        packBuckets[bucket] = static_cast<std::uint32_t>(i + 1);
+    }
+
+    const std::uint64_t directorySize = sizeof(PackHeader) + packEntries.size() * sizeof(PackEntry) + packBuckets.size() * sizeof(std::uint32_t) + packNames.size();
+    const auto pad = [&stream] {
+        auto position = static_cast<std::uint64_t>(stream.tellp());
+        for (; position % PACK_ENTRY_ALIGNMENT != 0; position++) {
+            stream.put('\0');
+        }
+        return position;
+    };
+
+    // Reserve space for the directory, it gets written last when all the offsets are known
+    for (std::uint64_t i = 0; i < directorySize; i++) {
+        stream.put('\0');
+    }
+    for (std::size_t i = 0; i < order.size(); i++) {
+        auto& entry = packEntries[order[i]];
+        const auto& path = files[order[i]].second;
+
+        std::ifstream input{path, std::ios::binary};
+        if (!input) {
+            LOG_PACK.error(TRF("error.file_input_stream.file_inaccessible", path.string(), "open"));
+            return false;
+        }
+        std::vector<byte> contents{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+
+        entry.offset = pad();
+        entry.uncompressedSize = contents.size();
+        if (compress) {
+            // Not worth decompressing if it barely saves anything
+            if (auto compressed = Compression::compress(contents.data(), contents.size()); compressed.size() < contents.size() - contents.size() / 8) {
+                contents = std::move(compressed);
+                entry.flags |= PACK_ENTRY_FLAG_COMPRESSED;
+            }
+        }
+        entry.size = contents.size();
+        stream.write(reinterpret_cast<const char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+    }
+
+    std::vector<PackEntry> sortedEntries;
+    sortedEntries.reserve(order.size());
+    for (auto index : order) {
+        sortedEntries.push_back(packEntries[index]);
+    }
+
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(&packHeader), sizeof(PackHeader));
+    stream.write(reinterpret_cast<const char*>(sortedEntries.data()), static_cast<std::streamsize>(sortedEntries.size() * sizeof(PackEntry)));
+    stream.write(reinterpret_cast<const char*>(packBuckets.data()), static_cast<std::streamsize>(packBuckets.size() * sizeof(std::uint32_t)));
+    stream.write(packNames.data(), static_cast<std::streamsize>(packNames.size()));
+    return static_cast<bool>(stream);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include <utility/MemoryMappedFile.h>
+#include "FilesystemResourceProvider.h"
+
+namespace chira {
+
+constexpr std::string_view PACK_FILE_EXTENSION = ".cpak";
+constexpr std::uint32_t PACK_VERSION = 1;
+/// Entry data starts on a multiple of this, so mapped views can be read as any scalar type.
+constexpr std::uint64_t PACK_ENTRY_ALIGNMENT = 16;
+
+enum PackEntryFlags : std::uint32_t {
+    PACK_ENTRY_FLAG_NONE       =      0,
+    PACK_ENTRY_FLAG_COMPRESSED = 1 << 0, // Compressed with Compression::compress
+};
+
+struct PackHeader {
+    char signature[4] = {'C', 'P', 'A', 'K'};
+    std::uint32_t version = PACK_VERSION;
+    std::uint32_t entryCount = 0;
+    /// Always a power of two, and more than the entry count so a probe always finds an empty bucket.
+    std::uint32_t bucketCount = 0;
+    std::uint64_t namesSize = 0;
+};
+
+struct PackEntry {
+    std::uint64_t nameHash = 0;
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+    std::uint64_t uncompressedSize = 0;
+    std::uint32_t nameOffset = 0;
+    std::uint32_t nameLength = 0;
+    std::uint32_t flags = PACK_ENTRY_FLAG_NONE;
+    std::uint32_t reserved = 0;
+};
+
+// The directory is read straight out of the mapped file
+static_assert(sizeof(PackHeader) == 24);
+static_assert(sizeof(PackEntry) == 48);
+
+/// Serves resources out of a single pack file, which is memory-mapped for the lifetime of the provider.
+/// The layout is: header, entries sorted by name hash, hash table of entry indices (open addressing,
+/// 0 means empty), entry names, then the aligned entry data.
+class PackResourceProvider : public IResourceProvider {
+public:
+    explicit PackResourceProvider(const std::string& packPath_, const std::string& name_ = FILESYSTEM_PROVIDER_NAME);
+    [[nodiscard]] bool hasResource(std::string_view name) const override;
+    [[nodiscard]] ResourceView readResource(std::string_view name) const override;
+    [[nodiscard]] std::string_view getPackPath() const {
+        return this->packPath;
+    }
+    /// False if the pack could not be mapped or failed validation. An invalid pack has no resources.
+    [[nodiscard]] bool isValid() const {
+        return this->entries;
+    }
+    [[nodiscard]] std::uint32_t getEntryCount() const {
+        return this->isValid() ? this->header.entryCount : 0;
+    }
+
+    /// Writes a pack to a seekable stream. Each file is paired with the resource name it will have in the pack.
+    /// If compress is true, entries are compressed when that makes them meaningfully smaller.
+    static bool createPack(std::ostream& stream, const std::vector<std::pair<std::string, std::filesystem::path>>& files, bool compress);
+private:
+    /// Validates the whole directory, so lookups and reads can trust it afterwards.
+    [[nodiscard]] bool readDirectory();
+    [[nodiscard]] const PackEntry* findEntry(std::string_view name) const;
+
+    std::string packPath;
+    std::shared_ptr<const MemoryMappedFile> mapping;
+    PackHeader header;
+    const PackEntry* entries = nullptr;
+    const std::uint32_t* buckets = nullptr;
+    const char* names = nullptr;
+};
+
+} // namespace chira
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <core/Assertions.h>
+#include <math/Types.h>
+
+namespace chira {
+
+/// A read-only view of a resource's contents, backed by either a heap buffer or a memory-mapped file.
+/// Copies share the same memory, which stays valid until the last copy is destroyed.
+class ResourceView {
+public:
+    ResourceView() = default;
+    ResourceView(std::shared_ptr<const void> owner_, const byte* data_, std::size_t size_, bool nullTerminated_)
+            : owner(std::move(owner_))
+            , data(data_)
+            , size(size_)
+            , nullTerminated(nullTerminated_) {}
+
+    /// The last byte of the buffer must be a null terminator, which is not counted in the size of the view.
+    [[nodiscard]] static ResourceView fromNullTerminatedBuffer(std::vector<byte> buffer) {
+        runtime_assert(!buffer.empty() && buffer.back() == '\0', "Buffer must be null-terminated!");
+        auto owner = std::make_shared<const std::vector<byte>>(std::move(buffer));
+        return {owner, owner->data(), owner->size() - 1, true};
+    }
+
+    [[nodiscard]] const byte* getData() const {
+        return this->data;
+    }
+    /// Does not include the null terminator, if there is one.
+    [[nodiscard]] std::size_t getSize() const {
+        return this->size;
+    }
+    /// If true, getData()[getSize()] is a readable null terminator.
+    [[nodiscard]] bool isNullTerminated() const {
+        return this->nullTerminated;
+    }
+    [[nodiscard]] bool isEmpty() const {
+        return !this->data;
+    }
+private:
+    std::shared_ptr<const void> owner;
+    const byte* data = nullptr;
+    std::size_t size = 0;
+    bool nullTerminated = false;
+};
+
+} // namespace chira
@@ -10,7 +10,7 @@ namespace chira {
 /// After this, the fonts will be baked, and there will be cake.
 class Font : public Resource {
 public:
-    explicit Font(const std::string& identifier_) : Resource(identifier_) {}
+    explicit Font(ResourceID identifier_) : Resource(identifier_) {}
     void compile(const byte buffer[], std::size_t bufferLength) override;
     [[nodiscard]] ImFont* getFont() const;
     [[nodiscard]] const std::string& getName() const;
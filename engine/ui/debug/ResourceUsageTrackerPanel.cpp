@@ -1,13 +1,62 @@
 #include "ResourceUsageTrackerPanel.h"
 
+#include <algorithm>
 #include <i18n/TranslationManager.h>
 
 using namespace chira;
 
+namespace {
+
+enum ResourceColumn {
+    COLUMN_PROVIDER,
+    COLUMN_NAME,
+    COLUMN_USE_COUNT,
+    COLUMN_LOOKUP_TIME,
+    COLUMN_IO_TIME,
+    COLUMN_IO_SIZE,
+    COLUMN_COMPILE_TIME,
+    COLUMN_CPU_MEMORY,
+    COLUMN_GPU_MEMORY,
+    COLUMN_COUNT,
+};
+
+/// Returns true if lhs goes before rhs when sorting ascending by the given column
+bool compareByColumn(const CachedResourceInfo& lhs, const CachedResourceInfo& rhs, int column) {
+    switch (column) {
+        case COLUMN_PROVIDER:
+            return lhs.identifier.getProvider() < rhs.identifier.getProvider();
+        case COLUMN_NAME:
+            return lhs.identifier.getName() < rhs.identifier.getName();
+        case COLUMN_USE_COUNT:
+            return lhs.useCount < rhs.useCount;
+        case COLUMN_LOOKUP_TIME:
+            return lhs.loadStats.providerLookupTime < rhs.loadStats.providerLookupTime;
+        case COLUMN_IO_TIME:
+            return lhs.loadStats.ioTime < rhs.loadStats.ioTime;
+        case COLUMN_IO_SIZE:
+            return lhs.loadStats.ioBytes < rhs.loadStats.ioBytes;
+        case COLUMN_COMPILE_TIME:
+            return lhs.loadStats.compileTime < rhs.loadStats.compileTime;
+        case COLUMN_CPU_MEMORY:
+            return lhs.cpuMemoryUsage < rhs.cpuMemoryUsage;
+        case COLUMN_GPU_MEMORY:
+            return lhs.gpuMemoryUsage < rhs.gpuMemoryUsage;
+        default:
+            return false;
+    }
+}
+
+float toKiB(std::size_t bytes) {
+    return static_cast<float>(bytes) / 1024.f;
+}
+
+} // namespace
+
 ResourceUsageTrackerPanel::ResourceUsageTrackerPanel(ImVec2 windowSize) : IPanel(TR("ui.resource_usage_tracker.title"), false, windowSize) {}
 
 void ResourceUsageTrackerPanel::renderContents() {
     if (ImGui::BeginTable("Default Resources", 2)) {
+        std::shared_lock lock{Resource::defaultResourcesMutex};
         for (const auto& [resourceHash, resource]: Resource::defaultResources) {
             ImGui::TableNextRow();
             ImGui::TableSetColumnIndex(0);
@@ -18,17 +67,58 @@ void ResourceUsageTrackerPanel::renderContents() {
         ImGui::EndTable();
     }
     ImGui::Separator();
-    if (ImGui::BeginTable("Resources", 3)) {
-        for (const auto& [providerName, resourceMap] : Resource::resources) {
-            for (const auto& [resourceName, resource] : resourceMap) {
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(0);
-                ImGui::Text("%s", providerName.c_str());
-                ImGui::TableSetColumnIndex(1);
-                ImGui::Text("%s", resourceName.c_str());
-                ImGui::TableSetColumnIndex(2);
-                ImGui::Text("%d", resource.useCount());
-            }
+    constexpr auto tableFlags = ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+    if (ImGui::BeginTable("Resources", COLUMN_COUNT, tableFlags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn(TRC("ui.resource_usage_tracker.provider"));
+        ImGui::TableSetupColumn(TRC("ui.resource_usage_tracker.name"), ImGuiTableColumnFlags_DefaultSort);
+        ImGui::TableSetupColumn(TRC("ui.resource_usage_tracker.use_count"));
+        ImGui::TableSetupColumn(TRC("ui.resource_usage_tracker.lookup_time"));
+        ImGui::TableSetupColumn(TRC("ui.resource_usage_tracker.io_time"));
+        ImGui::TableSetupColumn(TRC("ui.resource_usage_tracker.io_size"));
+        ImGui::TableSetupColumn(TRC("ui.resource_usage_tracker.compile_time"));
+        ImGui::TableSetupColumn(TRC("ui.resource_usage_tracker.cpu_memory"));
+        ImGui::TableSetupColumn(TRC("ui.resource_usage_tracker.gpu_memory"));
+        ImGui::TableHeadersRow();
+
+        // The cache changes every frame, so sort a fresh snapshot every frame
+        auto resources = Resource::getCachedResourceInfo();
+        if (const auto* sortSpecs = ImGui::TableGetSortSpecs(); sortSpecs && sortSpecs->SpecsCount > 0) {
+            std::sort(resources.begin(), resources.end(), [sortSpecs](const CachedResourceInfo& lhs, const CachedResourceInfo& rhs) {
+                for (int i = 0; i < sortSpecs->SpecsCount; i++) {
+                    const auto& spec = sortSpecs->Specs[i];
+                    const bool ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+                    if (compareByColumn(lhs, rhs, spec.ColumnIndex))
+                        return ascending;
+                    if (compareByColumn(rhs, lhs, spec.ColumnIndex))
+                        return !ascending;
+                }
+                return false;
+            });
+        }
+
+        for (const auto& resource : resources) {
+            const auto providerName = resource.identifier.getProvider();
+            const auto resourceName = resource.identifier.getName();
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(COLUMN_PROVIDER);
+            ImGui::Text("%.*s", static_cast<int>(providerName.size()), providerName.data());
+            ImGui::TableSetColumnIndex(COLUMN_NAME);
+            ImGui::Text("%.*s", static_cast<int>(resourceName.size()), resourceName.data());
+            ImGui::TableSetColumnIndex(COLUMN_USE_COUNT);
+            ImGui::Text("%u", resource.useCount);
+            ImGui::TableSetColumnIndex(COLUMN_LOOKUP_TIME);
+            ImGui::Text("%.3f", resource.loadStats.providerLookupTime);
+            ImGui::TableSetColumnIndex(COLUMN_IO_TIME);
+            ImGui::Text("%.3f", resource.loadStats.ioTime);
+            ImGui::TableSetColumnIndex(COLUMN_IO_SIZE);
+            ImGui::Text("%.1f", toKiB(resource.loadStats.ioBytes));
+            ImGui::TableSetColumnIndex(COLUMN_COMPILE_TIME);
+            ImGui::Text("%.3f", resource.loadStats.compileTime);
+            ImGui::TableSetColumnIndex(COLUMN_CPU_MEMORY);
+            ImGui::Text("%.1f", toKiB(resource.cpuMemoryUsage));
+            ImGui::TableSetColumnIndex(COLUMN_GPU_MEMORY);
+            ImGui::Text("%.1f", toKiB(resource.gpuMemoryUsage));
         }
         ImGui::EndTable();
     }
@@ -0,0 +1,159 @@
+#include "BatchFileReader.h"
+
+#include <fstream>
+
+#ifdef CHIRA_USE_IO_URING
+    #include <cerrno>
+    #include <climits>
+    #include <cstdint>
+    #include <fcntl.h>
+    #include <liburing.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace chira;
+
+namespace {
+
+std::optional<std::vector<byte>> readFile(const std::string& path) {
+    std::ifstream file{path, std::ios::in | std::ios::binary | std::ios::ate};
+    if (!file)
+        return std::nullopt;
+    const auto size = static_cast<std::size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+    std::vector<byte> buffer(size + 1);
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size)))
+        return std::nullopt;
+    buffer[size] = '\0';
+    return buffer;
+}
+
+#ifdef CHIRA_USE_IO_URING
+
+constexpr unsigned QUEUE_DEPTH = 64;
+
+/// Each thread sets up a ring the first time it reads, then keeps it. Setting one up can fail if
+/// the kernel is too old or io_uring is disabled, and then that thread reads normally.
+struct Ring {
+    io_uring ring{};
+    bool valid = false;
+
+    Ring() {
+        this->valid = io_uring_queue_init(QUEUE_DEPTH, &this->ring, 0) == 0;
+    }
+    ~Ring() {
+        if (this->valid)
+            io_uring_queue_exit(&this->ring);
+    }
+};
+
+Ring& getRing() {
+    thread_local Ring ring;
+    return ring;
+}
+
+/// Returns false if the ring stopped working, in which case it has been torn down. Reads that didn't complete are left without a buffer.
+bool readFilesWithRing(io_uring& ring, std::span<const std::string> paths, std::vector<std::optional<std::vector<byte>>>& buffers) {
+    std::vector<int> files(paths.size(), -1);
+    const auto finish = [&files, &buffers](std::size_t index, bool success) {
+        close(files[index]);
+        files[index] = -1;
+        if (!success)
+            buffers[index].reset();
+    };
+
+    std::size_t next = 0;
+    unsigned inFlight = 0;
+    while (next < paths.size() || inFlight > 0) {
+        // Keep the queue as deep as it can be. Files are only opened when their read is queued,
+        // so a big batch never holds more than a queue's worth of descriptors
+        for (; next < paths.size() && inFlight < QUEUE_DEPTH; next++) {
+            const int file = open(paths[next].c_str(), O_RDONLY | O_CLOEXEC);
+            if (file < 0)
+                continue;
+            struct stat fileInfo{};
+            if (fstat(file, &fileInfo) != 0 || static_cast<std::uintmax_t>(fileInfo.st_size) > UINT_MAX) {
+                close(file);
+                continue;
+            }
+            auto* entry = io_uring_get_sqe(&ring);
+            if (!entry) {
+                // Opened again when there's room
+                close(file);
+                break;
+            }
+            files[next] = file;
+            auto& buffer = buffers[next].emplace(static_cast<std::size_t>(fileInfo.st_size) + 1);
+            buffer.back() = '\0';
+            io_uring_prep_read(entry, file, buffer.data(), static_cast<unsigned>(buffer.size() - 1), 0);
+            io_uring_sqe_set_data(entry, reinterpret_cast<void*>(next));
+            inFlight++;
+        }
+        if (inFlight == 0)
+            continue;
+
+        int result;
+        do {
+            result = io_uring_submit_and_wait(&ring, 1);
+        } while (result == -EINTR);
+        if (result < 0) {
+            // The kernel may still write into the buffers of reads it took, so wait for those before freeing anything
+            for (unsigned submitted = inFlight - io_uring_sq_ready(&ring); submitted > 0;) {
+                io_uring_cqe* completion = nullptr;
+                const int waited = io_uring_wait_cqe(&ring, &completion);
+                if (waited == -EINTR)
+                    continue;
+                if (waited < 0)
+                    break;
+                io_uring_cqe_seen(&ring, completion);
+                submitted--;
+            }
+            // Cancels anything that's left, including reads that were never submitted
+            io_uring_queue_exit(&ring);
+            for (std::size_t i = 0; i < paths.size(); i++) {
+                if (files[i] >= 0)
+                    finish(i, false);
+            }
+            return false;
+        }
+
+        io_uring_cqe* completion = nullptr;
+        while (io_uring_peek_cqe(&ring, &completion) == 0) {
+            const auto index = reinterpret_cast<std::size_t>(io_uring_cqe_get_data(completion));
+            // A short read means the file changed size since it was opened
+            finish(index, completion->res >= 0 && static_cast<std::size_t>(completion->res) == buffers[index]->size() - 1);
+            io_uring_cqe_seen(&ring, completion);
+            inFlight--;
+        }
+    }
+    return true;
+}
+
+#endif
+
+} // namespace
+
+std::vector<std::optional<std::vector<byte>>> BatchFileReader::readFiles(std::span<const std::string> paths) {
+    std::vector<std::optional<std::vector<byte>>> buffers(paths.size());
+#ifdef CHIRA_USE_IO_URING
+    if (auto& ring = getRing(); ring.valid) {
+        // A ring that stopped working has already been torn down
+        ring.valid = readFilesWithRing(ring.ring, paths, buffers);
+        // Anything the ring couldn't read gets another chance below
+    }
+#endif
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        if (!buffers[i])
+            buffers[i] = readFile(paths[i]);
+    }
+    return buffers;
+}
+
+bool BatchFileReader::isBatched() {
+#ifdef CHIRA_USE_IO_URING
+    return getRing().valid;
+#else
+    return false;
+#endif
+}
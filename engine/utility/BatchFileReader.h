@@ -0,0 +1,20 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include <math/Types.h>
+
+/// Reads many whole files at once. On Linux with io_uring every read is queued together, so the disk
+/// works through them in parallel instead of waiting on one read call per file.
+namespace chira::BatchFileReader {
+
+/// Returns a buffer for each path in the same order, with a null terminator after the contents.
+/// A file that couldn't be read has no buffer. Falls back to reading the files one after another.
+[[nodiscard]] std::vector<std::optional<std::vector<byte>>> readFiles(std::span<const std::string> paths);
+
+/// True if readFiles() queues its reads through io_uring on this thread.
+[[nodiscard]] bool isBatched();
+
+} // namespace chira::BatchFileReader
@@ -0,0 +1,145 @@
+#include "Compression.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+using namespace chira;
+
+namespace {
+
+constexpr std::size_t MIN_MATCH = 4;
+constexpr std::size_t MAX_OFFSET = 0xFFFF;
+constexpr unsigned int HASH_BITS = 14;
+
+std::uint32_t read32(const byte* data) {
+    std::uint32_t out;
+    std::memcpy(&out, data, sizeof(out));
+    return out;
+}
+
+std::uint32_t hashSequence(std::uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void writeLength(std::vector<byte>& out, std::size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<byte>(length));
+}
+
+void writeSequence(std::vector<byte>& out, const byte* literals, std::size_t literalLength, std::size_t offset, std::size_t matchLength) {
+    // Token: high nibble is the literal length, low nibble is the match length past the minimum
+    byte token = static_cast<byte>((literalLength < 15 ? literalLength : 15) << 4);
+    if (matchLength) {
+        std::size_t extraMatch = matchLength - MIN_MATCH;
+        token |= static_cast<byte>(extraMatch < 15 ? extraMatch : 15);
+    }
+    out.push_back(token);
+    if (literalLength >= 15) {
+        writeLength(out, literalLength - 15);
+    }
+    out.insert(out.end(), literals, literals + literalLength);
+    if (!matchLength) {
+        return;
+    }
+    out.push_back(static_cast<byte>(offset & 0xFF));
+    out.push_back(static_cast<byte>(offset >> 8));
+    if (matchLength - MIN_MATCH >= 15) {
+        writeLength(out, matchLength - MIN_MATCH - 15);
+    }
+}
+
+bool readLength(const byte*& in, const byte* inEnd, std::size_t& length) {
+    byte next;
+    do {
+        if (in >= inEnd) {
+            return false;
+        }
+        next = *in++;
+        length += next;
+    } while (next == 255);
+    return true;
+}
+
+} // namespace
+
+std::vector<byte> Compression::compress(const byte data[], std::size_t size) {
+    std::vector<byte> out;
+    out.reserve(size / 2 + 16);
+
+    std::array<std::size_t, 1 << HASH_BITS> table{};
+    table.fill(SIZE_MAX);
+
+    std::size_t anchor = 0, position = 0;
+    while (size >= MIN_MATCH && position <= size - MIN_MATCH) {
+        auto sequence = read32(data + position);
+        auto& candidate = table[hashSequence(sequence)];
+        std::size_t matchStart = candidate;
+        candidate = position;
+        if (matchStart == SIZE_MAX || position - matchStart > MAX_OFFSET || read32(data + matchStart) != sequence) {
+            position++;
+            continue;
+        }
+        std::size_t matchLength = MIN_MATCH;
+        while (position + matchLength < size && data[matchStart + matchLength] == data[position + matchLength]) {
+            matchLength++;
+        }
+        writeSequence(out, data + anchor, position - anchor, position - matchStart, matchLength);
+        position += matchLength;
+        anchor = position;
+    }
+    // The last sequence is only literals
+    writeSequence(out, data + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+bool Compression::decompress(const byte data[], std::size_t size, byte output[], std::size_t outputSize) {
+    const byte* in = data;
+    const byte* inEnd = data + size;
+    std::size_t written = 0;
+    while (in < inEnd) {
+        byte token = *in++;
+
+        std::size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(in, inEnd, literalLength)) {
+            return false;
+        }
+        if (literalLength > static_cast<std::size_t>(inEnd - in) || literalLength > outputSize - written) {
+            return false;
+        }
+        if (literalLength) {
+            std::memcpy(output + written, in, literalLength);
+        }
+        in += literalLength;
+        written += literalLength;
+
+        if (in == inEnd) {
+            // Reached the final literal-only sequence
+            break;
+        }
+
+        if (inEnd - in < 2) {
+            return false;
+        }
+        std::size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        std::size_t matchLength = token & 0x0F;
+        if (matchLength == 15 && !readLength(in, inEnd, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (offset == 0 || offset > written || matchLength > outputSize - written) {
+            return false;
+        }
+        // Matches can overlap the bytes they produce, so copy one at a time
+        const byte* match = output + written - offset;
+        for (std::size_t i = 0; i < matchLength; i++) {
+            output[written + i] = match[i];
+        }
+        written += matchLength;
+    }
+    return written == outputSize;
+}
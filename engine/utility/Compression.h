@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <math/Types.h>
+
+/// A small LZ77 block codec in the style of LZ4. Fast to decompress, no dictionary, no framing.
+namespace chira::Compression {
+
+/// Returns the compressed data. It can be larger than the input if the input doesn't compress!
+[[nodiscard]] std::vector<byte> compress(const byte data[], std::size_t size);
+
+/// The most that the given amount of compressed data can decompress to. Every compressed byte makes at most 255 bytes of
+/// output, so sizes read from a file can be checked against this before allocating for them.
+[[nodiscard]] constexpr std::size_t getMaxDecompressedSize(std::size_t size) {
+    return size * 255;
+}
+
+/// Decompresses data produced by compress() into a buffer that is exactly the uncompressed size.
+/// Returns false if the data is corrupt or does not decompress to exactly outputSize bytes.
+[[nodiscard]] bool decompress(const byte data[], std::size_t size, byte output[], std::size_t outputSize);
+
+} // namespace chira::Compression
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace chira {
+
+/// 64-bit FNV-1a. Usable at compile time, and stable across platforms and runs.
+[[nodiscard]] constexpr std::uint64_t hashFNV1a(std::string_view str) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : str) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/// Lets unordered containers of std::string be searched with a std::string_view without allocating.
+/// Use with std::equal_to<> as the key equality.
+struct TransparentStringHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view str) const {
+        return static_cast<std::size_t>(hashFNV1a(str));
+    }
+};
+
+} // namespace chira
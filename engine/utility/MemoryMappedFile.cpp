@@ -0,0 +1,74 @@
+#include "MemoryMappedFile.h"
+
+#ifdef CHIRA_PLATFORM_WINDOWS
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace chira;
+
+#ifdef CHIRA_PLATFORM_WINDOWS
+
+MemoryMappedFile::MemoryMappedFile(const std::string& path) {
+    this->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (this->file == INVALID_HANDLE_VALUE) {
+        this->file = nullptr;
+        return;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(this->file, &fileSize) || fileSize.QuadPart == 0) {
+        return;
+    }
+    this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!this->mapping) {
+        return;
+    }
+    this->data = static_cast<const byte*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+    if (this->data) {
+        this->size = static_cast<std::size_t>(fileSize.QuadPart);
+    }
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+    if (this->data) {
+        UnmapViewOfFile(this->data);
+    }
+    if (this->mapping) {
+        CloseHandle(this->mapping);
+    }
+    if (this->file) {
+        CloseHandle(this->file);
+    }
+}
+
+#else
+
+MemoryMappedFile::MemoryMappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat fileInfo{};
+    if (fstat(fd, &fileInfo) == 0 && fileInfo.st_size > 0) {
+        void* mapped = mmap(nullptr, static_cast<std::size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            this->data = static_cast<const byte*>(mapped);
+            this->size = static_cast<std::size_t>(fileInfo.st_size);
+        }
+    }
+    // The mapping keeps its own reference to the file
+    close(fd);
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+    if (this->data) {
+        munmap(const_cast<byte*>(this->data), this->size);
+    }
+}
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <core/Platform.h>
+#include <math/Types.h>
+#include "NoCopyOrMove.h"
+
+namespace chira {
+
+/// Maps an entire file into memory as read-only.
+/// The file must not be truncated while it is mapped.
+class MemoryMappedFile : public NoCopyOrMove {
+public:
+    explicit MemoryMappedFile(const std::string& path);
+    ~MemoryMappedFile();
+
+    /// False if the file could not be opened or is empty.
+    [[nodiscard]] bool isOpen() const {
+        return this->data;
+    }
+    [[nodiscard]] const byte* getData() const {
+        return this->data;
+    }
+    [[nodiscard]] std::size_t getSize() const {
+        return this->size;
+    }
+private:
+    const byte* data = nullptr;
+    std::size_t size = 0;
+#ifdef CHIRA_PLATFORM_WINDOWS
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+} // namespace chira
@@ -1,19 +1,61 @@
 #pragma once
 
-#include <sstream>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
 #include <type_traits>
 #include <cereal/cereal.hpp>
+#include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
 #include <cereal/types/common.hpp>
 #include <cereal/types/string.hpp>
+#include <math/Types.h>
 
 namespace chira::Serial {
 
+/// Cooked descriptors start with this, followed by the fields of serialize() in a cereal binary archive.
+/// Bump the version at the end if the cooked layout changes, old cooked files are then rejected instead of misread.
+/// Changing a serialize() function means everything that uses it has to be cooked again.
+constexpr std::string_view COOKED_SIGNATURE = "CHRCOOK1";
+
+/// Reads straight out of a buffer, so it doesn't need to be copied into a string stream first.
+class BufferStreamBuffer : public std::streambuf {
+public:
+    BufferStreamBuffer(const byte buffer[], std::size_t bufferLength) {
+        // The get area is never written to
+        auto* begin = const_cast<char*>(reinterpret_cast<const char*>(buffer));
+        this->setg(begin, begin, begin + bufferLength);
+    }
+};
+
+[[nodiscard]] inline bool isCooked(const byte buffer[], std::size_t bufferLength) {
+    return bufferLength >= COOKED_SIGNATURE.size() &&
+           std::string_view{reinterpret_cast<const char*>(buffer), COOKED_SIGNATURE.size()} == COOKED_SIGNATURE;
+}
+
+/// Loads a descriptor in either cooked binary or JSON form.
 template<typename T>
 void loadFromBuffer(T* that, const byte buffer[], std::size_t bufferLength) {
-    std::istringstream stream{std::string{reinterpret_cast<const char*>(buffer), bufferLength}};
+    if (isCooked(buffer, bufferLength)) {
+        BufferStreamBuffer streamBuffer{buffer + COOKED_SIGNATURE.size(), bufferLength - COOKED_SIGNATURE.size()};
+        std::istream stream{&streamBuffer};
+        cereal::BinaryInputArchive archive{stream};
+        that->serialize(archive);
+        return;
+    }
+    BufferStreamBuffer streamBuffer{buffer, bufferLength};
+    std::istream stream{&streamBuffer};
     cereal::JSONInputArchive archive{stream};
     that->serialize(archive);
 }
 
+/// Writes the cooked form of a descriptor that was loaded with loadFromBuffer.
+template<typename T>
+void saveCooked(T* that, std::ostream& stream) {
+    stream.write(COOKED_SIGNATURE.data(), static_cast<std::streamsize>(COOKED_SIGNATURE.size()));
+    cereal::BinaryOutputArchive archive{stream};
+    that->serialize(archive);
+}
+
 } // namespace chira::Serial
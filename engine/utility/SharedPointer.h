@@ -1,5 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <concepts>
+#include <new>
+#include <utility>
 #include <core/Assertions.h>
 
 namespace chira {
@@ -12,86 +17,144 @@ enum class CastType {
     C_CAST
 };
 
-struct SharedPointerMetadata {
-    unsigned int refCount = 1;
-    /// If the refcount is less than or equal to this number in the destructor (after it is subtracted once),
-    /// this is the last holder of the pointer and sharedPointer::ptr will be deleted.\n
-    /// 1 is the regular value, because this class is intended to be used as a resource, and the resource
-    /// manager always holds 1 copy of the pointer.
-    unsigned int holderAmountForDelete = 1;
-    SharedPointerMetadata() = default;
-    explicit SharedPointerMetadata(unsigned int refCount_) : refCount(refCount_) {}
-    SharedPointerMetadata(unsigned int refCount_, unsigned int holderAmountForDelete_) : refCount(refCount_), holderAmountForDelete(holderAmountForDelete_) {}
-    SharedPointerMetadata(const SharedPointerMetadata& other) = delete;
-    SharedPointerMetadata& operator=(const SharedPointerMetadata& other) = delete;
-    SharedPointerMetadata(SharedPointerMetadata&& other) = delete;
-    SharedPointerMetadata& operator=(SharedPointerMetadata&& other) = delete;
+/// The reference counts shared by every SharedPointer and WeakPointer to the same object.
+/// Both counts are atomic, pointers to the same object can be copied and dropped on any thread.
+class SharedPointerControlBlock {
+public:
+    SharedPointerControlBlock() = default;
+    virtual ~SharedPointerControlBlock() = default;
+    SharedPointerControlBlock(const SharedPointerControlBlock& other) = delete;
+    SharedPointerControlBlock& operator=(const SharedPointerControlBlock& other) = delete;
+    SharedPointerControlBlock(SharedPointerControlBlock&& other) = delete;
+    SharedPointerControlBlock& operator=(SharedPointerControlBlock&& other) = delete;
+
+    void addStrongReference() noexcept {
+        this->strongCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    void releaseStrongReference() noexcept {
+        if (this->strongCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            this->destroyObject();
+            this->releaseWeakReference();
+        }
+    }
+    /// Adds a strong reference only if the object is still alive.
+    [[nodiscard]] bool tryAddStrongReference() noexcept {
+        auto count = this->strongCount.load(std::memory_order_relaxed);
+        while (count != 0) {
+            if (this->strongCount.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+    void addWeakReference() noexcept {
+        this->weakCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    void releaseWeakReference() noexcept {
+        if (this->weakCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+    [[nodiscard]] unsigned int getStrongCount() const noexcept {
+        return this->strongCount.load(std::memory_order_acquire);
+    }
+protected:
+    /// Called once, when the last strong reference is released.
+    virtual void destroyObject() noexcept = 0;
+private:
+    std::atomic<unsigned int> strongCount = 1;
+    /// Every strong reference together holds one weak reference, so the block outlives the object
+    std::atomic<unsigned int> weakCount = 1;
 };
 
+/// Owns an object that was allocated separately.
+template<typename T>
+class SharedPointerAdoptingControlBlock : public SharedPointerControlBlock {
+public:
+    explicit SharedPointerAdoptingControlBlock(T* ptr_) : ptr(ptr_) {}
+protected:
+    void destroyObject() noexcept override {
+        delete this->ptr;
+    }
+private:
+    T* ptr;
+};
+
+/// Stores the object right after the counts, so both live in a single allocation.
+template<typename T>
+class SharedPointerInlineControlBlock : public SharedPointerControlBlock {
+public:
+    template<typename... Args>
+    explicit SharedPointerInlineControlBlock(Args&&... args) {
+        new (this->storage) T(std::forward<Args>(args)...);
+    }
+    [[nodiscard]] T* get() noexcept {
+        return std::launder(reinterpret_cast<T*>(this->storage));
+    }
+protected:
+    void destroyObject() noexcept override {
+        this->get()->~T();
+    }
+private:
+    alignas(T) std::byte storage[sizeof(T)];
+};
+
+template<typename T> class WeakPointer;
+
 template<typename T> class SharedPointer {
+    template<typename U> friend class SharedPointer;
+    template<typename U> friend class WeakPointer;
 public:
     SharedPointer() = default;
-    explicit SharedPointer(T* inputPtr) : ptr(inputPtr), data(new SharedPointerMetadata{1}) {}
-    SharedPointer(T* inputPtr, SharedPointerMetadata* data_) : ptr(inputPtr), data(data_) {
-        if (this->data) {
-            this->data->refCount++;
-        }
+    /// Takes ownership of an object allocated with new. Prefer SharedPointer::make, it only allocates once.
+    explicit SharedPointer(T* inputPtr)
+            : ptr(inputPtr)
+            , block(inputPtr ? new SharedPointerAdoptingControlBlock<T>{inputPtr} : nullptr) {}
+    SharedPointer(const SharedPointer<T>& other) noexcept
+            : ptr(other.ptr)
+            , block(other.block) {
+        if (this->block)
+            this->block->addStrongReference();
     }
+    SharedPointer(SharedPointer<T>&& other) noexcept
+            : ptr(std::exchange(other.ptr, nullptr))
+            , block(std::exchange(other.block, nullptr)) {}
+    template<typename U> requires std::convertible_to<U*, T*>
+    SharedPointer(const SharedPointer<U>& other) noexcept // NOLINT(google-explicit-constructor)
+            : ptr(other.ptr)
+            , block(other.block) {
+        if (this->block)
+            this->block->addStrongReference();
+    }
+    template<typename U> requires std::convertible_to<U*, T*>
+    SharedPointer(SharedPointer<U>&& other) noexcept // NOLINT(google-explicit-constructor)
+            : ptr(std::exchange(other.ptr, nullptr))
+            , block(std::exchange(other.block, nullptr)) {}
     SharedPointer<T>& operator=(const SharedPointer<T>& other) noexcept {
-        if (this == &other)
-            return *this;
-
-        if ((this->data) && (this->data->refCount <= this->data->holderAmountForDelete)) {
-            delete this->ptr;
-            delete this->data;
-        }
-        this->ptr = other.ptr;
-        this->data = other.data;
-        if (this->data) {
-            this->data->refCount++;
-        }
+        SharedPointer<T>{other}.swap(*this);
         return *this;
     }
-    SharedPointer(const SharedPointer<T>& other) noexcept {
-        if (this == &other)
-            return;
-
-        if ((this->data) && (this->data->refCount <= this->data->holderAmountForDelete)) {
-            delete this->ptr;
-            delete this->data;
-        }
-        this->ptr = other.ptr;
-        this->data = other.data;
-        if (this->data) {
-            this->data->refCount++;
-        }
-    }
     SharedPointer<T>& operator=(SharedPointer<T>&& other) noexcept {
-        if ((this->data) && (this->data->refCount <= this->data->holderAmountForDelete)) {
-            delete this->ptr;
-            delete this->data;
-        }
-        this->ptr = other.ptr;
-        this->data = other.data;
-        other.ptr = nullptr;
-        other.data = nullptr;
+        SharedPointer<T>{std::move(other)}.swap(*this);
         return *this;
     }
-    SharedPointer(SharedPointer<T>&& other) noexcept {
-        *this = std::move(other);
-    }
     ~SharedPointer() {
-        if (!this->data) {
-            delete this->ptr;
-            return;
-        }
-        this->data->refCount--;
-        if (this->data->refCount == this->data->holderAmountForDelete) {
-            delete this->ptr;
-        }
-        if (this->data->refCount == 0) {
-            delete this->data;
-        }
+        if (this->block)
+            this->block->releaseStrongReference();
+    }
+
+    /// Constructs the object and its reference counts in one allocation.
+    template<typename... Args>
+    [[nodiscard]] static SharedPointer<T> make(Args&&... args) {
+        auto* inlineBlock = new SharedPointerInlineControlBlock<T>{std::forward<Args>(args)...};
+        return SharedPointer<T>{inlineBlock->get(), inlineBlock};
+    }
+
+    void swap(SharedPointer<T>& other) noexcept {
+        std::swap(this->ptr, other.ptr);
+        std::swap(this->block, other.block);
+    }
+    void reset() noexcept {
+        SharedPointer<T>{}.swap(*this);
     }
     T* get() const noexcept {
         return this->ptr;
@@ -108,39 +171,28 @@ public:
     bool operator!() const {
         return !(bool(this->ptr));
     }
+    /// The number of strong references. Weak references are not counted.
     [[nodiscard]] unsigned int useCount() const {
-        if (this->data)
-            return this->data->refCount;
+        if (this->block)
+            return this->block->getStrongCount();
         else
             return 0;
     }
-    [[nodiscard]] unsigned int getHolderAmountForDelete() const {
-        if (this->data) {
-            return this->data->holderAmountForDelete;
-        } else {
-            return 0;
-        }
-    }
-    void setHolderAmountForDelete(unsigned int newHolderAmountForDelete) const {
-        if (this->data) {
-            this->data->holderAmountForDelete = newHolderAmountForDelete;
-        }
-    }
     template<typename U>
     SharedPointer<U> castStatic() const {
-        return SharedPointer<U>(static_cast<U*>(this->ptr), this->data);
+        return this->alias(static_cast<U*>(this->ptr));
     }
     template<typename U>
     SharedPointer<U> castDynamic() const {
-        return SharedPointer<U>(dynamic_cast<U*>(this->ptr), this->data);
+        return this->alias(dynamic_cast<U*>(this->ptr));
     }
     template<typename U>
     SharedPointer<U> castAssert() const {
-        return SharedPointer<U>(assert_cast<U*>(this->ptr), this->data);
+        return this->alias(assert_cast<U*>(this->ptr));
     }
     template<typename U>
     SharedPointer<U> castReinterpret() const {
-        return SharedPointer<U>(reinterpret_cast<U*>(this->ptr), this->data);
+        return this->alias(reinterpret_cast<U*>(this->ptr));
     }
     template<typename U>
     SharedPointer<U> cast(CastType type = CastType::ASSERT_CAST) const {
@@ -155,13 +207,85 @@ public:
             case ASSERT_CAST:
                 return this->castAssert<U>();
             case C_CAST:
-                return SharedPointer<U>((U*)(this->ptr), this->data);
+                return this->alias((U*)(this->ptr));
             CHIRA_NO_DEFAULT;
         }
     }
-protected:
+private:
+    /// Adopts a strong reference that was already added to the block.
+    SharedPointer(T* ptr_, SharedPointerControlBlock* block_) noexcept
+            : ptr(ptr_)
+            , block(block_) {}
+
+    template<typename U>
+    SharedPointer<U> alias(U* otherPtr) const noexcept {
+        if (this->block)
+            this->block->addStrongReference();
+        return SharedPointer<U>{otherPtr, this->block};
+    }
+
+    T* ptr = nullptr;
+    SharedPointerControlBlock* block = nullptr;
+};
+
+/// Observes an object owned by SharedPointers without keeping it alive.
+template<typename T> class WeakPointer {
+public:
+    WeakPointer() = default;
+    WeakPointer(const SharedPointer<T>& shared) noexcept // NOLINT(google-explicit-constructor)
+            : ptr(shared.ptr)
+            , block(shared.block) {
+        if (this->block)
+            this->block->addWeakReference();
+    }
+    WeakPointer(const WeakPointer<T>& other) noexcept
+            : ptr(other.ptr)
+            , block(other.block) {
+        if (this->block)
+            this->block->addWeakReference();
+    }
+    WeakPointer(WeakPointer<T>&& other) noexcept
+            : ptr(std::exchange(other.ptr, nullptr))
+            , block(std::exchange(other.block, nullptr)) {}
+    WeakPointer<T>& operator=(const WeakPointer<T>& other) noexcept {
+        WeakPointer<T>{other}.swap(*this);
+        return *this;
+    }
+    WeakPointer<T>& operator=(WeakPointer<T>&& other) noexcept {
+        WeakPointer<T>{std::move(other)}.swap(*this);
+        return *this;
+    }
+    ~WeakPointer() {
+        if (this->block)
+            this->block->releaseWeakReference();
+    }
+
+    void swap(WeakPointer<T>& other) noexcept {
+        std::swap(this->ptr, other.ptr);
+        std::swap(this->block, other.block);
+    }
+    void reset() noexcept {
+        WeakPointer<T>{}.swap(*this);
+    }
+    /// Returns a strong reference to the object, or an empty pointer if it was already destroyed.
+    [[nodiscard]] SharedPointer<T> lock() const noexcept {
+        if (this->block && this->block->tryAddStrongReference())
+            return SharedPointer<T>{this->ptr, this->block};
+        return SharedPointer<T>{};
+    }
+    [[nodiscard]] bool expired() const noexcept {
+        return this->useCount() == 0;
+    }
+    /// The number of strong references to the object.
+    [[nodiscard]] unsigned int useCount() const noexcept {
+        if (this->block)
+            return this->block->getStrongCount();
+        else
+            return 0;
+    }
+private:
     T* ptr = nullptr;
-    SharedPointerMetadata* data = nullptr;
+    SharedPointerControlBlock* block = nullptr;
 };
 
 } // namespace chira
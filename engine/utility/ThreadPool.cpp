@@ -0,0 +1,92 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+using namespace chira;
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    threadCount = std::max(threadCount, 1u);
+    this->workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        this->workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::scoped_lock lock{this->tasksMutex};
+        this->stopping = true;
+    }
+    this->tasksAvailable.notify_all();
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (count == 0)
+        return;
+    // Workers can pick up their task after this returns, so they share the state instead of borrowing it
+    struct ParallelForState {
+        std::atomic<std::size_t> next = 0;
+        std::size_t finished = 0;
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::condition_variable allFinished;
+    };
+    auto state = std::make_shared<ParallelForState>();
+    // The task is only touched after claiming an index, and every index is claimed before this returns
+    const auto run = [state, count, task = &task] {
+        for (std::size_t i = state->next++; i < count; i = state->next++) {
+            std::exception_ptr exception;
+            try {
+                (*task)(i);
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            std::scoped_lock lock{state->mutex};
+            if (exception && !state->exception)
+                state->exception = exception;
+            if (++state->finished == count)
+                state->allFinished.notify_all();
+        }
+    };
+    const auto helpers = std::min(count, this->workers.size() + 1) - 1;
+    for (std::size_t i = 0; i < helpers; i++) {
+        this->submit(run);
+    }
+    run();
+
+    std::unique_lock lock{state->mutex};
+    state->allFinished.wait(lock, [&state, count] {
+        return state->finished == count;
+    });
+    if (state->exception)
+        std::rethrow_exception(state->exception);
+}
+
+unsigned int ThreadPool::getDefaultThreadCount() {
+    // hardware_concurrency is allowed to return 0 if it can't tell
+    return std::max(std::thread::hardware_concurrency(), 2u) - 1;
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{this->tasksMutex};
+            this->tasksAvailable.wait(lock, [this] {
+                return this->stopping || !this->tasks.empty();
+            });
+            if (this->tasks.empty()) {
+                // Only reachable when stopping
+                return;
+            }
+            task = std::move(this->tasks.front());
+            this->tasks.pop_front();
+        }
+        task();
+    }
+}
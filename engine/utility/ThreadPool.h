@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "NoCopyOrMove.h"
+
+namespace chira {
+
+/// A fixed-size pool of worker threads that run submitted tasks in FIFO order.
+class ThreadPool : public NoCopyOrMove {
+public:
+    explicit ThreadPool(unsigned int threadCount = ThreadPool::getDefaultThreadCount());
+    /// Finishes every task that was already submitted, then joins the workers.
+    ~ThreadPool();
+
+    template<typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task) {
+        using ReturnType = std::invoke_result_t<F>;
+        // std::function must be copyable, std::packaged_task is not
+        auto packagedTask = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<F>(task));
+        auto future = packagedTask->get_future();
+        {
+            std::scoped_lock lock{this->tasksMutex};
+            this->tasks.emplace_back([packagedTask] { (*packagedTask)(); });
+        }
+        this->tasksAvailable.notify_one();
+        return future;
+    }
+
+    /// Calls task with every index below count, spread over the workers and the calling thread, and returns once all are done.
+    /// The calling thread takes any index no worker has started yet, so this is safe to call from one of the pool's own tasks.
+    /// If any call throws, the first exception is rethrown after the rest have finished.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+    [[nodiscard]] std::size_t getThreadCount() const {
+        return this->workers.size();
+    }
+
+    /// One less than the hardware concurrency, so the main thread keeps a core to itself.
+    [[nodiscard]] static unsigned int getDefaultThreadCount();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex tasksMutex;
+    std::condition_variable tasksAvailable;
+    bool stopping = false;
+};
+
+} // namespace chira
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <TestHelpers.h>
+#include <loader/mesh/ChiraMeshLoader.h>
+#include <resource/provider/MemoryResourceProvider.h>
+
+using namespace chira;
+
+namespace {
+
+const std::vector<Vertex> TEST_VERTICES{
+        {{-1, 0, 2}, {0, 0, 1}, {1, 0.5f, 0}, {0.25f, 0.75f}},
+        {{ 1, 0, 2}, {0, 1, 0}, {0, 0, 1},    {1, 0}},
+        {{ 1, 3, 2}, {1, 0, 0}, {1, 1, 1},    {0.5f, 1}},
+};
+
+ChiraMeshHeaderV2 readHeaderV2(const std::vector<byte>& mesh) {
+    ChiraMeshHeaderV2 header;
+    std::memcpy(&header, mesh.data() + CHIRA_MESH_HEADER_SIZE, CHIRA_MESH_HEADER_V2_SIZE);
+    return header;
+}
+
+} // namespace
+
+TEST(ChiraMeshLoader, createAndLoadMesh) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"cmdltest"};
+    Resource::addResourceProvider(provider);
+    const std::vector<Index> indices{0, 1, 2};
+    const auto mesh = ChiraMeshLoader{}.createMesh(TEST_VERTICES, indices);
+
+    const auto header = readHeaderV2(mesh);
+    EXPECT_EQ(header.flags, CHIRA_MESH_FLAG_NONE);
+    EXPECT_EQ(header.vertexStride, sizeof(Vertex));
+    EXPECT_EQ(header.indexSize, sizeof(std::uint16_t));
+    EXPECT_EQ(header.indexOffset % CHIRA_MESH_SECTION_ALIGNMENT, 0);
+    EXPECT_FLOAT_EQ(header.boundsMin[0], -1.f);
+    EXPECT_FLOAT_EQ(header.boundsMax[1], 3.f);
+    EXPECT_FLOAT_EQ(header.sphereCenter[1], 1.5f);
+    EXPECT_FLOAT_EQ(header.sphereRadius, std::sqrt(1.f + 1.5f * 1.5f));
+
+    provider->setResource("plain.cmdl", mesh);
+    std::vector<Vertex> vertices;
+    std::vector<Index> loadedIndices;
+    ChiraMeshLoader{}.loadMesh("cmdltest://plain.cmdl", vertices, loadedIndices);
+    EXPECT_EQ(vertices, TEST_VERTICES);
+    EXPECT_EQ(loadedIndices, indices);
+    Resource::discardAll();
+}
+
+TEST(ChiraMeshLoader, quantizedCompressedMesh) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"cmdltest"};
+    Resource::addResourceProvider(provider);
+    // Enough repetition to compress, and an index that doesn't fit in 16 bits
+    std::vector<Index> indices;
+    for (int i = 0; i < 1000; i++) {
+        indices.push_back(0);
+        indices.push_back(1);
+        indices.push_back(2);
+    }
+    indices.push_back(70000);
+    const auto mesh = ChiraMeshLoader{CHIRA_MESH_FLAG_QUANTIZED | CHIRA_MESH_FLAG_COMPRESSED}.createMesh(TEST_VERTICES, indices);
+
+    const auto header = readHeaderV2(mesh);
+    EXPECT_EQ(header.flags, CHIRA_MESH_FLAG_QUANTIZED | CHIRA_MESH_FLAG_COMPRESSED);
+    EXPECT_EQ(header.vertexStride, 28);
+    EXPECT_EQ(header.indexSize, sizeof(std::uint32_t));
+    EXPECT_LT(header.compressedSize, header.payloadSize);
+
+    provider->setResource("quantized.cmdl", mesh);
+    std::vector<Vertex> vertices;
+    std::vector<Index> loadedIndices;
+    ChiraMeshLoader{}.loadMesh("cmdltest://quantized.cmdl", vertices, loadedIndices);
+    EXPECT_EQ(loadedIndices, indices);
+    ASSERT_EQ(vertices.size(), TEST_VERTICES.size());
+    for (std::size_t i = 0; i < vertices.size(); i++) {
+        EXPECT_EQ(vertices[i].position, TEST_VERTICES[i].position);
+        EXPECT_NEAR(vertices[i].normal.g, TEST_VERTICES[i].normal.g, 0.0001f);
+        EXPECT_NEAR(vertices[i].color.g, TEST_VERTICES[i].color.g, 1.f / 255.f);
+        EXPECT_NEAR(vertices[i].uv.r, TEST_VERTICES[i].uv.r, 0.001f);
+    }
+    Resource::discardAll();
+}
+
+TEST(ChiraMeshLoader, meshWithLODs) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"cmdltest"};
+    Resource::addResourceProvider(provider);
+    const std::vector<Index> indices{0, 1, 2, 2, 1, 0};
+    const std::vector<MeshLOD> lods{{{0, 1, 2}, 0.5f}, {{2, 1, 0}, 1.5f}};
+    const auto mesh = ChiraMeshLoader{CHIRA_MESH_FLAG_COMPRESSED}.createMeshWithLODs(TEST_VERTICES, indices, lods);
+    EXPECT_TRUE(readHeaderV2(mesh).flags & CHIRA_MESH_FLAG_LODS);
+    provider->setResource("lods.cmdl", mesh);
+
+    // The LODs index the vertices they were loaded with, not the ones already there
+    std::vector<Vertex> vertices{Vertex{}};
+    std::vector<Index> loadedIndices{0};
+    std::vector<MeshLOD> loadedLODs;
+    Bounds bounds;
+    ChiraMeshLoader{}.loadMeshWithLODs("cmdltest://lods.cmdl", vertices, loadedIndices, loadedLODs, bounds);
+    EXPECT_EQ(vertices.size(), 4);
+    // Read from the header, and only covering the loaded vertices
+    EXPECT_FLOAT_EQ(bounds.min.x, -1.f);
+    EXPECT_FLOAT_EQ(bounds.min.z, 2.f);
+    EXPECT_FLOAT_EQ(bounds.radius, std::sqrt(1.f + 1.5f * 1.5f));
+    EXPECT_EQ(loadedIndices, (std::vector<Index>{0, 1, 2, 3, 3, 2, 1}));
+    ASSERT_EQ(loadedLODs.size(), 2);
+    EXPECT_EQ(loadedLODs[0].indices, (std::vector<Index>{1, 2, 3}));
+    EXPECT_FLOAT_EQ(loadedLODs[0].error, 0.5f);
+    EXPECT_EQ(loadedLODs[1].indices, (std::vector<Index>{3, 2, 1}));
+    EXPECT_FLOAT_EQ(loadedLODs[1].error, 1.5f);
+
+    // Loaders that don't ask for LODs skip them
+    vertices.clear();
+    loadedIndices.clear();
+    ChiraMeshLoader{}.loadMesh("cmdltest://lods.cmdl", vertices, loadedIndices);
+    EXPECT_EQ(loadedIndices, indices);
+    Resource::discardAll();
+}
+
+TEST(ChiraMeshLoader, loadVersion1) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"cmdltest"};
+    Resource::addResourceProvider(provider);
+    const std::vector<Index> indices{2, 1, 0};
+    const ChiraMeshHeader header{1, static_cast<unsigned int>(TEST_VERTICES.size()), static_cast<unsigned int>(indices.size())};
+    std::vector<byte> mesh(CHIRA_MESH_HEADER_SIZE + TEST_VERTICES.size() * sizeof(Vertex) + indices.size() * sizeof(Index));
+    std::memcpy(mesh.data(), &header, CHIRA_MESH_HEADER_SIZE);
+    std::memcpy(mesh.data() + CHIRA_MESH_HEADER_SIZE, TEST_VERTICES.data(), TEST_VERTICES.size() * sizeof(Vertex));
+    std::memcpy(mesh.data() + CHIRA_MESH_HEADER_SIZE + TEST_VERTICES.size() * sizeof(Vertex), indices.data(), indices.size() * sizeof(Index));
+    provider->setResource("version1.cmdl", mesh);
+
+    // Loading on top of another mesh moves the indices past its vertices
+    std::vector<Vertex> vertices{Vertex{}};
+    std::vector<Index> loadedIndices{0};
+    ChiraMeshLoader{}.loadMesh("cmdltest://version1.cmdl", vertices, loadedIndices);
+    ASSERT_EQ(vertices.size(), 4);
+    EXPECT_EQ(vertices[1], TEST_VERTICES[0]);
+    EXPECT_EQ(loadedIndices, (std::vector<Index>{0, 3, 2, 1}));
+    Resource::discardAll();
+}
+
+TEST(ChiraMeshLoader, rejectTruncatedMesh) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"cmdltest"};
+    Resource::addResourceProvider(provider);
+    auto mesh = ChiraMeshLoader{}.createMesh(TEST_VERTICES, {0, 1, 2});
+    mesh.resize(mesh.size() - CHIRA_MESH_SECTION_ALIGNMENT);
+    provider->setResource("truncated.cmdl", mesh);
+
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    ChiraMeshLoader{}.loadMesh("cmdltest://truncated.cmdl", vertices, indices);
+    EXPECT_TRUE(vertices.empty());
+    EXPECT_TRUE(indices.empty());
+    Resource::discardAll();
+}
+
+TEST(ChiraMeshLoader, rejectOversizedPayload) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"cmdltest"};
+    Resource::addResourceProvider(provider);
+    // Enough repetition to compress
+    std::vector<Index> indices;
+    for (int i = 0; i < 1000; i++) {
+        indices.insert(indices.end(), {0, 1, 2});
+    }
+    auto mesh = ChiraMeshLoader{CHIRA_MESH_FLAG_COMPRESSED}.createMesh(TEST_VERTICES, indices);
+    auto header = readHeaderV2(mesh);
+    ASSERT_TRUE(header.flags & CHIRA_MESH_FLAG_COMPRESSED);
+    // Far more than the compressed data could ever decompress to
+    header.payloadSize = 0x7FFFFFFF;
+    std::memcpy(mesh.data() + CHIRA_MESH_HEADER_SIZE, &header, CHIRA_MESH_HEADER_V2_SIZE);
+    provider->setResource("oversized.cmdl", mesh);
+
+    std::vector<Vertex> vertices;
+    std::vector<Index> loadedIndices;
+    ChiraMeshLoader{}.loadMesh("cmdltest://oversized.cmdl", vertices, loadedIndices);
+    EXPECT_TRUE(vertices.empty());
+    EXPECT_TRUE(loadedIndices.empty());
+    Resource::discardAll();
+}
+
+TEST(ChiraMeshLoader, logMissingMesh) {
+    PREINIT_ENGINE();
+    Resource::addResourceProvider(new MemoryResourceProvider{"cmdltest"});
+    LOG_BEGIN();
+
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    ChiraMeshLoader{}.loadMesh("cmdltest://missing.cmdl", vertices, indices);
+    EXPECT_TRUE(vertices.empty());
+    EXPECT_TRUE(indices.empty());
+    EXPECT_EQ(LOG_LAST_TYPE, LogType::LOG_ERROR);
+    EXPECT_STREQ(LOG_LAST_SOURCE, "CMDL");
+
+    LOG_END();
+    Resource::discardAll();
+}
+
+TEST(ChiraMeshLoader, rejectOutOfRangeIndices) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"cmdltest"};
+    Resource::addResourceProvider(provider);
+    auto mesh = ChiraMeshLoader{}.createMesh(TEST_VERTICES, {0, 1, 2});
+    // Point the last index one past the vertices
+    const std::uint16_t badIndex = 3;
+    std::memcpy(mesh.data() + CHIRA_MESH_PAYLOAD_OFFSET + readHeaderV2(mesh).indexOffset + 2 * sizeof(std::uint16_t), &badIndex, sizeof(badIndex));
+    provider->setResource("out_of_range.cmdl", mesh);
+
+    auto lodMesh = ChiraMeshLoader{}.createMeshWithLODs(TEST_VERTICES, {0, 1, 2}, {{{0, 1, 3}, 1.f}});
+    provider->setResource("out_of_range_lod.cmdl", lodMesh);
+
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    ChiraMeshLoader{}.loadMesh("cmdltest://out_of_range.cmdl", vertices, indices);
+    EXPECT_TRUE(vertices.empty());
+    EXPECT_TRUE(indices.empty());
+
+    std::vector<MeshLOD> lods;
+    Bounds bounds;
+    ChiraMeshLoader{}.loadMeshWithLODs("cmdltest://out_of_range_lod.cmdl", vertices, indices, lods, bounds);
+    EXPECT_TRUE(vertices.empty());
+    EXPECT_TRUE(indices.empty());
+    EXPECT_TRUE(lods.empty());
+    Resource::discardAll();
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <TestHelpers.h>
+#include <config/ConEntry.h>
+#include <loader/mesh/OBJMeshLoader.h>
+#include <resource/provider/MemoryResourceProvider.h>
+
+using namespace chira;
+
+namespace {
+
+void setOBJ(MemoryResourceProvider* provider, std::string_view name, std::string_view obj) {
+    provider->setResource(name, std::vector<byte>{obj.begin(), obj.end()});
+}
+
+} // namespace
+
+TEST(OBJMeshLoader, triangulatePolygons) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"objtest"};
+    Resource::addResourceProvider(provider);
+    setOBJ(provider, "quad.obj",
+           "# A quad\n"
+           "v 0 0 0\nv 1 0 0\r\nv 1 1 0\nv +0 1 0 # with a comment\n"
+           "vt 0 0\nvt 1\n"
+           "vn 0 0 1\n"
+           "g quad\n"
+           "f 1/1/1 2/2/1 3/1/1 4/2/1\n");
+
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    OBJMeshLoader{}.loadMesh("objtest://quad.obj", vertices, indices);
+    EXPECT_EQ(vertices.size(), 4);
+    EXPECT_EQ(indices, (std::vector<Index>{0, 1, 2, 0, 2, 3}));
+    EXPECT_FLOAT_EQ(vertices[1].uv.r, 1.f);
+    EXPECT_FLOAT_EQ(vertices[1].uv.g, 0.f);
+    EXPECT_FLOAT_EQ(vertices[3].normal.b, 1.f);
+    Resource::discardAll();
+}
+
+TEST(OBJMeshLoader, negativeIndices) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"objtest"};
+    Resource::addResourceProvider(provider);
+    setOBJ(provider, "negative.obj",
+           "v 0 0 0\nv 1 0 0\nv 1 1 0\nf -3 -2 -1\n"
+           "v 0 0 1\nv 1 0 1\nv 1 1 1\nvn 0 1 0\nf -3//-1 -2//-1 -1//-1\n");
+
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    OBJMeshLoader{}.loadMesh("objtest://negative.obj", vertices, indices);
+    ASSERT_EQ(vertices.size(), 6);
+    EXPECT_EQ(indices, (std::vector<Index>{0, 1, 2, 3, 4, 5}));
+    EXPECT_FLOAT_EQ(vertices[3].position.z, 1.f);
+    EXPECT_FLOAT_EQ(vertices[3].normal.g, 1.f);
+    Resource::discardAll();
+}
+
+TEST(OBJMeshLoader, skipInvalidFaces) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"objtest"};
+    Resource::addResourceProvider(provider);
+    setOBJ(provider, "invalid.obj", "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2\nf 1 2 9\nf 1 2 x\nf 1 2 3\n");
+
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    OBJMeshLoader{}.loadMesh("objtest://invalid.obj", vertices, indices);
+    // Bad faces shouldn't leave unused vertices behind
+    EXPECT_EQ(vertices.size(), 3);
+    EXPECT_EQ(indices, (std::vector<Index>{0, 1, 2}));
+    Resource::discardAll();
+}
+
+TEST(OBJMeshLoader, parseInChunks) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"objtest"};
+    Resource::addResourceProvider(provider);
+    // Big enough to be split into several chunks once the chunk size is 1 kilobyte
+    constexpr int size = 32;
+    std::string obj;
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            obj += "v " + std::to_string(x) + " 0 " + std::to_string(y) + '\n';
+        }
+    }
+    obj += "vn 0 1 0\n";
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            const auto corner = [](int index) {
+                return std::to_string(index) + "//1 ";
+            };
+            const int first = y * (size + 1) + x + 1;
+            obj += "f " + corner(first) + corner(first + 1) + corner(first + size + 2) + corner(first + size + 1) + '\n';
+        }
+    }
+    // Negative indices that point back across chunks
+    obj += "v 5 5 5\nf -1 -2 -3\n";
+    setOBJ(provider, "grid.obj", obj);
+
+    ConVarRef obj_loader_chunk_kb{"obj_loader_chunk_kb"};
+    const auto oldChunkSize = obj_loader_chunk_kb.getValue<int>();
+
+    obj_loader_chunk_kb.setValue(0);
+    std::vector<Vertex> singleVertices;
+    std::vector<Index> singleIndices;
+    OBJMeshLoader{}.loadMesh("objtest://grid.obj", singleVertices, singleIndices);
+
+    obj_loader_chunk_kb.setValue(1);
+    std::vector<Vertex> chunkedVertices;
+    std::vector<Index> chunkedIndices;
+    OBJMeshLoader{}.loadMesh("objtest://grid.obj", chunkedVertices, chunkedIndices);
+
+    obj_loader_chunk_kb.setValue(oldChunkSize);
+
+    EXPECT_EQ(singleVertices.size(), (size + 1) * (size + 1) + 3);
+    EXPECT_EQ(singleIndices.size(), size * size * 6 + 3);
+    EXPECT_EQ(chunkedVertices, singleVertices);
+    EXPECT_EQ(chunkedIndices, singleIndices);
+    Resource::discardAll();
+}
+
+TEST(OBJMeshLoader, createAndLoadMesh) {
+    PREINIT_ENGINE();
+    auto* provider = new MemoryResourceProvider{"objtest"};
+    Resource::addResourceProvider(provider);
+    const std::vector<Vertex> vertices{
+            {{0.1f, 0, 0}, {0, 0, 1}, {0.25f, 0}},
+            {{1, 0, -3.5f}, {0, 0, 1}, {1, 0}},
+            {{1, 1e-7f, 0}, {0, 1, 0}, {1, 1}},
+    };
+    const std::vector<Index> indices{0, 1, 2, 2, 1, 0};
+
+    const auto obj = OBJMeshLoader{}.createMesh(vertices, indices);
+    provider->setResource("created.obj", obj);
+
+    std::vector<Vertex> loadedVertices;
+    std::vector<Index> loadedIndices;
+    OBJMeshLoader{}.loadMesh("objtest://created.obj", loadedVertices, loadedIndices);
+    // Floats are written exactly, so everything welds back together
+    EXPECT_EQ(loadedVertices, vertices);
+    EXPECT_EQ(loadedIndices, indices);
+    Resource::discardAll();
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <TestHelpers.h>
+
+#include <cmath>
+#include <glm/ext/matrix_transform.hpp>
+#include <math/Bounds.h>
+
+using namespace chira;
+
+namespace {
+
+/// True if the point is inside both the box and the sphere, give or take rounding.
+bool contains(const Bounds& bounds, glm::vec3 point) {
+    constexpr float EPSILON = 0.0001f;
+    for (int i = 0; i < 3; i++) {
+        if (point[i] < bounds.min[i] - EPSILON || point[i] > bounds.max[i] + EPSILON)
+            return false;
+    }
+    return glm::length(point - bounds.center) <= bounds.radius + EPSILON;
+}
+
+} // namespace
+
+TEST(Bounds, fromVertices) {
+    EXPECT_TRUE(Bounds::fromVertices({}).isEmpty());
+
+    const std::vector<Vertex> vertices{Vertex{{-1, 0, 2}}, Vertex{{1, 0, 2}}, Vertex{{1, 3, 2}}};
+    const auto bounds = Bounds::fromVertices(vertices);
+    EXPECT_FALSE(bounds.isEmpty());
+    EXPECT_EQ(bounds.min, glm::vec3(-1, 0, 2));
+    EXPECT_EQ(bounds.max, glm::vec3(1, 3, 2));
+    EXPECT_EQ(bounds.center, glm::vec3(0, 1.5f, 2));
+    EXPECT_FLOAT_EQ(bounds.radius, std::sqrt(1.f + 1.5f * 1.5f));
+}
+
+TEST(Bounds, extendAndMerge) {
+    const std::vector<Vertex> vertices{Vertex{{0, 0, 0}}, Vertex{{4, 0, 0}}, Vertex{{0, -2, 1}}, Vertex{{3, 5, -1}}};
+    Bounds extended;
+    extended.extend(vertices.data(), vertices.size());
+    for (const auto& vertex : vertices) {
+        EXPECT_TRUE(contains(extended, vertex.position));
+    }
+
+    auto merged = Bounds::fromVertices(vertices.data(), 2);
+    merged.merge(Bounds{});
+    merged.merge(Bounds::fromVertices(vertices.data() + 2, 2));
+    EXPECT_EQ(merged.min, Bounds::fromVertices(vertices).min);
+    EXPECT_EQ(merged.max, Bounds::fromVertices(vertices).max);
+    for (const auto& vertex : vertices) {
+        EXPECT_TRUE(contains(merged, vertex.position));
+    }
+}
+
+TEST(Bounds, transform) {
+    const std::vector<Vertex> vertices{Vertex{{-1, -1, -1}}, Vertex{{1, 1, 1}}, Vertex{{1, -1, 0}}};
+    const auto bounds = Bounds::fromVertices(vertices);
+
+    auto model = glm::translate(glm::identity<glm::mat4>(), glm::vec3{10, 0, 0});
+    model = glm::rotate(model, glm::radians(45.f), glm::vec3{0, 0, 1});
+    model = glm::scale(model, glm::vec3{2, 1, 1});
+    const auto world = bounds.transform(model);
+    EXPECT_FLOAT_EQ(world.radius, bounds.radius * 2.f);
+    for (const auto& vertex : vertices) {
+        EXPECT_TRUE(contains(world, glm::vec3{model * glm::vec4{vertex.position, 1.f}}));
+    }
+}
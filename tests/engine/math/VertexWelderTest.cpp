@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <TestHelpers.h>
+
+#include <math/VertexWelder.h>
+
+using namespace chira;
+
+TEST(VertexWelder, weldExact) {
+    std::vector<Vertex> vertices;
+    VertexWelder welder;
+
+    const Vertex a{{0, 0, 0}, {0, 1, 0}, {0, 0}};
+    const Vertex b{{1, 0, 0}, {0, 1, 0}, {1, 0}};
+
+    EXPECT_EQ(welder.weld(vertices, a), 0);
+    EXPECT_EQ(welder.weld(vertices, b), 1);
+    EXPECT_EQ(welder.weld(vertices, a), 0);
+    EXPECT_EQ(welder.weld(vertices, b), 1);
+    EXPECT_EQ(vertices.size(), 2);
+
+    // Differs only by a UV, has to stay separate
+    EXPECT_EQ(welder.weld(vertices, {{0, 0, 0}, {0, 1, 0}, {0, 1}}), 2);
+    // -0 and 0 compare equal
+    EXPECT_EQ(welder.weld(vertices, {{-0.f, 0, 0}, {0, 1, 0}, {0, 0}}), 0);
+    // Close isn't good enough without an epsilon
+    EXPECT_EQ(welder.weld(vertices, {{0.00001f, 0, 0}, {0, 1, 0}, {0, 0}}), 3);
+    EXPECT_EQ(vertices.size(), 4);
+}
+
+TEST(VertexWelder, weldEpsilon) {
+    std::vector<Vertex> vertices;
+    VertexWelder welder{0, 0.001f};
+
+    EXPECT_EQ(welder.weld(vertices, Vertex{{1, 2, 3}}), 0);
+    EXPECT_EQ(welder.weld(vertices, Vertex{{1.0002f, 2, 2.9998f}}), 0);
+    EXPECT_EQ(welder.weld(vertices, Vertex{{1.01f, 2, 3}}), 1);
+    ASSERT_EQ(vertices.size(), 2);
+    // The first vertex in the cell is kept as is
+    EXPECT_FLOAT_EQ(vertices[0].position.x, 1.f);
+}
+
+TEST(VertexWelder, pickUpOutsideChanges) {
+    std::vector<Vertex> vertices;
+    VertexWelder welder;
+
+    vertices.emplace_back(glm::vec3{1, 1, 1});
+    vertices.emplace_back(glm::vec3{2, 2, 2});
+    EXPECT_EQ(welder.weld(vertices, Vertex{{2, 2, 2}}), 1);
+
+    vertices.clear();
+    EXPECT_EQ(welder.weld(vertices, Vertex{{2, 2, 2}}), 0);
+    EXPECT_EQ(vertices.size(), 1);
+}
+
+TEST(VertexWelder, weldLargeGrid) {
+    constexpr int size = 256;
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    VertexWelder welder{(size + 1) * (size + 1)};
+
+    // Every inner corner is shared by four quads, this would take minutes with a linear search
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            const auto corner = [](int cx, int cy) {
+                return Vertex{{static_cast<float>(cx), 0, static_cast<float>(cy)}, {0, 1, 0}, {cx / static_cast<float>(size), cy / static_cast<float>(size)}};
+            };
+            for (const auto& vertex : {corner(x, y), corner(x + 1, y), corner(x + 1, y + 1), corner(x + 1, y + 1), corner(x, y + 1), corner(x, y)}) {
+                indices.push_back(welder.weld(vertices, vertex));
+            }
+        }
+    }
+    EXPECT_EQ(vertices.size(), (size + 1) * (size + 1));
+    EXPECT_EQ(indices.size(), size * size * 6);
+    EXPECT_EQ(indices[0], indices[5]);
+    EXPECT_EQ(indices[2], indices[3]);
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+#include <config/ConEntry.h>
+#include <render/backend/UploadQueue.h>
+
+using namespace chira;
+
+TEST(UploadQueue, runsInOrder) {
+    std::vector<int> order;
+    const auto first = UploadQueue::enqueue(1, [&order] { order.push_back(1); });
+    const auto second = UploadQueue::enqueue(1, [&order] { order.push_back(2); });
+    EXPECT_NE(first, 0);
+    EXPECT_NE(first, second);
+    EXPECT_TRUE(UploadQueue::isPending(second));
+    EXPECT_EQ(UploadQueue::getPendingCount(), 2);
+    EXPECT_EQ(UploadQueue::getPendingSize(), 2);
+
+    UploadQueue::flush();
+    ASSERT_EQ(order.size(), 2);
+    EXPECT_EQ(order[0], 1);
+    EXPECT_EQ(order[1], 2);
+    EXPECT_FALSE(UploadQueue::isPending(second));
+    EXPECT_EQ(UploadQueue::getPendingCount(), 0);
+}
+
+TEST(UploadQueue, cancel) {
+    bool ran = false;
+    const auto ticket = UploadQueue::enqueue(1, [&ran] { ran = true; });
+    UploadQueue::cancel(ticket);
+    UploadQueue::flush();
+    EXPECT_FALSE(ran);
+}
+
+TEST(UploadQueue, runAheadOfQueue) {
+    std::vector<int> order;
+    UploadQueue::enqueue(1, [&order] { order.push_back(1); });
+    const auto second = UploadQueue::enqueue(1, [&order] { order.push_back(2); });
+    UploadQueue::run(second);
+    ASSERT_EQ(order.size(), 1);
+    EXPECT_EQ(order[0], 2);
+    EXPECT_FALSE(UploadQueue::isPending(second));
+
+    // Already ran, so it doesn't run twice
+    UploadQueue::run(second);
+    UploadQueue::flush();
+    EXPECT_EQ(order, (std::vector<int>{2, 1}));
+}
+
+TEST(UploadQueue, updateStaysInSizeBudget) {
+    ConVarRef gpu_upload_budget_kb{"gpu_upload_budget_kb"};
+    const auto oldBudget = gpu_upload_budget_kb.getValue<int>();
+    gpu_upload_budget_kb.setValue(1);
+
+    int uploads = 0;
+    for (int i = 0; i < 3; i++) {
+        UploadQueue::enqueue(1024, [&uploads] { uploads++; });
+    }
+    // Each upload uses up the whole budget
+    UploadQueue::update();
+    EXPECT_EQ(uploads, 1);
+    UploadQueue::update();
+    EXPECT_EQ(uploads, 2);
+    UploadQueue::flush();
+    EXPECT_EQ(uploads, 3);
+
+    gpu_upload_budget_kb.setValue(oldBudget);
+}
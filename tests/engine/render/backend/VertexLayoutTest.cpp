@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <glm/packing.hpp>
+#include <render/backend/VertexLayout.h>
+
+using namespace chira;
+
+TEST(VertexLayout, defaultMatchesVertex) {
+    const VertexLayout layout;
+    EXPECT_TRUE(layout.matchesVertex());
+    EXPECT_EQ(layout.getStride(), sizeof(Vertex));
+    EXPECT_EQ(layout.getOffset(VertexAttribute::NORMAL), offsetof(Vertex, normal));
+    EXPECT_EQ(layout.getOffset(VertexAttribute::COLOR), offsetof(Vertex, color));
+    EXPECT_EQ(layout.getOffset(VertexAttribute::UV), offsetof(Vertex, uv));
+
+    const std::vector<Vertex> vertices{Vertex{{1, 2, 3}, ColorRGB{0, 1, 0}, ColorRG{0.5f, 0.25f}}};
+    const auto packed = layout.pack(vertices);
+    ASSERT_EQ(packed.size(), sizeof(Vertex));
+    EXPECT_EQ(std::memcmp(packed.data(), vertices.data(), sizeof(Vertex)), 0);
+}
+
+TEST(VertexLayout, fitLeavesOutDefaults) {
+    // Every color is white, and there are no normals
+    std::vector<Vertex> vertices{Vertex{{0, 0, 0}, ColorRG{0, 1}}, Vertex{{1, 0, 0}, ColorRG{1, 0}}};
+
+    const auto layout = VertexLayout::fit(vertices);
+    EXPECT_EQ(layout.getFormat(VertexAttribute::POSITION), VertexAttributeFormat::FLOAT);
+    EXPECT_FALSE(layout.hasAttribute(VertexAttribute::NORMAL));
+    EXPECT_FALSE(layout.hasAttribute(VertexAttribute::COLOR));
+    EXPECT_EQ(layout.getFormat(VertexAttribute::UV), VertexAttributeFormat::UNORM16);
+    EXPECT_EQ(layout.getStride(), 16);
+
+    EXPECT_EQ(VertexLayout::fit(vertices, false).getStride(), 20);
+
+    // Half floats are used when the UVs don't fit between 0 and 1
+    vertices[1].uv.r = 2.f;
+    EXPECT_EQ(VertexLayout::fit(vertices).getFormat(VertexAttribute::UV), VertexAttributeFormat::HALF_FLOAT);
+}
+
+TEST(VertexLayout, packQuantized) {
+    const std::vector<Vertex> vertices{Vertex{{1, 2, 3}, ColorRGB{0, 1, 0.5f}, ColorRGB{1, 0, 0}, ColorRG{0.5f, 0.25f}}};
+    const auto layout = VertexLayout::fit(vertices);
+    ASSERT_EQ(layout, (VertexLayout{VertexAttributeFormat::FLOAT, VertexAttributeFormat::SNORM16, VertexAttributeFormat::UNORM8, VertexAttributeFormat::UNORM16}));
+    // Normals are padded to 4 components, so the colors stay aligned
+    EXPECT_EQ(layout.getOffset(VertexAttribute::COLOR), 20);
+    EXPECT_EQ(layout.getStride(), 28);
+
+    const auto packed = layout.pack(vertices);
+    ASSERT_EQ(packed.size(), 28);
+    const auto readWord = [&packed](std::size_t offset) {
+        std::uint32_t word;
+        std::memcpy(&word, packed.data() + offset, sizeof(word));
+        return word;
+    };
+    float position[3];
+    std::memcpy(position, packed.data(), sizeof(position));
+    EXPECT_FLOAT_EQ(position[2], 3.f);
+    EXPECT_NEAR(glm::unpackSnorm2x16(readWord(12)).y, 1.f, 0.0001f);
+    EXPECT_NEAR(glm::unpackSnorm2x16(readWord(16)).x, 0.5f, 0.0001f);
+    EXPECT_EQ(glm::unpackUnorm4x8(readWord(20)), glm::vec4(1, 0, 0, 1));
+    EXPECT_NEAR(glm::unpackUnorm2x16(readWord(24)).y, 0.25f, 0.0001f);
+}
+
+TEST(VertexLayout, indexSize) {
+    EXPECT_EQ(getIndexSize(65536), 2);
+    EXPECT_EQ(getIndexSize(65537), 4);
+
+    const auto packed = packIndices({0, 1, 65535}, 2);
+    ASSERT_EQ(packed.size(), 6);
+    std::uint16_t last;
+    std::memcpy(&last, packed.data() + 4, sizeof(last));
+    EXPECT_EQ(last, 65535);
+    EXPECT_EQ(packIndices({0, 1, 65536}, 4).size(), 12);
+}
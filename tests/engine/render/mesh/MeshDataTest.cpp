@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <string_view>
+#include <TestHelpers.h>
+#include <config/ConEntry.h>
+#include <loader/mesh/ChiraMeshLoader.h>
+#include <render/mesh/MeshDataBuilder.h>
+#include <render/mesh/MeshDataResource.h>
+#include <resource/provider/MemoryResourceProvider.h>
+
+using namespace chira;
+
+namespace {
+
+/// Does the CPU side of uploading a builder, so its bookkeeping can be checked without a renderer.
+class TestMeshBuilder : public MeshDataBuilder {
+public:
+    ~TestMeshBuilder() override {
+        // Nothing was really uploaded
+        this->initialized = false;
+    }
+    void upload() {
+        this->updateUploadedLODs();
+        this->initialized = true;
+    }
+    using MeshDataBuilder::updateBounds;
+    using MeshData::lods;
+    using MeshData::releaseCPUCopy;
+    using MeshData::unchangedVertexCount;
+    using MeshData::unchangedIndexCount;
+};
+
+/// Pretends its queued upload happened, so the CPU copy can be released without a renderer.
+class TestMeshDataResource : public MeshDataResource {
+public:
+    explicit TestMeshDataResource(ResourceID identifier_) : MeshDataResource(identifier_) {}
+    ~TestMeshDataResource() override {
+        this->initialized = false;
+    }
+    void upload() {
+        UploadQueue::cancel(this->uploadTicket);
+        this->uploadTicket = 0;
+        this->updateUploadedLODs();
+        this->initialized = true;
+    }
+    using MeshData::releaseCPUCopy;
+};
+
+/// A mesh descriptor that doesn't need a material, since making one would need a renderer.
+constexpr std::string_view TEST_MESH_JSON = R"({
+  "materialSetInCode": true,
+  "materialType": "MaterialTextured",
+  "material": "",
+  "model": "meshtest://triangle.cmdl",
+  "modelLoader": "cmdl",
+  "depthFunction": "LESS"
+})";
+
+} // namespace
+
+TEST(MeshDataBuilder, appendOnlyUpdates) {
+    TestMeshBuilder mesh;
+    mesh.addTriangle(Vertex{{0, 0, 0}}, Vertex{{1, 0, 0}}, Vertex{{0, 1, 0}});
+    // Drawing the mesh before update() uploads it without touching the bounds
+    mesh.upload();
+    EXPECT_EQ(mesh.unchangedVertexCount, 3);
+    EXPECT_EQ(mesh.unchangedIndexCount, 3);
+    EXPECT_TRUE(mesh.getBounds().isEmpty());
+
+    // Shares a vertex with the first triangle
+    mesh.addTriangle(Vertex{{0, 0, 5}}, Vertex{{1, 0, 0}}, Vertex{{-2, 0, 0}});
+    EXPECT_EQ(mesh.unchangedVertexCount, 3);
+    mesh.updateBounds();
+    mesh.upload();
+    EXPECT_EQ(mesh.unchangedVertexCount, 5);
+    EXPECT_EQ(mesh.unchangedIndexCount, 6);
+    // Holds the vertices uploaded before the bounds were first updated too
+    EXPECT_EQ(mesh.getBounds().min, glm::vec3(-2, 0, 0));
+    EXPECT_EQ(mesh.getBounds().max, glm::vec3(1, 1, 5));
+
+    mesh.addTriangle(Vertex{{0, 8, 0}}, Vertex{{0, 0, 0}}, Vertex{{1, 0, 0}});
+    mesh.updateBounds();
+    EXPECT_EQ(mesh.getBounds().max, glm::vec3(1, 8, 5));
+    EXPECT_LE(glm::length(glm::vec3{0, 8, 0} - mesh.getBounds().center), mesh.getBounds().radius + 0.0001f);
+}
+
+TEST(MeshDataBuilder, clearResetsBookkeeping) {
+    TestMeshBuilder mesh;
+    mesh.addTriangle(Vertex{{0, 0, 0}}, Vertex{{1, 0, 0}}, Vertex{{0, 1, 0}});
+    mesh.updateBounds();
+    mesh.upload();
+
+    mesh.clear();
+    EXPECT_EQ(mesh.unchangedVertexCount, 0);
+    EXPECT_EQ(mesh.unchangedIndexCount, 0);
+    EXPECT_TRUE(mesh.getBounds().isEmpty());
+
+    // Nothing from before the clear stays in the bounds
+    mesh.addTriangle(Vertex{{10, 10, 10}}, Vertex{{11, 10, 10}}, Vertex{{10, 11, 10}});
+    mesh.updateBounds();
+    EXPECT_EQ(mesh.getBounds().min, glm::vec3(10, 10, 10));
+    EXPECT_EQ(mesh.getBounds().max, glm::vec3(11, 11, 10));
+}
+
+TEST(MeshDataResource, releaseAndReloadCPUCopy) {
+    PREINIT_ENGINE();
+    // Mesh loaders are normally added by Engine::init()
+    IMeshLoader::addMeshLoader("cmdl", new ChiraMeshLoader{});
+    auto* provider = new MemoryResourceProvider{"meshtest"};
+    Resource::addResourceProvider(provider);
+    const std::vector<Vertex> vertices{Vertex{{0, 0, 0}}, Vertex{{1, 0, 0}}, Vertex{{0, 1, 0}}};
+    const auto model = ChiraMeshLoader{}.createMesh(vertices, {0, 1, 2});
+    provider->setResource("triangle.cmdl", model);
+    provider->setResource("triangle.json", std::vector<byte>{TEST_MESH_JSON.begin(), TEST_MESH_JSON.end()});
+
+    auto mesh = Resource::getResource<TestMeshDataResource>("meshtest://triangle.json");
+    const auto cpuMemoryUsage = mesh->getCPUMemoryUsage();
+    EXPECT_EQ(cpuMemoryUsage, vertices.size() * sizeof(Vertex) + 3 * sizeof(Index));
+    // Still queued for upload, so there's nothing to free yet
+    EXPECT_FALSE(mesh->releaseCPUCopy());
+
+    mesh->upload();
+    EXPECT_TRUE(mesh->releaseCPUCopy());
+    EXPECT_TRUE(mesh->isCPUCopyReleased());
+    EXPECT_EQ(mesh->getCPUMemoryUsage(), 0);
+    // The bounds and the uploaded size are kept
+    EXPECT_FALSE(mesh->getBounds().isEmpty());
+    EXPECT_EQ(mesh->getGPUMemoryUsage(), vertices.size() * sizeof(Vertex) + 3 * sizeof(std::uint16_t));
+
+    // Reading the mesh reads the model file again
+    EXPECT_EQ(mesh->getMeshData("cmdl"), model);
+    // Appending brings the CPU copy back for good
+    mesh->appendMeshData("cmdl", "meshtest://triangle.cmdl");
+    EXPECT_FALSE(mesh->isCPUCopyReleased());
+    EXPECT_EQ(mesh->getCPUMemoryUsage(), cpuMemoryUsage * 2);
+
+    mesh.reset();
+    Resource::discardAll();
+}
+
+TEST(MeshDataBuilder, keepsCPUCopy) {
+    IMeshLoader::addMeshLoader("cmdl", new ChiraMeshLoader{});
+    TestMeshBuilder mesh;
+    mesh.addTriangle(Vertex{{0, 0, 0}}, Vertex{{1, 0, 0}}, Vertex{{0, 1, 0}});
+    mesh.upload();
+    // Builders are dynamic and can't be read again
+    EXPECT_FALSE(mesh.releaseCPUCopy());
+    EXPECT_FALSE(mesh.isCPUCopyReleased());
+    EXPECT_FALSE(mesh.getMeshData("cmdl").empty());
+}
+
+TEST(MeshData, selectLOD) {
+    TestMeshBuilder mesh;
+    EXPECT_EQ(mesh.selectLOD(0.f), 0);
+    mesh.lods = {{{0, 1, 2}, 0.5f}, {{0, 1, 2}, 2.f}};
+
+    ConVarRef r_lod_threshold{"r_lod_threshold"};
+    ConVarRef r_lod_bias{"r_lod_bias"};
+    const auto oldThreshold = r_lod_threshold.getValue<double>();
+    const auto oldBias = r_lod_bias.getValue<int>();
+    r_lod_threshold.setValue(1.0);
+    r_lod_bias.setValue(0);
+
+    // A LOD is only drawn while its error covers less than a pixel
+    EXPECT_EQ(mesh.selectLOD(4.f), 0);
+    EXPECT_EQ(mesh.selectLOD(2.f), 0);
+    EXPECT_EQ(mesh.selectLOD(1.f), 1);
+    EXPECT_EQ(mesh.selectLOD(0.25f), 2);
+
+    r_lod_threshold.setValue(4.0);
+    EXPECT_EQ(mesh.selectLOD(4.f), 1);
+    EXPECT_EQ(mesh.selectLOD(1.f), 2);
+
+    // The bias can't pick a LOD that doesn't exist
+    r_lod_threshold.setValue(1.0);
+    r_lod_bias.setValue(1);
+    EXPECT_EQ(mesh.selectLOD(1.f), 2);
+    EXPECT_EQ(mesh.selectLOD(0.25f), 2);
+    r_lod_bias.setValue(-1);
+    EXPECT_EQ(mesh.selectLOD(4.f), 0);
+    EXPECT_EQ(mesh.selectLOD(1.f), 0);
+
+    r_lod_threshold.setValue(oldThreshold);
+    r_lod_bias.setValue(oldBias);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <TestHelpers.h>
+#include <render/mesh/MeshOptimizer.h>
+#include "MeshTestHelpers.h"
+
+using namespace chira;
+
+namespace {
+
+/// Every triangle by its corner positions, starting from the smallest corner so rotating a triangle doesn't change it.
+std::vector<std::array<float, 9>> getTriangles(const std::vector<Vertex>& vertices, const std::vector<Index>& indices) {
+    std::vector<std::array<float, 9>> triangles;
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        std::array<Index, 3> corners{indices[i], indices[i + 1], indices[i + 2]};
+        const auto smallest = std::min_element(corners.begin(), corners.end(), [&vertices](Index lhs, Index rhs) {
+            const auto& a = vertices[lhs].position;
+            const auto& b = vertices[rhs].position;
+            return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+        });
+        std::rotate(corners.begin(), smallest, corners.end());
+        std::array<float, 9> triangle{};
+        for (int corner = 0; corner < 3; corner++) {
+            for (int axis = 0; axis < 3; axis++) {
+                triangle[corner * 3 + axis] = vertices[corners[corner]].position[axis];
+            }
+        }
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+} // namespace
+
+TEST(MeshOptimizer, analyzeVertexCache) {
+    // Two triangles sharing an edge: 4 misses for 2 triangles and 4 vertices
+    const auto statistics = MeshOptimizer::analyzeVertexCache({0, 1, 2, 2, 1, 3}, 4);
+    EXPECT_FLOAT_EQ(statistics.acmr, 2.f);
+    EXPECT_FLOAT_EQ(statistics.atvr, 1.f);
+}
+
+TEST(MeshOptimizer, optimizeVertexCache) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeGrid(32, vertices, indices);
+    const auto before = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+    const auto triangles = getTriangles(vertices, indices);
+
+    const auto clusters = MeshOptimizer::optimizeVertexCache(indices, vertices.size());
+    const auto after = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+    ASSERT_FALSE(clusters.empty());
+    EXPECT_EQ(clusters[0], 0);
+    EXPECT_LT(after.acmr, before.acmr * 0.75f);
+    EXPECT_EQ(getTriangles(vertices, indices), triangles);
+}
+
+TEST(MeshOptimizer, optimizeOverdraw) {
+    // Two quads facing the camera on Z, with the one behind drawn first
+    std::vector<Vertex> vertices{
+            Vertex{{0, 0, 0}}, Vertex{{1, 0, 0}}, Vertex{{1, 1, 0}}, Vertex{{0, 1, 0}},
+            Vertex{{0, 0, 1}}, Vertex{{1, 0, 1}}, Vertex{{1, 1, 1}}, Vertex{{0, 1, 1}},
+    };
+    std::vector<Index> indices{0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7};
+    const auto before = MeshOptimizer::analyzeOverdraw(vertices, indices);
+    EXPECT_GT(before, 1.5f);
+
+    MeshOptimizer::optimizeOverdraw(indices, vertices, {0, 2});
+    EXPECT_FLOAT_EQ(MeshOptimizer::analyzeOverdraw(vertices, indices), 1.f);
+    EXPECT_EQ(indices, (std::vector<Index>{4, 5, 6, 4, 6, 7, 0, 1, 2, 0, 2, 3}));
+}
+
+TEST(MeshOptimizer, optimizeVertexFetch) {
+    std::vector<Vertex> vertices{Vertex{{0, 0, 0}}, Vertex{{1, 0, 0}}, Vertex{{2, 0, 0}}, Vertex{{3, 0, 0}}};
+    std::vector<Index> indices{3, 1, 0, 0, 1, 3};
+    MeshOptimizer::optimizeVertexFetch(vertices, indices);
+    // Vertex 2 is never used
+    ASSERT_EQ(vertices.size(), 3);
+    EXPECT_FLOAT_EQ(vertices[0].position.x, 3.f);
+    EXPECT_FLOAT_EQ(vertices[2].position.x, 0.f);
+    EXPECT_EQ(indices, (std::vector<Index>{0, 1, 2, 2, 1, 0}));
+}
+
+TEST(MeshOptimizer, optimize) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeGrid(32, vertices, indices);
+    const auto triangles = getTriangles(vertices, indices);
+    const auto before = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+
+    MeshOptimizer::optimize(vertices, indices);
+    EXPECT_LT(MeshOptimizer::analyzeVertexCache(indices, vertices.size()).acmr, before.acmr);
+    EXPECT_EQ(getTriangles(vertices, indices), triangles);
+    // Each vertex is first used in order
+    Index next = 0;
+    for (const auto index : indices) {
+        EXPECT_LE(index, next);
+        if (index == next)
+            next++;
+    }
+}
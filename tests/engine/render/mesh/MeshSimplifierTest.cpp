@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <TestHelpers.h>
+#include <render/mesh/MeshSimplifier.h>
+#include "MeshTestHelpers.h"
+
+using namespace chira;
+
+TEST(MeshSimplifier, simplifyFlatGrid) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeGrid(16, vertices, indices);
+
+    float error = -1.f;
+    const auto simplified = MeshSimplifier::simplify(vertices, indices, 24, &error);
+    EXPECT_LE(simplified.size(), 24);
+    EXPECT_NEAR(error, 0.f, 0.0001f);
+    // Every corner has to stay, or the grid would shrink
+    for (const auto corner : {glm::vec3{0, 0, 0}, glm::vec3{16, 0, 0}, glm::vec3{0, 16, 0}, glm::vec3{16, 16, 0}}) {
+        EXPECT_TRUE(std::any_of(simplified.begin(), simplified.end(), [&](Index index) {
+            return vertices[index].position == corner;
+        }));
+    }
+}
+
+TEST(MeshSimplifier, keepSeams) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeGrid(16, vertices, indices, true);
+
+    const auto simplified = MeshSimplifier::simplify(vertices, indices, 24);
+    EXPECT_LT(simplified.size(), indices.size() / 4);
+    // No triangle can mix the two sides of the seam
+    for (std::size_t i = 0; i < simplified.size(); i += 3) {
+        const auto u = vertices[simplified[i]].uv.r;
+        EXPECT_EQ(vertices[simplified[i + 1]].uv.r, u);
+        EXPECT_EQ(vertices[simplified[i + 2]].uv.r, u);
+    }
+}
+
+TEST(MeshSimplifier, generateLODs) {
+    // A bumpy grid, so the LODs have some error to them
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    makeGrid(32, vertices, indices);
+    for (auto& vertex : vertices) {
+        vertex.position.z = std::sin(vertex.position.x * 0.4f) * std::cos(vertex.position.y * 0.3f);
+    }
+
+    const auto lods = MeshSimplifier::generateLODs(vertices, indices, 3);
+    ASSERT_EQ(lods.size(), 3);
+    auto previousSize = indices.size();
+    float previousError = 0.f;
+    for (const auto& lod : lods) {
+        EXPECT_LE(lod.indices.size(), previousSize * 3 / 4);
+        EXPECT_GT(lod.error, previousError);
+        previousSize = lod.indices.size();
+        previousError = lod.error;
+    }
+}
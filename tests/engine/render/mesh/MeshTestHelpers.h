@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <math/VertexWelder.h>
+
+namespace chira {
+
+/// A flat grid of quads drawn one column at a time, so each column has to transform the shared vertices again.
+/// With a seam, the right half of the grid gets different UVs and doesn't share vertices with the left half.
+inline void makeGrid(int size, std::vector<Vertex>& vertices, std::vector<Index>& indices, bool seam = false) {
+    VertexWelder welder{static_cast<std::size_t>((size + 1) * (size + 1))};
+    const auto getVertex = [&vertices, &welder](int x, int y, float u) {
+        return welder.weld(vertices, Vertex{glm::vec3{static_cast<float>(x), static_cast<float>(y), 0.f}, ColorRGB{0, 0, 1}, ColorRG{u, 0}});
+    };
+    for (int x = 0; x < size; x++) {
+        const float u = seam && x >= size / 2 ? 1.f : 0.f;
+        for (int y = 0; y < size; y++) {
+            const auto a = getVertex(x, y, u), b = getVertex(x + 1, y, u), c = getVertex(x + 1, y + 1, u), d = getVertex(x, y + 1, u);
+            indices.insert(indices.end(), {a, b, c, a, c, d});
+        }
+    }
+}
+
+} // namespace chira
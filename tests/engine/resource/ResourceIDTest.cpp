@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <resource/ResourceID.h>
+
+using namespace chira;
+
+TEST(ResourceID, compileTime) {
+    constexpr ResourceID id = "file://textures/missing.png";
+    static_assert(id.isValid());
+    static_assert(id.getProvider() == "file");
+    static_assert(id.getName() == "textures/missing.png");
+    static_assert(id.getProviderHash() == hashFNV1a("file"));
+    EXPECT_EQ(id.getHash(), hashFNV1a("file://textures/missing.png"));
+}
+
+TEST(ResourceID, interned) {
+    std::string identifier = "file://textures/missing.png";
+    ResourceID id1{identifier};
+    identifier = "something else entirely";
+    ResourceID id2{std::string{"file://textures/missing.png"}};
+    EXPECT_EQ(id1.getIdentifier().data(), id2.getIdentifier().data());
+    EXPECT_EQ(id1.getName(), "textures/missing.png");
+    EXPECT_EQ(id1, ResourceID{"file://textures/missing.png"});
+}
+
+TEST(ResourceID, invalid) {
+    ResourceID id{std::string{"no separator"}};
+    EXPECT_FALSE(id.isValid());
+    EXPECT_TRUE(id.getProvider().empty());
+    EXPECT_TRUE(id.getName().empty());
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+#include <TestHelpers.h>
+#include <resource/StringResource.h>
+
+using namespace chira;
+
+TEST(Resource, evictUnusedResources) {
+    PREINIT_ENGINE();
+
+    std::size_t resourceSize;
+    std::size_t usageWithResource;
+    {
+        auto resource = Resource::getResource<StringResource>("file://string_resource_test.txt");
+        resourceSize = resource->getMemoryUsage();
+        EXPECT_GE(resourceSize, 4);
+        usageWithResource = Resource::getCachedMemoryUsage();
+
+        // Resources in use are never evicted
+        Resource::evictUnusedResources(0);
+        EXPECT_EQ(Resource::getCachedMemoryUsage(), usageWithResource);
+    }
+
+    // Unused resources stay cached while the cache is under budget
+    Resource::evictUnusedResources(usageWithResource);
+    EXPECT_EQ(Resource::getCachedMemoryUsage(), usageWithResource);
+    EXPECT_EQ(Resource::getResource<StringResource>("file://string_resource_test.txt").useCount(), 2);
+
+    Resource::evictUnusedResources(usageWithResource - resourceSize);
+    EXPECT_EQ(Resource::getCachedMemoryUsage(), usageWithResource - resourceSize);
+    Resource::discardAll();
+}
+
+TEST(Resource, getResourceFromManyThreads) {
+    PREINIT_ENGINE();
+
+    std::vector<SharedPointer<StringResource>> results(8);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < results.size(); i++) {
+        threads.emplace_back([&results, i] {
+            results[i] = Resource::getResource<StringResource>("file://string_resource_test.txt");
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Every thread ends up with the copy that made it into the cache first
+    auto cached = Resource::getCachedResource<StringResource>("file://string_resource_test.txt");
+    for (const auto& result : results) {
+        EXPECT_EQ(result.get(), cached.get());
+    }
+    EXPECT_EQ(cached.useCount(), results.size() + 2);
+    EXPECT_STREQ(cached->getString().c_str(), "test");
+    Resource::discardAll();
+}
+
+TEST(Resource, removeResourceWaitsForLastUser) {
+    PREINIT_ENGINE();
+
+    auto resource = Resource::getResource<StringResource>("file://string_resource_test.txt");
+    EXPECT_EQ(resource.useCount(), 2);
+    Resource::removeResource(resource->getResourceID());
+    Resource::cleanup();
+
+    // The cache no longer keeps it alive, but it is still shared while in use
+    EXPECT_EQ(resource.useCount(), 1);
+    auto again = Resource::getResource<StringResource>("file://string_resource_test.txt");
+    EXPECT_EQ(again.get(), resource.get());
+    EXPECT_EQ(again.useCount(), 2);
+
+    resource.reset();
+    again.reset();
+    Resource::update();
+    EXPECT_EQ(Resource::getCachedMemoryUsage(), 0);
+    Resource::discardAll();
+}
+
+TEST(Resource, cachedMemoryUsageOfReleasedResource) {
+    PREINIT_ENGINE();
+
+    auto resource = Resource::getResource<StringResource>("file://string_resource_test.txt");
+    const auto usage = Resource::getCachedMemoryUsage();
+    Resource::removeResource(resource->getResourceID());
+    Resource::update();
+
+    // Still counted while something uses it
+    EXPECT_EQ(Resource::getCachedMemoryUsage(), usage);
+    resource.reset();
+    Resource::discardAll();
+    EXPECT_EQ(Resource::getCachedMemoryUsage(), 0);
+}
+
+TEST(Resource, precacheManifest) {
+    PREINIT_ENGINE();
+
+    std::vector<std::size_t> progress;
+    EXPECT_TRUE(Resource::precacheManifest("file://precache_manifest_test.json", [&progress](std::size_t loaded, std::size_t total) {
+        EXPECT_EQ(total, 2);
+        progress.push_back(loaded);
+    }));
+    ASSERT_EQ(progress.size(), 2);
+    EXPECT_EQ(progress[0], 1);
+    EXPECT_EQ(progress[1], 2);
+
+    auto resource = Resource::getCachedResource<StringResource>("file://string_resource_test.txt");
+    EXPECT_STREQ(resource->getString().c_str(), "test");
+    auto manifest = Resource::getCachedResource<StringResource>("file://precache_manifest_test.json");
+    EXPECT_FALSE(manifest->getString().empty());
+    Resource::discardAll();
+}
+
+TEST(Resource, precacheManifestCycle) {
+    PREINIT_ENGINE();
+
+    const auto manifest = nlohmann::json::parse(R"({"resources": [
+        {"type": "StringResource", "identifier": "file://a.txt", "dependencies": ["file://b.txt"]},
+        {"type": "StringResource", "identifier": "file://b.txt", "dependencies": ["file://a.txt"]}
+    ]})");
+    EXPECT_FALSE(Resource::precacheManifestFromJSON(manifest));
+    Resource::discardAll();
+}
+
+TEST(Resource, getCachedResourceInfo) {
+    PREINIT_ENGINE();
+
+    auto resource = Resource::getResource<StringResource>("file://string_resource_test.txt");
+    EXPECT_EQ(resource->getLoadStats().ioBytes, 4);
+
+    bool found = false;
+    for (const auto& info : Resource::getCachedResourceInfo()) {
+        if (info.identifier == resource->getResourceID()) {
+            found = true;
+            EXPECT_EQ(info.useCount, 2);
+            EXPECT_EQ(info.loadStats.ioBytes, 4);
+            EXPECT_EQ(info.cpuMemoryUsage, resource->getCPUMemoryUsage());
+            EXPECT_EQ(info.gpuMemoryUsage, 0);
+        }
+    }
+    EXPECT_TRUE(found);
+    Resource::discardAll();
+}
+
+TEST(Resource, compileEmptyStringResource) {
+    PREINIT_ENGINE();
+
+    StringResource resource{"file://empty.txt"};
+    resource.compile(nullptr, 0);
+    EXPECT_TRUE(resource.getString().empty());
+    const byte terminator[] = {'\0'};
+    resource.compile(terminator, sizeof(terminator));
+    EXPECT_TRUE(resource.getString().empty());
+    Resource::discardAll();
+}
@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <TestHelpers.h>
+#include <resource/StringResource.h>
+
+using namespace chira;
+
+TEST(ResourceTrace, recordAndPrefetch) {
+    PREINIT_ENGINE();
+
+    const auto tracePath = (std::filesystem::temp_directory_path() / "chira_resource_trace_test.json").string();
+    ResourceTrace::setRecording(true);
+    std::ignore = Resource::getResource<StringResource>("file://string_resource_test.txt");
+    Resource::update();
+    std::ignore = Resource::getResource<StringResource>("file://precache_manifest_test.json");
+    // Only the first request is recorded
+    std::ignore = Resource::getResource<StringResource>("file://string_resource_test.txt");
+    ResourceTrace::setRecording(false);
+    ASSERT_TRUE(ResourceTrace::save(tracePath));
+
+    std::ifstream input{tracePath};
+    const auto trace = nlohmann::json::parse(input);
+    ASSERT_EQ(trace["requests"].size(), 2);
+    EXPECT_EQ(trace["requests"][0]["identifier"], "file://string_resource_test.txt");
+    EXPECT_EQ(trace["requests"][1]["identifier"], "file://precache_manifest_test.json");
+    EXPECT_EQ(trace["requests"][1]["frame"].get<int>(), trace["requests"][0]["frame"].get<int>() + 1);
+
+    EXPECT_TRUE(ResourceTrace::prefetch(tracePath));
+    ResourceTrace::stopPrefetching();
+    EXPECT_FALSE(ResourceTrace::prefetch(tracePath + ".missing"));
+
+    Resource::discardAll();
+    std::filesystem::remove(tracePath);
+}
@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <TestHelpers.h>
+#include <resource/StringResource.h>
+#include <resource/provider/EmbeddedResourceProvider.h>
+
+using namespace chira;
+
+namespace {
+
+constexpr byte EMBEDDED_STRING[] = {'t', 'e', 's', 't', '\0'};
+constexpr EmbeddedResource EMBEDDED_RESOURCES[] = {
+        {"a/string.txt", EMBEDDED_STRING, 4},
+        {"b.txt", EMBEDDED_STRING, 4},
+};
+
+} // namespace
+
+TEST(EmbeddedResourceProvider, readEmbeddedResources) {
+    EmbeddedResourceProvider provider{EMBEDDED_RESOURCES, "embedded"};
+    EXPECT_EQ(provider.getResourceCount(), 2);
+    EXPECT_TRUE(provider.hasResource("a/string.txt"));
+    EXPECT_TRUE(provider.hasResource("b.txt"));
+    EXPECT_FALSE(provider.hasResource("c.txt"));
+
+    auto view = provider.readResource("a/string.txt");
+    EXPECT_EQ(view.getData(), EMBEDDED_STRING);
+    EXPECT_TRUE(view.isNullTerminated());
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(view.getData()), view.getSize()), "test");
+}
+
+TEST(EmbeddedResourceProvider, getStringResource) {
+    PREINIT_ENGINE();
+
+    Resource::addResourceProvider(new EmbeddedResourceProvider{EMBEDDED_RESOURCES, "embedded"});
+
+    auto resource = Resource::getResource<StringResource>("embedded://b.txt");
+    EXPECT_STREQ(resource->getString().c_str(), "test");
+    Resource::removeResource(resource->getIdentifier().data());
+    Resource::discardAll();
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
 #include <TestHelpers.h>
 #include <resource/StringResource.h>
 
@@ -28,3 +30,44 @@ TEST(FilesystemResourceProvider, getResourceIdentifier) {
     auto path4 = FilesystemResourceProvider::getResourceIdentifier("/this/is/not/a/valid/path/file.txt");
     EXPECT_STREQ(path4.c_str(), "");
 }
+
+TEST(FilesystemResourceProvider, getStringResourceAsync) {
+    PREINIT_ENGINE();
+
+    auto pending = Resource::getResourceAsync<StringResource>("file://string_resource_test.txt");
+    auto duplicate = Resource::getResourceAsync<StringResource>("file://string_resource_test.txt");
+    auto resource = pending.get();
+    EXPECT_TRUE(pending.isReady());
+    EXPECT_TRUE(duplicate.isReady());
+    EXPECT_EQ(resource.get(), duplicate.get().get());
+    EXPECT_STREQ(resource->getString().c_str(), "test");
+    Resource::discardAll();
+}
+
+TEST(FilesystemResourceProvider, readResources) {
+    FilesystemResourceProvider provider{"tests"};
+    const std::vector<std::string_view> names{"string_resource_test.txt", "this_file_does_not_exist.txt"};
+    const auto views = provider.readResources(names);
+    ASSERT_EQ(views.size(), 2);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(views[0].getData()), views[0].getSize()), "test");
+    EXPECT_TRUE(views[1].isEmpty());
+}
+
+TEST(FilesystemResourceProvider, hasResourceAfterRefresh) {
+    const auto folder = std::filesystem::temp_directory_path() / "chira_filesystem_provider_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder / "sub");
+    std::ofstream{folder / "sub" / "indexed.txt"} << "indexed";
+
+    FilesystemResourceProvider provider{folder.string(), true, "refreshtest"};
+    EXPECT_TRUE(provider.hasResource("sub/indexed.txt"));
+    EXPECT_FALSE(provider.hasResource("added.txt"));
+
+    // The miss is remembered until the provider is refreshed
+    std::ofstream{folder / "added.txt"} << "added";
+    EXPECT_FALSE(provider.hasResource("added.txt"));
+    provider.refresh();
+    EXPECT_TRUE(provider.hasResource("added.txt"));
+
+    std::filesystem::remove_all(folder);
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <TestHelpers.h>
+#include <resource/StringResource.h>
+#include <resource/provider/MemoryResourceProvider.h>
+
+using namespace chira;
+
+TEST(MemoryResourceProvider, setAndReplaceResources) {
+    MemoryResourceProvider provider{"memory"};
+    EXPECT_FALSE(provider.hasResource("a.txt"));
+
+    std::vector<byte> buffer{'a', 'b', 'c'};
+    buffer.reserve(4);
+    const auto* data = buffer.data();
+    provider.setResource("a.txt", std::move(buffer));
+    EXPECT_TRUE(provider.hasResource("a.txt"));
+    EXPECT_EQ(provider.getResourceCount(), 1);
+    auto view = provider.readResource("a.txt");
+    // The buffer had room for the null terminator, so it wasn't copied
+    EXPECT_EQ(view.getData(), data);
+    EXPECT_TRUE(view.isNullTerminated());
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(view.getData()), view.getSize()), "abc");
+
+    provider.setResource("a.txt", std::vector<byte>{'d'});
+    EXPECT_EQ(provider.getResourceCount(), 1);
+    // Views that were already handed out still point to the old buffer
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(view.getData()), view.getSize()), "abc");
+    view = provider.readResource("a.txt");
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(view.getData()), view.getSize()), "d");
+
+    EXPECT_TRUE(provider.removeResource("a.txt"));
+    EXPECT_FALSE(provider.removeResource("a.txt"));
+    EXPECT_FALSE(provider.hasResource("a.txt"));
+}
+
+TEST(MemoryResourceProvider, overlayFilesystem) {
+    PREINIT_ENGINE();
+
+    auto* provider = new MemoryResourceProvider{};
+    Resource::addResourceProvider(provider);
+    provider->setResource("string_resource_test.txt", std::vector<byte>{'o', 'v', 'e', 'r'});
+
+    auto resource = Resource::getResource<StringResource>("file://string_resource_test.txt");
+    EXPECT_STREQ(resource->getString().c_str(), "over");
+    Resource::removeResource(resource->getIdentifier().data());
+    Resource::discardAll();
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <TestHelpers.h>
+#include <resource/StringResource.h>
+#include <resource/provider/PackResourceProvider.h>
+
+using namespace chira;
+
+TEST(PackResourceProvider, readPackedResources) {
+    const std::string packPath = "pack_resource_provider_test" + std::string{PACK_FILE_EXTENSION};
+    const std::filesystem::path loosePath = FILESYSTEM_ROOT_FOLDER + "/tests/string_resource_test.txt";
+    for (bool compress : {false, true}) {
+        {
+            std::ofstream file{packPath, std::ios::binary};
+            ASSERT_TRUE(PackResourceProvider::createPack(file, {{"a/string.txt", loosePath}, {"b.txt", loosePath}}, compress));
+        }
+        PackResourceProvider provider{packPath, "pack"};
+        ASSERT_TRUE(provider.isValid());
+        EXPECT_EQ(provider.getEntryCount(), 2);
+        EXPECT_TRUE(provider.hasResource("a/string.txt"));
+        EXPECT_TRUE(provider.hasResource("b.txt"));
+        EXPECT_FALSE(provider.hasResource("c.txt"));
+
+        auto view = provider.readResource("a/string.txt");
+        EXPECT_EQ(std::string(reinterpret_cast<const char*>(view.getData()), view.getSize()), "test");
+    }
+    std::filesystem::remove(packPath);
+}
+
+TEST(PackResourceProvider, getStringResource) {
+    PREINIT_ENGINE();
+
+    const std::string packPath = "pack_resource_provider_test" + std::string{PACK_FILE_EXTENSION};
+    {
+        std::ofstream file{packPath, std::ios::binary};
+        ASSERT_TRUE(PackResourceProvider::createPack(file, {{"packed_string.txt", FILESYSTEM_ROOT_FOLDER + "/tests/string_resource_test.txt"}}, false));
+    }
+    Resource::addResourceProvider(new PackResourceProvider{packPath});
+
+    auto resource = Resource::getResource<StringResource>("file://packed_string.txt");
+    EXPECT_STREQ(resource->getString().c_str(), "test");
+    Resource::removeResource(resource->getIdentifier().data());
+    Resource::discardAll();
+    std::filesystem::remove(packPath);
+}
@@ -0,0 +1,25 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <resource/provider/FilesystemResourceProvider.h>
+#include <utility/BatchFileReader.h>
+
+using namespace chira;
+
+TEST(BatchFileReader, readFiles) {
+    const std::vector<std::string> paths{
+            FILESYSTEM_ROOT_FOLDER + "/tests/string_resource_test.txt",
+            FILESYSTEM_ROOT_FOLDER + "/tests/this_file_does_not_exist.txt",
+            FILESYSTEM_ROOT_FOLDER + "/tests/string_resource_test.txt",
+    };
+    const auto buffers = BatchFileReader::readFiles(paths);
+    ASSERT_EQ(buffers.size(), 3);
+    ASSERT_TRUE(buffers[0].has_value());
+    EXPECT_FALSE(buffers[1].has_value());
+    ASSERT_TRUE(buffers[2].has_value());
+    // Null-terminated
+    ASSERT_EQ(buffers[0]->size(), 5);
+    EXPECT_STREQ(reinterpret_cast<const char*>(buffers[0]->data()), "test");
+    EXPECT_EQ(*buffers[0], *buffers[2]);
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility/Compression.h>
+
+using namespace chira;
+
+TEST(Compression, roundTrip) {
+    std::string input;
+    for (int i = 0; i < 500; i++) {
+        input += "resource data " + std::to_string(i % 7);
+    }
+    auto compressed = Compression::compress(reinterpret_cast<const byte*>(input.data()), input.size());
+    EXPECT_LT(compressed.size(), input.size());
+
+    std::string output(input.size(), '\0');
+    EXPECT_TRUE(Compression::decompress(compressed.data(), compressed.size(), reinterpret_cast<byte*>(output.data()), output.size()));
+    EXPECT_EQ(input, output);
+}
+
+TEST(Compression, roundTripEmpty) {
+    auto compressed = Compression::compress(nullptr, 0);
+    EXPECT_TRUE(Compression::decompress(compressed.data(), compressed.size(), nullptr, 0));
+}
+
+TEST(Compression, wrongSize) {
+    std::string input = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa";
+    auto compressed = Compression::compress(reinterpret_cast<const byte*>(input.data()), input.size());
+    std::string output(input.size() - 1, '\0');
+    EXPECT_FALSE(Compression::decompress(compressed.data(), compressed.size(), reinterpret_cast<byte*>(output.data()), output.size()));
+}
+
+TEST(Compression, maxDecompressedSize) {
+    // About as compressible as data gets
+    const std::string input(100000, 'a');
+    auto compressed = Compression::compress(reinterpret_cast<const byte*>(input.data()), input.size());
+    EXPECT_LE(input.size(), Compression::getMaxDecompressedSize(compressed.size()));
+}
@@ -0,0 +1,20 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <resource/provider/FilesystemResourceProvider.h>
+#include <utility/MemoryMappedFile.h>
+
+using namespace chira;
+
+TEST(MemoryMappedFile, mapFile) {
+    MemoryMappedFile file{FILESYSTEM_ROOT_FOLDER + "/tests/string_resource_test.txt"};
+    ASSERT_TRUE(file.isOpen());
+    EXPECT_EQ(file.getSize(), 4);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(file.getData()), file.getSize()), "test");
+}
+
+TEST(MemoryMappedFile, missingFile) {
+    MemoryMappedFile file{FILESYSTEM_ROOT_FOLDER + "/tests/this_file_does_not_exist.txt"};
+    EXPECT_FALSE(file.isOpen());
+    EXPECT_EQ(file.getSize(), 0);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <utility/Serial.h>
+
+using namespace chira;
+
+namespace {
+
+struct Descriptor {
+    bool flag = false;
+    int number = 0;
+    std::string path;
+
+    template<typename Archive>
+    void serialize(Archive& ar) {
+        ar(
+                cereal::make_nvp("flag", this->flag),
+                cereal::make_nvp("number", this->number),
+                cereal::make_nvp("path", this->path)
+        );
+    }
+};
+
+} // namespace
+
+TEST(Serial, loadFromJSON) {
+    const std::string json = R"({"flag": true, "number": 42, "path": "file://test.txt"})";
+    Descriptor descriptor;
+    Serial::loadFromBuffer(&descriptor, reinterpret_cast<const byte*>(json.data()), json.size());
+    EXPECT_TRUE(descriptor.flag);
+    EXPECT_EQ(descriptor.number, 42);
+    EXPECT_STREQ(descriptor.path.c_str(), "file://test.txt");
+}
+
+TEST(Serial, loadCooked) {
+    Descriptor original{true, 42, "file://test.txt"};
+    std::ostringstream stream;
+    Serial::saveCooked(&original, stream);
+    const auto cooked = stream.str();
+    EXPECT_TRUE(Serial::isCooked(reinterpret_cast<const byte*>(cooked.data()), cooked.size()));
+
+    Descriptor descriptor;
+    Serial::loadFromBuffer(&descriptor, reinterpret_cast<const byte*>(cooked.data()), cooked.size());
+    EXPECT_TRUE(descriptor.flag);
+    EXPECT_EQ(descriptor.number, 42);
+    EXPECT_STREQ(descriptor.path.c_str(), "file://test.txt");
+}
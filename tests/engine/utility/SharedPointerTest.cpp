@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+#include <utility/SharedPointer.h>
+
+using namespace chira;
+
+namespace {
+
+struct Counted {
+    explicit Counted(int& destroyed_) : destroyed(destroyed_) {}
+    virtual ~Counted() {
+        this->destroyed++;
+    }
+    int& destroyed;
+};
+
+struct DerivedCounted : public Counted {
+    using Counted::Counted;
+};
+
+} // namespace
+
+TEST(SharedPointer, make) {
+    int destroyed = 0;
+    {
+        auto pointer = SharedPointer<Counted>::make(destroyed);
+        EXPECT_EQ(pointer.useCount(), 1);
+        {
+            auto copy = pointer;
+            EXPECT_EQ(pointer.useCount(), 2);
+        }
+        EXPECT_EQ(pointer.useCount(), 1);
+    }
+    EXPECT_EQ(destroyed, 1);
+}
+
+TEST(SharedPointer, assignmentReleasesOldObject) {
+    int destroyedA = 0, destroyedB = 0;
+    auto a = SharedPointer<Counted>::make(destroyedA);
+    auto b = SharedPointer<Counted>::make(destroyedB);
+    a = b;
+    EXPECT_EQ(destroyedA, 1);
+    EXPECT_EQ(b.useCount(), 2);
+    a = SharedPointer<Counted>{};
+    EXPECT_EQ(b.useCount(), 1);
+    b.reset();
+    EXPECT_EQ(destroyedB, 1);
+}
+
+TEST(SharedPointer, castSharesOwnership) {
+    int destroyed = 0;
+    {
+        SharedPointer<Counted> base = SharedPointer<DerivedCounted>::make(destroyed);
+        auto derived = base.cast<DerivedCounted>();
+        EXPECT_EQ(base.get(), derived.get());
+        EXPECT_EQ(base.useCount(), 2);
+        base.reset();
+        EXPECT_EQ(destroyed, 0);
+    }
+    EXPECT_EQ(destroyed, 1);
+}
+
+TEST(SharedPointer, adoptRawPointer) {
+    int destroyed = 0;
+    {
+        SharedPointer<Counted> pointer{new Counted{destroyed}};
+        EXPECT_EQ(pointer.useCount(), 1);
+    }
+    EXPECT_EQ(destroyed, 1);
+}
+
+TEST(WeakPointer, lock) {
+    int destroyed = 0;
+    auto pointer = SharedPointer<Counted>::make(destroyed);
+    WeakPointer<Counted> weak{pointer};
+    EXPECT_FALSE(weak.expired());
+    EXPECT_EQ(pointer.useCount(), 1);
+    EXPECT_EQ(weak.lock().get(), pointer.get());
+
+    pointer.reset();
+    EXPECT_EQ(destroyed, 1);
+    EXPECT_TRUE(weak.expired());
+    EXPECT_FALSE(weak.lock());
+}
+
+TEST(WeakPointer, lockFromManyThreads) {
+    int destroyed = 0;
+    auto pointer = SharedPointer<Counted>::make(destroyed);
+    WeakPointer<Counted> weak{pointer};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([weak] {
+            for (int j = 0; j < 1000; j++) {
+                // The owner may drop it at any point, but a successful lock always sees a live object
+                if (auto locked = weak.lock()) {
+                    EXPECT_EQ(locked->destroyed, 0);
+                }
+            }
+        });
+    }
+    pointer.reset();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(destroyed, 1);
+    EXPECT_TRUE(weak.expired());
+}
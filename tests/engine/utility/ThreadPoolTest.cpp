@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include <utility/ThreadPool.h>
+
+using namespace chira;
+
+TEST(ThreadPool, submitReturnsResult) {
+    ThreadPool pool{2};
+    auto future = pool.submit([] { return 42; });
+    EXPECT_EQ(future.get(), 42);
+}
+
+TEST(ThreadPool, finishesTasksBeforeDestruction) {
+    std::atomic<int> counter = 0;
+    {
+        ThreadPool pool{3};
+        for (int i = 0; i < 100; i++) {
+            pool.submit([&counter] { counter++; });
+        }
+    }
+    EXPECT_EQ(counter, 100);
+}
+
+TEST(ThreadPool, parallelForFromWorker) {
+    ThreadPool pool{2};
+    std::vector<int> calls(100);
+    // Every worker is busy with the outer task, so the caller has to do the work itself
+    pool.submit([&pool, &calls] {
+        pool.parallelFor(calls.size(), [&calls](std::size_t i) { calls[i]++; });
+    }).get();
+    EXPECT_EQ(calls, std::vector<int>(100, 1));
+
+    EXPECT_THROW(pool.parallelFor(10, [](std::size_t i) {
+        if (i == 5)
+            throw std::runtime_error{"task failed"};
+    }), std::runtime_error);
+}
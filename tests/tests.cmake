@@ -2,14 +2,37 @@ list(APPEND CHIRA_TEST_SOURCES
         ${CMAKE_CURRENT_LIST_DIR}/TestHelpers.h
         ${CMAKE_CURRENT_LIST_DIR}/engine/config/ConEntryTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/core/CommandLine.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/loader/mesh/ChiraMeshLoaderTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/loader/mesh/OBJMeshLoaderTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/math/BoundsTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/math/GraphTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/math/VertexWelderTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/backend/UploadQueueTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/backend/VertexLayoutTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/mesh/MeshDataTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/mesh/MeshOptimizerTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/mesh/MeshSimplifierTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/render/mesh/MeshTestHelpers.h
+        ${CMAKE_CURRENT_LIST_DIR}/engine/resource/ResourceIDTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/resource/ResourceTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/resource/ResourceTraceTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/resource/provider/EmbeddedResourceProviderTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/resource/provider/FilesystemResourceProviderTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/resource/provider/MemoryResourceProviderTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/resource/provider/PackResourceProviderTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/ui/debug/ConsolePanelTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/BatchFileReaderTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/CompressionTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/utility/ConceptsTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/utility/DependencyGraphTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/MemoryMappedFileTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/SerialTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/SharedPointerTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/utility/StringTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/ThreadPoolTest.cpp
         ${CMAKE_CURRENT_LIST_DIR}/engine/utility/TypeStringTest.cpp
-        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/UUIDGeneratorTest.cpp)
+        ${CMAKE_CURRENT_LIST_DIR}/engine/utility/UUIDGeneratorTest.cpp
+        ${CMAKE_CURRENT_LIST_DIR}/tools/cooktool/CookTest.cpp)
 
 FetchContent_Declare(
         googletest
@@ -21,7 +44,7 @@ enable_testing()
 set(CHIRA_TEST_NAME "ChiraTest")
 add_executable(${CHIRA_TEST_NAME} ${CHIRA_TEST_SOURCES})
 target_link_libraries(${CHIRA_TEST_NAME} PUBLIC ${CHIRA_ENGINE_NAME} gtest_main)
-target_include_directories(${CHIRA_TEST_NAME} PRIVATE ${CMAKE_CURRENT_LIST_DIR})
+target_include_directories(${CHIRA_TEST_NAME} PRIVATE ${CMAKE_CURRENT_LIST_DIR} ${CMAKE_CURRENT_LIST_DIR}/../tools)
 
 include(GoogleTest)
 gtest_discover_tests(${CHIRA_TEST_NAME})
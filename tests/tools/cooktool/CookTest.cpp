@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string_view>
+#include <TestHelpers.h>
+#include <cooktool/Cook.h>
+#include <loader/mesh/ChiraMeshLoader.h>
+#include <resource/provider/MemoryResourceProvider.h>
+
+using namespace chira;
+
+namespace {
+
+/// Doesn't need a material, since making one would need a renderer.
+constexpr std::string_view TEST_MESH_JSON = R"({
+  "materialSetInCode": true,
+  "materialType": "MaterialTextured",
+  "material": "",
+  "model": "cooktest://triangle.cmdl",
+  "modelLoader": "cmdl",
+  "depthFunction": "LESS"
+})";
+
+} // namespace
+
+TEST(Cook, cookAndReloadDescriptor) {
+    PREINIT_ENGINE();
+    // Mesh loaders are normally added by Engine::init()
+    IMeshLoader::addMeshLoader("cmdl", new ChiraMeshLoader{});
+    auto* provider = new MemoryResourceProvider{"cooktest"};
+    Resource::addResourceProvider(provider);
+    const std::vector<Vertex> vertices{Vertex{{0, 0, 0}}, Vertex{{1, 0, 0}}, Vertex{{0, 1, 0}}};
+    provider->setResource("triangle.cmdl", ChiraMeshLoader{}.createMesh(vertices, {0, 1, 2}));
+
+    std::ostringstream stream;
+    EXPECT_EQ(Cook::cookDescriptor("cooktest://triangle.json", std::string{TEST_MESH_JSON}, stream), true);
+    const auto cooked = stream.str();
+    ASSERT_TRUE(Serial::isCooked(reinterpret_cast<const byte*>(cooked.data()), cooked.size()));
+    provider->setResource("triangle.json", std::vector<byte>{cooked.begin(), cooked.end()});
+
+    // Loads the model the cooked descriptor points to
+    auto mesh = Resource::getResource<MeshDataResource>("cooktest://triangle.json");
+    ASSERT_TRUE(mesh);
+    EXPECT_EQ(mesh->getIdentifier(), "cooktest://triangle.json");
+    EXPECT_EQ(mesh->getCPUMemoryUsage(), vertices.size() * sizeof(Vertex) + 3 * sizeof(Index));
+    EXPECT_FALSE(mesh->getBounds().isEmpty());
+
+    // Anything that isn't a descriptor is left alone
+    std::ostringstream ignored;
+    EXPECT_FALSE(Cook::cookDescriptor("cooktest://data.json", R"({"something": "else"})", ignored).has_value());
+    EXPECT_TRUE(ignored.str().empty());
+
+    mesh.reset();
+    Resource::discardAll();
+}
@@ -1,3 +1,4 @@
+#include <charconv>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
@@ -6,21 +7,26 @@
 #include <core/Engine.h>
 #include <loader/mesh/ChiraMeshLoader.h>
 #include <loader/mesh/OBJMeshLoader.h>
-#include <render/mesh/MeshData.h>
+#include <render/mesh/MeshOptimizer.h>
+#include <render/mesh/MeshSimplifier.h>
 #include <resource/provider/FilesystemResourceProvider.h>
 
 #include "../ToolHelpers.h"
 
 using namespace chira;
 
-CHIRA_SETUP_CLI_TOOL(CMDLTOOL, "1.0",
-                     "Parameters:"                                                  "\n"
-                     "-h               : Display this help message"                 "\n"
-                     "-i <input file>  : Path of the file to convert"               "\n"
-                     "-s <type>        : Type of the input file (cmdl, obj, etc.)"  "\n"
-                     "-t <type>        : Type of the output file (cmdl, obj, etc.)" "\n"
-                     "                   The default is cmdl"                       "\n"
-                     "-o <output file> : Destination for the converted file"        "\n");
+CHIRA_SETUP_CLI_TOOL(CMDLTOOL, "1.3",
+                     "Parameters:"                                                         "\n"
+                     "-h               : Display this help message"                        "\n"
+                     "-i <input file>  : Path of the file to convert"                      "\n"
+                     "-s <type>        : Type of the input file (cmdl, obj, etc.)"         "\n"
+                     "-t <type>        : Type of the output file (cmdl, obj, etc.)"        "\n"
+                     "                   The default is cmdl"                              "\n"
+                     "-o <output file> : Destination for the converted file"               "\n"
+                     "-q               : Quantize normals, colors, and UVs (cmdl only)"    "\n"
+                     "-c               : Compress the mesh data (cmdl only)"               "\n"
+                     "-p               : Reorder the mesh to draw faster, and print stats" "\n"
+                     "-l <count>       : Generate up to this many LODs (cmdl only)"        "\n");
 
 int main(int argc, const char* argv[]) {
     Engine::preinit(argc, argv);
@@ -68,16 +74,49 @@ int main(int argc, const char* argv[]) {
 
     // todo: populate these through some kind of registry
     IMeshLoader::addMeshLoader("obj", new OBJMeshLoader{});
-    IMeshLoader::addMeshLoader("cmdl", new ChiraMeshLoader{});
+    std::uint32_t cmdlFlags = CHIRA_MESH_FLAG_NONE;
+    if (CommandLine::has("-q"))
+        cmdlFlags |= CHIRA_MESH_FLAG_QUANTIZED;
+    if (CommandLine::has("-c"))
+        cmdlFlags |= CHIRA_MESH_FLAG_COMPRESSED;
+    IMeshLoader::addMeshLoader("cmdl", new ChiraMeshLoader{cmdlFlags});
 
     LOG_CMDLTOOL.info("Attempting to convert mesh file \"{}\"...", inputPath.filename().string());
 
-    MeshData mesh{};
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
     Resource::addResourceProvider(new FilesystemResourceProvider{inputPath.parent_path().string()});
-    mesh.appendMeshData(inputType, FilesystemResourceProvider::getResourceIdentifier(inputPath.string()));
+    IMeshLoader::getMeshLoader(inputType)->loadMesh(FilesystemResourceProvider::getResourceIdentifier(inputPath.string()), vertices, indices);
+
+    if (CommandLine::has("-p")) {
+        const auto printStats = [&vertices, &indices](std::string_view when) {
+            const auto cache = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+            LOG_CMDLTOOL.info("{} optimizing: {} vertices, {} triangles, ACMR {:.3f}, ATVR {:.3f}, overdraw {:.3f}",
+                              when, vertices.size(), indices.size() / 3, cache.acmr, cache.atvr, MeshOptimizer::analyzeOverdraw(vertices, indices));
+        };
+        printStats("Before");
+        MeshOptimizer::optimize(vertices, indices);
+        printStats("After");
+    }
+
+    std::vector<MeshLOD> lods;
+    if (auto lodArgument = CommandLine::get("-l"); !lodArgument.empty()) {
+        std::size_t lodCount = 0;
+        if (std::from_chars(lodArgument.data(), lodArgument.data() + lodArgument.size(), lodCount).ec != std::errc{}) {
+            LOG_CMDLTOOL.error("Invalid LOD count \"{}\"!\n", lodArgument);
+            printHelp();
+            return EXIT_FAILURE;
+        }
+        lods = MeshSimplifier::generateLODs(vertices, indices, lodCount);
+        for (std::size_t i = 0; i < lods.size(); i++) {
+            if (CommandLine::has("-p"))
+                MeshOptimizer::optimizeVertexCache(lods[i].indices, vertices.size());
+            LOG_CMDLTOOL.info("LOD {}: {} triangles, error {:.5f}", i + 1, lods[i].indices.size() / 3, lods[i].error);
+        }
+    }
 
     std::ofstream file{outputPath.string(), std::ios::binary};
-    std::vector<byte> meshData = mesh.getMeshData(outputType);
+    std::vector<byte> meshData = IMeshLoader::getMeshLoader(outputType)->createMeshWithLODs(vertices, indices, lods);
     file.write(reinterpret_cast<const char*>(meshData.data()), static_cast<std::streamsize>(meshData.size()));
     file.close();
     LOG_CMDLTOOL.infoImportant("Conversion complete! File written to \"{}\"", outputPath.string());
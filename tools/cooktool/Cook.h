@@ -0,0 +1,48 @@
+#pragma once
+
+#include <optional>
+#include <ostream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+#include <render/material/MaterialPhong.h>
+#include <render/mesh/MeshDataResource.h>
+#include <render/shader/Shader.h>
+#include <render/texture/Texture.h>
+#include <render/texture/TextureCubemap.h>
+#include <resource/ResourceID.h>
+#include <utility/Serial.h>
+
+namespace chira::Cook {
+
+/// Loads the descriptor like the engine would, then writes it back out cooked.
+/// The identifier is the one the engine will load the cooked file with. Throws cereal::Exception if the descriptor can't be read.
+template<typename ResourceType>
+bool cookDescriptor(const ResourceID& identifier, const std::string& contents, std::ostream& output) {
+    ResourceType resource{identifier};
+    Serial::loadFromBuffer(&resource, reinterpret_cast<const byte*>(contents.data()), contents.size());
+    Serial::saveCooked(&resource, output);
+    return output.good();
+}
+
+/// Descriptors don't say what they describe, so go by a field only that type has.
+/// Returns nothing if the contents are not a descriptor that can be cooked.
+inline std::optional<bool> cookDescriptor(const ResourceID& identifier, const std::string& contents, std::ostream& output) {
+    const auto descriptor = nlohmann::json::parse(contents, nullptr, false);
+    if (!descriptor.is_object())
+        return std::nullopt;
+
+    if (descriptor.contains("vertex") && descriptor.contains("fragment"))
+        return cookDescriptor<Shader>(identifier, contents, output);
+    if (descriptor.contains("imageFD"))
+        return cookDescriptor<TextureCubemap>(identifier, contents, output);
+    if (descriptor.contains("image"))
+        return cookDescriptor<Texture>(identifier, contents, output);
+    if (descriptor.contains("shininess") && descriptor.contains("lambertFactor"))
+        return cookDescriptor<MaterialPhong>(identifier, contents, output);
+    if (descriptor.contains("model") && descriptor.contains("modelLoader"))
+        return cookDescriptor<MeshDataResource>(identifier, contents, output);
+    return std::nullopt;
+}
+
+} // namespace chira::Cook
@@ -0,0 +1 @@
+add_tool_executable(cooktool SOURCES ${CMAKE_CURRENT_LIST_DIR}/cooktool.cpp)
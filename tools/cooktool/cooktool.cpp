@@ -0,0 +1,110 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+
+#include <core/CommandLine.h>
+#include <core/Engine.h>
+#include <resource/provider/FilesystemResourceProvider.h>
+
+#include "../ToolHelpers.h"
+#include "Cook.h"
+
+using namespace chira;
+
+CHIRA_SETUP_CLI_TOOL(COOKTOOL, "1.0",
+                     "Parameters:"                                                   "\n"
+                     "-h               : Display this help message"                  "\n"
+                     "-i <input dir>   : Path of the resource folder to cook"        "\n"
+                     "-o <output dir>  : Destination for the cooked resource folder" "\n");
+
+/// Returns nothing if the file is not a descriptor that can be cooked.
+std::optional<bool> cookFile(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath, const ResourceID& identifier) {
+    if (inputPath.extension() != ".json")
+        return std::nullopt;
+    std::ifstream input{inputPath.string(), std::ios::binary};
+    std::string contents{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+    std::ostringstream cooked;
+    std::optional<bool> result;
+    try {
+        result = Cook::cookDescriptor(identifier, contents, cooked);
+    } catch (const cereal::Exception& e) {
+        LOG_COOKTOOL.error("Failed to read descriptor: {}", e.what());
+        return false;
+    }
+    if (!result || !*result)
+        return result;
+    std::ofstream output{outputPath.string(), std::ios::binary};
+    output << cooked.str();
+    return output.good();
+}
+
+int main(int argc, const char* argv[]) {
+    Engine::preinit(argc, argv);
+
+    // make sure we actually discard resources. we don't ever call Engine::run()
+    // so we never do the proper shutdown and have to manually call this
+    std::atexit(Resource::discardAll);
+
+    if (argc == 0) {
+        printHelp();
+        return EXIT_FAILURE;
+    }
+
+    if (CommandLine::has("-h")) {
+        printHelp();
+        return EXIT_SUCCESS;
+    }
+
+    std::filesystem::path inputPath;
+    if (auto input = CommandLine::get("-i"); !input.empty() && std::filesystem::is_directory(input)) {
+        inputPath = input;
+    } else {
+        LOG_COOKTOOL.error("No valid input folder provided!\n");
+        printHelp();
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path outputPath;
+    if (auto output = CommandLine::get("-o"); !output.empty()) {
+        outputPath = output;
+    } else {
+        LOG_COOKTOOL.error("No output folder provided!\n");
+        printHelp();
+        return EXIT_FAILURE;
+    }
+    if (std::error_code error; std::filesystem::equivalent(inputPath, outputPath, error)) {
+        LOG_COOKTOOL.error("The output folder can't be the input folder!\n");
+        return EXIT_FAILURE;
+    }
+
+    LOG_COOKTOOL.info("Cooking files in \"{}\"...", inputPath.string());
+
+    std::size_t cooked = 0, copied = 0, failed = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator{inputPath}) {
+        if (!entry.is_regular_file())
+            continue;
+        const auto relativePath = std::filesystem::relative(entry.path(), inputPath);
+        const auto destination = outputPath / relativePath;
+        std::filesystem::create_directories(destination.parent_path());
+
+        // The input folder is the root of a file provider, so this is what the engine will load the file as
+        const auto identifier = FILESYSTEM_PROVIDER_NAME + RESOURCE_ID_SEPARATOR.data() + relativePath.generic_string();
+        if (auto result = cookFile(entry.path(), destination, identifier)) {
+            if (*result) {
+                cooked++;
+                continue;
+            }
+            LOG_COOKTOOL.error("Failed to cook \"{}\", copying it as-is", entry.path().string());
+            failed++;
+        }
+        // Everything else is needed at runtime too, so the output is a complete resource folder
+        std::filesystem::copy_file(entry.path(), destination, std::filesystem::copy_options::overwrite_existing);
+        copied++;
+    }
+
+    LOG_COOKTOOL.infoImportant("Cooked {} descriptors and copied {} other files to \"{}\"", cooked, copied, outputPath.string());
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1 @@
+add_tool_executable(packtool SOURCES ${CMAKE_CURRENT_LIST_DIR}/packtool.cpp)
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include <core/CommandLine.h>
+#include <core/Engine.h>
+#include <resource/provider/PackResourceProvider.h>
+
+#include "../ToolHelpers.h"
+
+using namespace chira;
+
+CHIRA_SETUP_CLI_TOOL(PACKTOOL, "1.0",
+                     "Parameters:"                                                       "\n"
+                     "-h               : Display this help message"                      "\n"
+                     "-i <input dir>   : Path of the resource folder to pack"            "\n"
+                     "-o <output file> : Destination for the pack file"                  "\n"
+                     "-c               : Compress entries that get meaningfully smaller" "\n");
+
+int main(int argc, const char* argv[]) {
+    Engine::preinit(argc, argv);
+
+    // make sure we actually discard resources. we don't ever call Engine::run()
+    // so we never do the proper shutdown and have to manually call this
+    std::atexit(Resource::discardAll);
+
+    if (argc == 0) {
+        printHelp();
+        return EXIT_FAILURE;
+    }
+
+    if (CommandLine::has("-h")) {
+        printHelp();
+        return EXIT_SUCCESS;
+    }
+
+    std::filesystem::path inputPath;
+    if (auto input = CommandLine::get("-i"); !input.empty() && std::filesystem::is_directory(input)) {
+        inputPath = input;
+    } else {
+        LOG_PACKTOOL.error("No valid input folder provided!\n");
+        printHelp();
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path outputPath;
+    if (auto output = CommandLine::get("-o"); !output.empty()) {
+        outputPath = output;
+    } else {
+        LOG_PACKTOOL.error("No output file provided!\n");
+        printHelp();
+        return EXIT_FAILURE;
+    }
+
+    LOG_PACKTOOL.info("Collecting files in \"{}\"...", inputPath.string());
+
+    std::vector<std::pair<std::string, std::filesystem::path>> files;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator{inputPath}) {
+        if (!entry.is_regular_file())
+            continue;
+        auto name = std::filesystem::relative(entry.path(), inputPath).string();
+        FilesystemResourceProvider::nixifyPath(name);
+        files.emplace_back(std::move(name), entry.path());
+    }
+    // Keep the output the same no matter what order the OS lists files in
+    std::sort(files.begin(), files.end());
+
+    std::ofstream file{outputPath.string(), std::ios::binary};
+    if (!PackResourceProvider::createPack(file, files, CommandLine::has("-c"))) {
+        LOG_PACKTOOL.error("Failed to write pack file to \"{}\"", outputPath.string());
+        return EXIT_FAILURE;
+    }
+    file.close();
+    LOG_PACKTOOL.infoImportant("Packed {} files! File written to \"{}\"", files.size(), outputPath.string());
+
+    return EXIT_SUCCESS;
+}